@@ -61,9 +61,7 @@ int main(int argc,char *argv[]) {
         pts.push_back(p);
     }
     boost::timer tmr;
-    BOOST_FOREACH(ovd::Point p, pts ) {
-        vd->insert_point_site(p); // insert each point. This returns an int-handle which we do not use here.
-    }
+    vd->insert_point_sites(pts); // insert all points. This returns int-handles which we do not use here.
     double t = tmr.elapsed();
     std::cout << t << " seconds \n";
     double norm = nmax*log((double)nmax)/log(2.0);
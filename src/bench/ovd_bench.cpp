@@ -0,0 +1,529 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// benchmark of the core engine, without python in the loop.
+//
+// usage: ovd_bench [--quick] [--json] [--data <dir>] [--max <n>]
+//
+//  --quick  only the small cases
+//  --json   machine-readable output
+//  --data   directory with the datasets written by test/data/make_bench_data.py
+//           (default ../src/test/data, as for the python tests)
+//  --max    skip cases with more than n sites
+//
+// the cases are
+//  points_random, points_grid, points_circle   point distributions as in voronoi_benchmark.py
+//  points_bulk                                 random points inserted with insert_point_sites()
+//  segments                                    the randomsegments_N datasets
+//  stars                                       synthetic star-shaped polygons, like glyph outlines
+//  ttt_alphabet                                glyph outlines, if the dataset has been written
+// for the line-segment cases the time to compute offsets, and to filter and walk
+// the medial axis, is reported too.
+// Each series of a case with growing n is fitted to  t = c * n*log2(n).
+// Each case runs in a child process, so that its peak resident set size is
+// not hidden by the peak of an earlier, larger, case.
+
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <boost/cstdint.hpp>
+#include <boost/foreach.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_01.hpp>
+
+#include "voronoidiagram.hpp"
+#include "offset.hpp"
+#include "medial_axis.hpp"
+#include "profiler.hpp"
+#include "version.hpp"
+
+using namespace ovd;
+
+/// a polyline, or a closed polygon
+struct Chain {
+    std::vector<Point> points;
+    bool closed;
+};
+typedef std::vector<Chain> Chains;
+
+/// the result of one benchmark case
+struct CaseResult {
+    CaseResult() : sites(0), seconds(0), peak_rss_kb(0), valid(false), vertices(0),
+                   offset_seconds(0), offset_loops(0), medial_seconds(0), medial_points(0) {}
+    std::string name;
+    /// cases in the same series are fitted to n*log2(n)
+    std::string series;
+    unsigned int sites;
+    /// time to insert all sites
+    double seconds;
+    /// the increase of the peak resident set size during this case
+    long peak_rss_kb;
+    bool valid;
+    int vertices;
+    /// time to compute the offsets, for line-segment cases
+    double offset_seconds;
+    unsigned int offset_loops;
+    /// time to filter and walk the medial axis, for line-segment cases
+    double medial_seconds;
+    unsigned int medial_points;
+    double ns_per_site() const { return sites ? 1e9*seconds/sites : 0; }
+};
+
+/// least-squares fit of  t = c * n*log2(n)  and of  t = a * n^exponent
+struct Fit {
+    std::string series;
+    unsigned int cases;
+    /// nanoseconds per n*log2(n)
+    double ns_per_nlogn;
+    double exponent;
+};
+
+// peak resident set size of this process, in kB
+long peak_rss_kb() {
+    rusage r;
+    getrusage(RUSAGE_SELF, &r);
+#ifdef __APPLE__
+    return r.ru_maxrss/1024; // bytes on Mac OS X
+#else
+    return r.ru_maxrss;
+#endif
+}
+
+// runs a case in a child process. the case is computed when child() is true,
+// and then handed back with finish(). the parent gets it from result().
+// if fork() fails the case is computed in this process.
+class ChildProcess {
+public:
+    ChildProcess() : pid(-1), is_child(false) {
+        std::cout.flush();
+        if ( pipe(fd) == 0 ) {
+            pid = fork();
+            if ( pid < 0 ) {
+                close(fd[0]);
+                close(fd[1]);
+            }
+        }
+        is_child = ( pid == 0 );
+        start_rss_kb = peak_rss_kb();
+    }
+    /// true in the process that should compute the case
+    bool child() const { return pid <= 0; }
+    /// the increase of the peak resident set size since the case started
+    long rss_increase_kb() const { return peak_rss_kb() - start_rss_kb; }
+    /// in the child, send res to the parent and exit
+    void finish(const CaseResult& res) {
+        if ( !is_child )
+            return;
+        close(fd[0]);
+        bool ok = put(res.sites) && put(res.seconds) && put(res.peak_rss_kb) && put(res.valid)
+               && put(res.vertices) && put(res.offset_seconds) && put(res.offset_loops)
+               && put(res.medial_seconds) && put(res.medial_points);
+        close(fd[1]);
+        _exit( ok ? 0 : 1 );
+    }
+    /// in the parent, the result from the child. the case is invalid if the child failed.
+    CaseResult result(const std::string& name, const std::string& series) {
+        CaseResult res;
+        res.name = name;
+        res.series = series;
+        close(fd[1]);
+        bool ok = get(res.sites) && get(res.seconds) && get(res.peak_rss_kb) && get(res.valid)
+               && get(res.vertices) && get(res.offset_seconds) && get(res.offset_loops)
+               && get(res.medial_seconds) && get(res.medial_points);
+        close(fd[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if ( !ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ) {
+            std::cerr << "ovd_bench: case " << name << " failed\n";
+            res.valid = false;
+        }
+        return res;
+    }
+private:
+    template<class T> bool put(const T& x) { return write(fd[1], &x, sizeof(T)) == (ssize_t)sizeof(T); }
+    template<class T> bool get(T& x) { return read(fd[0], &x, sizeof(T)) == (ssize_t)sizeof(T); }
+    int fd[2];
+    pid_t pid;
+    bool is_child;
+    long start_rss_kb;
+};
+
+// the number of bins of the face-grid, as in voronoi_benchmark_3_lineseg.py
+unsigned int grid_bins(unsigned int n) {
+    return std::min( 200, (int)floor( sqrt(2.0*n) ) );
+}
+
+// little-endian fields of the chain format
+unsigned int get_uint32(const unsigned char* b) {
+    return b[0] | (b[1]<<8) | (b[2]<<16) | ((unsigned int)b[3]<<24);
+}
+double get_float64(const unsigned char* b) {
+    boost::uint64_t bits = 0;
+    for (int n=7; n>=0; --n)
+        bits = (bits << 8) | b[n];
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+// read a dataset written by make_bench_data.py. returns false if the file cannot be read.
+bool read_chains(const std::string& filename, Chains& chains) {
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    if (!in)
+        return false;
+    unsigned char header[12];
+    if ( !in.read( (char*)header, 12 ) || std::memcmp(header, "OVDC", 4) || get_uint32(header+4) != 1 ) {
+        std::cerr << filename << ": not a version 1 OVDC file\n";
+        return false;
+    }
+    unsigned int n_chains = get_uint32(header+8);
+    chains.resize(n_chains);
+    for (unsigned int n=0; n<n_chains; ++n) {
+        unsigned char ch[8];
+        if ( !in.read( (char*)ch, 8 ) )
+            return false;
+        unsigned int n_points = get_uint32(ch);
+        chains[n].closed = get_uint32(ch+4);
+        std::vector<unsigned char> xy(16*n_points);
+        if ( n_points && !in.read( (char*)&xy[0], xy.size() ) )
+            return false;
+        for (unsigned int m=0; m<n_points; ++m)
+            chains[n].points.push_back( Point( get_float64(&xy[16*m]), get_float64(&xy[16*m+8]) ) );
+    }
+    return true;
+}
+
+std::vector<Point> random_points(unsigned int n) {
+    boost::mt19937 rng(42);
+    boost::uniform_01<boost::mt19937> rnd(rng);
+    std::vector<Point> pts;
+    for (unsigned int m=0; m<n; ++m) {
+        double x = -0.7 + 1.4*rnd();
+        double y = -0.7 + 1.4*rnd();
+        pts.push_back( Point(x,y) );
+    }
+    return pts;
+}
+
+// a shuffled regular grid of about n points
+std::vector<Point> grid_points(unsigned int n) {
+    unsigned int rows = (unsigned int)sqrt( (double)n );
+    double stride = 1.4/(rows-1);
+    std::vector<Point> pts;
+    for (unsigned int i=0; i<rows; ++i)
+        for (unsigned int j=0; j<rows; ++j)
+            pts.push_back( Point(-0.7+stride*i, -0.7+stride*j) );
+    boost::mt19937 rng(42);
+    for (unsigned int m=pts.size()-1; m>0; --m) // Fisher-Yates shuffle
+        std::swap( pts[m], pts[ rng() % (m+1) ] );
+    return pts;
+}
+
+std::vector<Point> circle_points(unsigned int n) {
+    std::vector<Point> pts;
+    double radius = 0.81234;
+    for (unsigned int m=0; m<n; ++m) {
+        double a = 2*M_PI*m/n;
+        pts.push_back( Point( radius*cos(a), radius*sin(a) ) );
+    }
+    return pts;
+}
+
+// k*k star-shaped polygons with m vertices each, one in each cell of a grid
+Chains star_polygons(unsigned int k, unsigned int m) {
+    boost::mt19937 rng(42);
+    boost::uniform_01<boost::mt19937> rnd(rng);
+    double cell = 1.2/k;
+    Chains chains;
+    for (unsigned int i=0; i<k; ++i) {
+        for (unsigned int j=0; j<k; ++j) {
+            Point c( -0.6+cell*(i+0.5), -0.6+cell*(j+0.5) );
+            Chain star;
+            star.closed = true;
+            for (unsigned int n=0; n<m; ++n) {
+                double r = ( (n%2) ? 0.25 : 0.45 )*cell + 0.05*cell*(rnd()-0.5);
+                double a = 2*M_PI*n/m;
+                star.points.push_back( c + Point( r*cos(a), r*sin(a) ) );
+            }
+            chains.push_back(star);
+        }
+    }
+    return chains;
+}
+
+CaseResult run_points(const std::string& name, const std::string& series, const std::vector<Point>& pts, bool bulk) {
+    ChildProcess process;
+    if ( !process.child() )
+        return process.result(name, series);
+    CaseResult res;
+    res.name = name;
+    res.series = series;
+    res.sites = pts.size();
+    VoronoiDiagram vd(1, grid_bins(pts.size()) );
+    double t0 = Profiler::now();
+    if (bulk) {
+        vd.insert_point_sites(pts);
+    } else {
+        BOOST_FOREACH( const Point& p, pts ) {
+            vd.insert_point_site(p);
+        }
+    }
+    res.seconds = Profiler::now() - t0;
+    res.peak_rss_kb = process.rss_increase_kb();
+    res.vertices = vd.num_vertices();
+    res.valid = vd.check();
+    process.finish(res);
+    return res;
+}
+
+// insert all points of the chains, then all line-segments. then compute offsets.
+CaseResult run_chains(const std::string& name, const std::string& series, const Chains& chains) {
+    ChildProcess process;
+    if ( !process.child() )
+        return process.result(name, series);
+    CaseResult res;
+    res.name = name;
+    res.series = series;
+    unsigned int n_points = 0;
+    BOOST_FOREACH( const Chain& c, chains ) {
+        n_points += c.points.size();
+    }
+    VoronoiDiagram vd(1, grid_bins(n_points) );
+    double t0 = Profiler::now();
+    std::vector< std::vector<int> > ids( chains.size() );
+    for (unsigned int n=0; n<chains.size(); ++n) {
+        BOOST_FOREACH( const Point& p, chains[n].points ) {
+            ids[n].push_back( vd.insert_point_site(p) );
+        }
+    }
+    for (unsigned int n=0; n<chains.size(); ++n) {
+        unsigned int n_segs = chains[n].closed ? ids[n].size() : ids[n].size()-1;
+        for (unsigned int m=0; m<n_segs; ++m) {
+            vd.insert_line_site( ids[n][m], ids[n][ (m+1) % ids[n].size() ] );
+            res.sites++;
+        }
+    }
+    res.sites += n_points;
+    res.seconds = Profiler::now() - t0;
+    res.peak_rss_kb = process.rss_increase_kb();
+    res.vertices = vd.num_vertices();
+    res.valid = vd.check();
+
+    Offset ofs( vd.get_graph_reference() );
+    t0 = Profiler::now();
+    std::vector<double> levels;
+    for (int n=1; n<=10; ++n)
+        levels.push_back( 0.002*n );
+    OffsetLevels loops = ofs.offset( levels );
+    for (unsigned int n=0; n<loops.size(); ++n)
+        res.offset_loops += loops[n].loops.size();
+    res.offset_seconds = Profiler::now() - t0;
+
+    t0 = Profiler::now();
+    FilterView view( vd.get_graph_reference() );
+    MedialAxis filter( vd.get_graph_reference(), view );
+    MedialAxisWalk walk( vd.get_graph_reference(), view );
+    MedialChainList medial_chains = walk.walk();
+    BOOST_FOREACH( const MedialChain& chain, medial_chains ) {
+        BOOST_FOREACH( const MedialPointList& edge, chain ) {
+            res.medial_points += edge.size();
+        }
+    }
+    res.medial_seconds = Profiler::now() - t0;
+    process.finish(res);
+    return res;
+}
+
+std::vector<Fit> fit_series(const std::vector<CaseResult>& results) {
+    std::vector<Fit> fits;
+    std::vector<std::string> names;
+    BOOST_FOREACH( const CaseResult& r, results ) {
+        if ( std::find( names.begin(), names.end(), r.series ) == names.end() )
+            names.push_back( r.series );
+    }
+    BOOST_FOREACH( const std::string& series, names ) {
+        double tx=0, xx=0; // for t = c*x
+        double sl=0, st=0, sll=0, slt=0; // for log(t) = a + exponent*log(n)
+        unsigned int cases = 0;
+        BOOST_FOREACH( const CaseResult& r, results ) {
+            if ( r.series != series || r.seconds <= 0 )
+                continue;
+            double x = r.sites*log( (double)r.sites )/log(2.0);
+            tx += r.seconds*x;
+            xx += x*x;
+            double l = log( (double)r.sites );
+            double lt = log( r.seconds );
+            sl += l; st += lt; sll += l*l; slt += l*lt;
+            cases++;
+        }
+        if (cases < 2)
+            continue;
+        Fit f;
+        f.series = series;
+        f.cases = cases;
+        f.ns_per_nlogn = 1e9*tx/xx;
+        f.exponent = (cases*slt - sl*st) / (cases*sll - sl*sl);
+        fits.push_back(f);
+    }
+    return fits;
+}
+
+void print_table(const std::vector<CaseResult>& results, const std::vector<Fit>& fits) {
+    std::cout << "openvoronoi " << version() << " " << build_type() << "\n";
+    std::cout << "case                     sites    seconds    ns/site  peak_rss_kb  vertices  valid  offset_s  loops  medial_s  points\n";
+    BOOST_FOREACH( const CaseResult& r, results ) {
+        char line[256];
+        sprintf(line, "%-20s %9u %10.4f %10.1f %12ld %9d  %5s", r.name.c_str(), r.sites, r.seconds, r.ns_per_site(),
+                      r.peak_rss_kb, r.vertices, r.valid ? "yes" : "NO");
+        std::cout << line;
+        if ( r.offset_loops ) {
+            sprintf(line, " %9.4f %6u %9.4f %7u", r.offset_seconds, r.offset_loops, r.medial_seconds, r.medial_points);
+            std::cout << line;
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\nseries           cases  ns/(n*log2(n))  exponent\n";
+    BOOST_FOREACH( const Fit& f, fits ) {
+        char line[256];
+        sprintf(line, "%-16s %5u %15.2f %9.3f", f.series.c_str(), f.cases, f.ns_per_nlogn, f.exponent);
+        std::cout << line << "\n";
+    }
+}
+
+void print_json(const std::vector<CaseResult>& results, const std::vector<Fit>& fits) {
+    std::ostringstream out;
+    out.precision(9);
+    out << "{\n \"version\": \"" << version() << "\",\n \"build_type\": \"" << build_type() << "\",\n \"cases\": [";
+    for (unsigned int n=0; n<results.size(); ++n) {
+        const CaseResult& r = results[n];
+        out << (n ? ",\n  " : "\n  ");
+        out << "{\"name\": \"" << r.name << "\", \"series\": \"" << r.series << "\", \"sites\": " << r.sites;
+        out << ", \"seconds\": " << r.seconds << ", \"ns_per_site\": " << r.ns_per_site();
+        out << ", \"peak_rss_kb\": " << r.peak_rss_kb << ", \"vertices\": " << r.vertices;
+        out << ", \"valid\": " << (r.valid ? "true" : "false");
+        out << ", \"offset_seconds\": " << r.offset_seconds << ", \"offset_loops\": " << r.offset_loops;
+        out << ", \"medial_seconds\": " << r.medial_seconds << ", \"medial_points\": " << r.medial_points << "}";
+    }
+    out << "\n ],\n \"fits\": [";
+    for (unsigned int n=0; n<fits.size(); ++n) {
+        const Fit& f = fits[n];
+        out << (n ? ",\n  " : "\n  ");
+        out << "{\"series\": \"" << f.series << "\", \"cases\": " << f.cases;
+        out << ", \"ns_per_nlog2n\": " << f.ns_per_nlogn << ", \"exponent\": " << f.exponent << "}";
+    }
+    out << "\n ]\n}\n";
+    std::cout << out.str();
+}
+
+int main(int argc, char* argv[]) {
+    bool quick = false;
+    bool json = false;
+    std::string data = "../src/test/data";
+    unsigned int max_sites = 0;
+    for (int n=1; n<argc; ++n) {
+        std::string arg = argv[n];
+        if ( arg == "--quick" ) {
+            quick = true;
+        } else if ( arg == "--json" ) {
+            json = true;
+        } else if ( arg == "--data" && n+1 < argc ) {
+            data = argv[++n];
+        } else if ( arg == "--max" && n+1 < argc ) {
+            max_sites = atoi( argv[++n] );
+        } else {
+            std::cout << "usage: ovd_bench [--quick] [--json] [--data <dir>] [--max <n>]\n";
+            return -1;
+        }
+    }
+
+    std::vector<unsigned int> sizes;
+    sizes.push_back(1000);
+    sizes.push_back(4000);
+    if (!quick) {
+        sizes.push_back(16000);
+        sizes.push_back(64000);
+    }
+    std::vector<unsigned int> seg_sizes;
+    seg_sizes.push_back(128);
+    seg_sizes.push_back(512);
+    if (!quick) {
+        seg_sizes.push_back(1024);
+        seg_sizes.push_back(2048);
+        seg_sizes.push_back(4096);
+    }
+
+    std::vector<CaseResult> results;
+    BOOST_FOREACH( unsigned int n, sizes ) {
+        if ( max_sites && n > max_sites )
+            continue;
+        std::ostringstream s;
+        s << "_" << n;
+        results.push_back( run_points( "points_random"+s.str(), "points_random", random_points(n), false ) );
+        results.push_back( run_points( "points_bulk"+s.str(), "points_bulk", random_points(n), true ) );
+        results.push_back( run_points( "points_grid"+s.str(), "points_grid", grid_points(n), false ) );
+        if ( n <= 16000 ) // cocircular points take O(n^2) time
+            results.push_back( run_points( "points_circle"+s.str(), "points_circle", circle_points(n), false ) );
+    }
+    BOOST_FOREACH( unsigned int n, seg_sizes ) {
+        if ( max_sites && 3*n > max_sites ) // two points and a line-site per segment
+            continue;
+        std::ostringstream s;
+        s << n;
+        Chains segs;
+        if ( read_chains( data+"/randomsegments_"+s.str()+".bin", segs ) )
+            results.push_back( run_chains( "segments_"+s.str(), "segments", segs ) );
+        else
+            std::cerr << "ovd_bench: " << data << "/randomsegments_" << n << ".bin not found, skipped.\n";
+    }
+    for (unsigned int k=4; k <= (quick ? 4u : 16u); k*=2) {
+        if ( max_sites && 2*64*k*k > max_sites )
+            continue;
+        std::ostringstream s;
+        s << "stars_" << k*k << "x64";
+        results.push_back( run_chains( s.str(), "stars", star_polygons(k, 64) ) );
+    }
+    Chains glyphs;
+    if ( read_chains( data+"/ttt_alphabet.bin", glyphs ) )
+        results.push_back( run_chains( "ttt_alphabet", "ttt_alphabet", glyphs ) );
+
+    std::vector<Fit> fits = fit_series(results);
+    if (json)
+        print_json(results, fits);
+    else
+        print_table(results, fits);
+
+    BOOST_FOREACH( const CaseResult& r, results ) {
+        if ( !r.valid )
+            return -1;
+    }
+    return 0;
+}
@@ -59,17 +59,45 @@ bool VoronoiDiagramChecker::face_count_equals_generator_count() {
 /// however SPLIT and APEX vertices are of degree 2.
 bool VoronoiDiagramChecker::vertex_degree_ok() {
     BOOST_FOREACH(HEVertex v, g.vertices() ) {
-        if ( g.degree(v) != VoronoiVertex::expected_degree[ g[v].type ] ) {
+        if ( g.degree(v) != VoronoiVertex::expected_degree( g[v].type ) ) {
             std::cout << " vertex_degree_ok() ERROR\n";
             std::cout << " vertex " << g[v].index << " type = " << g[v].type << "\n";
             std::cout << " vertex degree = " << g.degree(v) << "\n";
-            std::cout << " expected degree = " << VoronoiVertex::expected_degree[ g[v].type ]  << "\n";
+            std::cout << " expected degree = " << VoronoiVertex::expected_degree( g[v].type )  << "\n";
             return false;
         }
     }
     return true;
 }
 
+/// check the degree of the vertices on face f
+bool VoronoiDiagramChecker::face_vertex_degree_ok(HEFace f) {
+    HEEdge start = g[f].edge;
+    HEEdge current = start;
+    do {
+        HEVertex v = g.target(current);
+        if ( g.degree(v) != VoronoiVertex::expected_degree( g[v].type ) ) {
+            std::cout << " face_vertex_degree_ok() ERROR face " << f << "\n";
+            std::cout << " vertex " << g[v].index << " type = " << g[v].type << "\n";
+            std::cout << " vertex degree = " << g.degree(v) << "\n";
+            std::cout << " expected degree = " << VoronoiVertex::expected_degree( g[v].type )  << "\n";
+            return false;
+        }
+        current = g[current].next;
+    } while (current != start);
+    return true;
+}
+
+/// check the given faces, i.e. the faces that an insertion has modified.
+/// this is a local version of is_valid(), with cost proportional to the size of the faces.
+bool VoronoiDiagramChecker::faces_ok(const FaceVector& faces) {
+    BOOST_FOREACH( HEFace f, faces ) {
+        if ( !face_ok(f) || !face_vertex_degree_ok(f) )
+            return false;
+    }
+    return true;
+}
+
 /// traverse the incident faces and check next-pointers
 /*
 bool VoronoiDiagramChecker::allIncidentFacesOK() { // have this take incident_faces as a parameter?
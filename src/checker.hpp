@@ -36,6 +36,8 @@ public:
     bool face_count_equals_generator_count();
     /// the diagram should be of degree three (at least with point generators)
     bool vertex_degree_ok();
+    /// check the degree of the vertices on face f
+    bool face_vertex_degree_ok(HEFace f);
     /// traverse the incident faces and check next-pointers
     //bool allIncidentFacesOK();
     /// check that all vertices in the input vector are of type IN
@@ -47,6 +49,8 @@ public:
     bool in_circle_is_negative( const Point& p, HEVertex minimalVertex );
     bool current_face_equals_next_face( HEEdge e); 
     bool face_ok(HEFace f, bool debug=false);
+    /// check the given faces, and the degree of the vertices on them
+    bool faces_ok(const FaceVector& faces);
     bool all_faces_ok();
     bool check_edge(HEEdge e) const ;
     
@@ -0,0 +1,143 @@
+/*
+ *  Copyright 2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef CLEARANCE_INDEX_HPP
+#define CLEARANCE_INDEX_HPP
+
+#include <vector>
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+
+#include "graph.hpp"
+
+namespace ovd
+{
+
+/// \brief an index of the clearance-intervals of the edges of a voronoi-diagram.
+///
+/// the clearance of an edge goes from the dist() of one of its vertices to the dist()
+/// of the other. An offset at distance t crosses the edges whose clearance-interval
+/// (min,max) brackets t, i.e. min<t<max.
+///
+/// the intervals are sorted by their lower end, and the sorted vector is used as an implicit
+/// balanced binary tree: the node of the range [b,e) is at m=(b+e)/2, and max_hi[m] holds the
+/// largest upper end in the range. faces(t) skips every range where max_hi<=t, and the
+/// right part of every range where the lower end of the node is >=t. Finding the k
+/// intervals that bracket t costs O(k log n) instead of a walk over all n edges.
+///
+/// the index is a snapshot of the diagram. Call build() again if the diagram changes,
+/// up_to_date() tells if it has.
+class ClearanceIndex {
+public:
+    ClearanceIndex() : generation(0) {}
+    /// index the edges of all faces of g
+    void build(HEGraph& g) {
+        generation = g.generation();
+        intervals.clear();
+        intervals.reserve( g.num_edges() );
+        for(HEFace f=0; f<g.num_faces() ; f++) {
+            HEEdge start = g[f].edge;
+            HEEdge current = start;
+            do {
+                double src_r = g[ g.source(current) ].dist();
+                double trg_r = g[ g.target(current) ].dist();
+                if ( src_r != trg_r ) // an interval of zero length never brackets t
+                    intervals.push_back( Interval( std::min(src_r,trg_r), std::max(src_r,trg_r), f ) );
+                current = g[current].next;
+            } while ( current!=start );
+        }
+        std::sort( intervals.begin(), intervals.end() );
+        max_hi.resize( intervals.size() );
+        build_max(0, intervals.size() );
+    }
+    /// true if build() has not been called, or the diagram has no edges
+    bool empty() const { return intervals.empty(); }
+    /// true if the index was built from g, and g has not changed since
+    bool up_to_date(const HEGraph& g) const { return !empty() && generation == g.generation(); }
+    /// the faces that have at least one edge with min<t<max, in increasing order
+    void faces(double t, FaceVector& out) const {
+        out.clear();
+        query(0, intervals.size(), t, out);
+        std::sort( out.begin(), out.end() );
+        out.erase( std::unique( out.begin(), out.end() ), out.end() );
+    }
+    /// the faces for all the distances in ts: out[n] holds faces(ts[n]).
+    /// the intervals are swept once in clearance order, while a cursor moves
+    /// over the sorted distances, so this costs O(n + output) after sorting ts.
+    void faces(const std::vector<double>& ts, std::vector<FaceVector>& out) const {
+        std::vector< std::pair<double,unsigned int> > levels; // (t, n), sorted by t
+        levels.reserve( ts.size() );
+        for (unsigned int n=0; n<ts.size(); ++n)
+            levels.push_back( std::make_pair(ts[n], n) );
+        std::sort( levels.begin(), levels.end() );
+        out.assign( ts.size(), FaceVector() );
+        unsigned int first = 0; // the first level with lo<t, for the current interval
+        BOOST_FOREACH( const Interval& i, intervals ) {
+            while ( first<levels.size() && levels[first].first <= i.lo )
+                first++;
+            for (unsigned int m=first; m<levels.size() && levels[m].first < i.hi; ++m)
+                out[ levels[m].second ].push_back( i.face );
+        }
+        BOOST_FOREACH( FaceVector& f, out ) {
+            std::sort( f.begin(), f.end() );
+            f.erase( std::unique( f.begin(), f.end() ), f.end() );
+        }
+    }
+private:
+    /// the clearance-interval of one edge
+    struct Interval {
+        Interval(double l, double h, HEFace f): lo(l), hi(h), face(f) {}
+        double lo;
+        double hi;
+        HEFace face; ///< the face of the edge
+        bool operator<(const Interval& other) const { return lo < other.lo; }
+    };
+    // set max_hi for the range [b,e), and return it
+    double build_max(unsigned int b, unsigned int e) {
+        if ( b >= e )
+            return 0; // dist() is never negative
+        unsigned int m = (b+e)/2;
+        double left = build_max(b, m);
+        double right = build_max(m+1, e);
+        max_hi[m] = std::max( intervals[m].hi, std::max(left,right) );
+        return max_hi[m];
+    }
+    // append the faces of the intervals in [b,e) that bracket t
+    void query(unsigned int b, unsigned int e, double t, FaceVector& out) const {
+        if ( b >= e )
+            return;
+        unsigned int m = (b+e)/2;
+        if ( max_hi[m] <= t ) // no interval in this range reaches t
+            return;
+        query(b, m, t, out);
+        if ( intervals[m].lo < t ) { // otherwise all intervals in [m,e) start at or after t
+            if ( t < intervals[m].hi )
+                out.push_back( intervals[m].face );
+            query(m+1, e, t, out);
+        }
+    }
+    std::vector<Interval> intervals;
+    std::vector<double> max_hi;
+    /// HEGraph::generation() when the index was built
+    unsigned long generation;
+};
+
+} // end namespace
+#endif
+// end file clearance_index.hpp
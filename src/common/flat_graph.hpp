@@ -0,0 +1,384 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef FLAT_GRAPH_HPP
+#define FLAT_GRAPH_HPP
+
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <cassert>
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/adjacency_iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+
+// flat_graph is a bidirectional graph that stores vertices and edges in
+// contiguous arrays, and uses 32-bit indices as vertex/edge descriptors.
+//
+// It provides the subset of the BGL interface that half_edge_diagram uses
+// (the free functions are in namespace boost, like the other BGL adaptors),
+// so half_edge_diagram can be instantiated on it instead of on a
+// boost::adjacency_list, by passing hedi::flatS as the vertex-list selector.
+//
+// - out-edges and in-edges of a vertex are intrusive doubly-linked lists
+//   threaded through the edge records, so add/remove of an edge is O(1)
+//   and out-edges are visited in the order they were added (as with listS).
+// - edges are allocated in pairs: add_twin_edge_pair() places the two
+//   half-edges in slots 2k and 2k+1, so the twin of such an edge is e^1,
+//   and twins share a cache-line.
+// - deleted vertex slots, and edge-pairs whose both slots are deleted,
+//   are kept on free-lists and re-used.
+//
+// Unlike with listS, descriptors are plain indices: a descriptor of a
+// removed vertex/edge may later refer to a new vertex/edge in the same slot.
+
+namespace hedi  {
+
+/// selector for the flat_graph storage backend of half_edge_diagram
+struct flatS {};
+
+/// an invalid index. default-constructed descriptors have this index.
+const unsigned int flat_null_index = 0xFFFFFFFF;
+
+/// vertex or edge descriptor for flat_graph, an index into the vertex/edge array.
+template <class Tag>
+struct flat_descriptor {
+    flat_descriptor() : idx(flat_null_index) {}
+    explicit flat_descriptor(unsigned int i) : idx(i) {}
+    bool operator==(const flat_descriptor& other) const { return idx == other.idx; }
+    bool operator!=(const flat_descriptor& other) const { return idx != other.idx; }
+    bool operator<(const flat_descriptor& other) const { return idx < other.idx; }
+    /// slot index of this vertex/edge
+    unsigned int idx;
+};
+
+template <class Tag>
+std::ostream& operator<<(std::ostream& stream, const flat_descriptor<Tag>& d) {
+    return stream << d.idx;
+}
+
+struct flat_vertex_tag {};
+struct flat_edge_tag {};
+/// vertex descriptor of flat_graph
+typedef flat_descriptor<flat_vertex_tag> flat_vertex;
+/// edge descriptor of flat_graph
+typedef flat_descriptor<flat_edge_tag> flat_edge;
+
+template <class TVertexProperties, class TEdgeProperties>
+class flat_graph {
+public:
+    /// a vertex slot
+    struct vertex_record {
+        explicit vertex_record(const TVertexProperties& p) : prop(p), first_out(flat_null_index), last_out(flat_null_index),
+                                                             first_in(flat_null_index), out_degree(0), in_degree(0), alive(true) {}
+        TVertexProperties prop;
+        unsigned int first_out;
+        unsigned int last_out;
+        unsigned int first_in;
+        unsigned int out_degree;
+        unsigned int in_degree;
+        bool alive;
+    };
+    /// an edge slot. the slot is unused if source==flat_null_index
+    struct edge_record {
+        edge_record() : source(flat_null_index), target(flat_null_index),
+                        prev_out(flat_null_index), next_out(flat_null_index),
+                        prev_in(flat_null_index), next_in(flat_null_index) {}
+        TEdgeProperties prop;
+        unsigned int source;
+        unsigned int target;
+        unsigned int prev_out;
+        unsigned int next_out;
+        unsigned int prev_in;
+        unsigned int next_in;
+    };
+
+    /// iterates over used slots in the vertex or edge array
+    template <class Descriptor, class Record>
+    class slot_iterator : public boost::iterator_facade< slot_iterator<Descriptor,Record>,
+                                                         Descriptor,
+                                                         boost::forward_traversal_tag,
+                                                         Descriptor > {
+    public:
+        slot_iterator() : slots(0), idx(0) {}
+        slot_iterator(const std::vector<Record>* s, unsigned int i) : slots(s), idx(i) { skip(); }
+    private:
+        friend class boost::iterator_core_access;
+        void skip() {
+            while ( idx < slots->size() && !flat_graph::is_alive( (*slots)[idx] ) )
+                ++idx;
+        }
+        void increment() { ++idx; skip(); }
+        bool equal(const slot_iterator& other) const { return idx == other.idx; }
+        Descriptor dereference() const { return Descriptor(idx); }
+        const std::vector<Record>* slots;
+        unsigned int idx;
+    };
+
+    /// iterates over the out-edges (Out=true) or in-edges (Out=false) of a vertex
+    template <bool Out>
+    class incidence_iterator : public boost::iterator_facade< incidence_iterator<Out>,
+                                                              flat_edge,
+                                                              boost::forward_traversal_tag,
+                                                              flat_edge > {
+    public:
+        incidence_iterator() : edges(0), idx(flat_null_index) {}
+        incidence_iterator(const std::vector<edge_record>* e, unsigned int i) : edges(e), idx(i) {}
+    private:
+        friend class boost::iterator_core_access;
+        void increment() { idx = Out ? (*edges)[idx].next_out : (*edges)[idx].next_in; }
+        bool equal(const incidence_iterator& other) const { return idx == other.idx; }
+        flat_edge dereference() const { return flat_edge(idx); }
+        const std::vector<edge_record>* edges;
+        unsigned int idx;
+    };
+
+    // BGL graph_traits
+    typedef flat_vertex                                 vertex_descriptor;
+    typedef flat_edge                                   edge_descriptor;
+    typedef slot_iterator<flat_vertex, vertex_record>   vertex_iterator;
+    typedef slot_iterator<flat_edge, edge_record>       edge_iterator;
+    typedef incidence_iterator<true>                    out_edge_iterator;
+    typedef incidence_iterator<false>                   in_edge_iterator;
+    typedef typename boost::adjacency_iterator_generator<flat_graph,
+                                                         vertex_descriptor,
+                                                         out_edge_iterator>::type adjacency_iterator;
+    typedef boost::bidirectional_tag                    directed_category;
+    typedef boost::allow_parallel_edge_tag              edge_parallel_category;
+    typedef boost::bidirectional_graph_tag              traversal_category;
+    typedef unsigned int                                vertices_size_type;
+    typedef unsigned int                                edges_size_type;
+    typedef unsigned int                                degree_size_type;
+
+    flat_graph() : n_vertices(0), n_edges(0) {}
+
+    inline TVertexProperties& operator[](flat_vertex v) { return vertices[v.idx].prop; }
+    inline const TVertexProperties& operator[](flat_vertex v) const { return vertices[v.idx].prop; }
+    inline TEdgeProperties& operator[](flat_edge e) { return edges[e.idx].prop; }
+    inline const TEdgeProperties& operator[](flat_edge e) const { return edges[e.idx].prop; }
+
+    /// add a vertex with given properties, re-using a free slot if there is one
+    flat_vertex add_vertex(const TVertexProperties& prop) {
+        unsigned int idx;
+        if ( free_vertices.empty() ) {
+            idx = vertices.size();
+            vertices.push_back( vertex_record(prop) );
+        } else {
+            idx = free_vertices.back();
+            free_vertices.pop_back();
+            vertices[idx] = vertex_record(prop);
+        }
+        ++n_vertices;
+        return flat_vertex(idx);
+    }
+    /// remove a vertex. the vertex must not have any edges.
+    void remove_vertex(flat_vertex v) {
+        assert( vertices[v.idx].alive );
+        assert( vertices[v.idx].out_degree == 0 && vertices[v.idx].in_degree == 0 );
+        vertices[v.idx].alive = false;
+        free_vertices.push_back(v.idx);
+        --n_vertices;
+    }
+    /// add a single v1-v2 edge. the other slot of its pair is left unused.
+    flat_edge add_edge(flat_vertex v1, flat_vertex v2, const TEdgeProperties& prop) {
+        TEdgeProperties p(prop); // prop may refer into edges, which allocate_pair() can reallocate
+        unsigned int idx = allocate_pair();
+        link(idx, v1.idx, v2.idx, p);
+        return flat_edge(idx);
+    }
+    /// add the twin edges v1-v2 and v2-v1, in adjacent slots
+    std::pair<flat_edge,flat_edge> add_edge_pair(flat_vertex v1, flat_vertex v2) {
+        unsigned int idx = allocate_pair();
+        link(idx,   v1.idx, v2.idx, TEdgeProperties());
+        link(idx+1, v2.idx, v1.idx, TEdgeProperties());
+        return std::make_pair( flat_edge(idx), flat_edge(idx+1) );
+    }
+    /// remove an edge. when both slots of the pair are unused the pair is free for re-use.
+    void remove_edge(flat_edge e) {
+        unsigned int idx = e.idx;
+        edge_record& r = edges[idx];
+        assert( is_alive(r) );
+        vertex_record& src = vertices[r.source];
+        vertex_record& trg = vertices[r.target];
+        // unlink from the out-list of the source
+        if (r.prev_out != flat_null_index) edges[r.prev_out].next_out = r.next_out;
+        else                               src.first_out = r.next_out;
+        if (r.next_out != flat_null_index) edges[r.next_out].prev_out = r.prev_out;
+        else                               src.last_out = r.prev_out;
+        --src.out_degree;
+        // unlink from the in-list of the target
+        if (r.prev_in != flat_null_index)  edges[r.prev_in].next_in = r.next_in;
+        else                               trg.first_in = r.next_in;
+        if (r.next_in != flat_null_index)  edges[r.next_in].prev_in = r.prev_in;
+        --trg.in_degree;
+        edges[idx] = edge_record();
+        --n_edges;
+        if ( !is_alive( edges[idx^1] ) )
+            free_pairs.push_back( idx & ~1u );
+    }
+    /// remove all edges connecting to v
+    void clear_vertex(flat_vertex v) {
+        while ( vertices[v.idx].first_out != flat_null_index )
+            remove_edge( flat_edge( vertices[v.idx].first_out ) );
+        while ( vertices[v.idx].first_in != flat_null_index )
+            remove_edge( flat_edge( vertices[v.idx].first_in ) );
+    }
+    /// remove all vertices and edges
+    void clear() {
+        vertices.clear();
+        edges.clear();
+        free_vertices.clear();
+        free_pairs.clear();
+        n_vertices = 0;
+        n_edges = 0;
+    }
+
+    static bool is_alive(const vertex_record& r) { return r.alive; }
+    static bool is_alive(const edge_record& r) { return r.source != flat_null_index; }
+
+//DATA
+    std::vector<vertex_record> vertices;
+    std::vector<edge_record> edges;
+    /// unused vertex slots
+    std::vector<unsigned int> free_vertices;
+    /// first slots of unused edge pairs
+    std::vector<unsigned int> free_pairs;
+    unsigned int n_vertices;
+    unsigned int n_edges;
+private:
+    // return the first slot of an unused edge pair
+    unsigned int allocate_pair() {
+        if ( free_pairs.empty() ) {
+            unsigned int idx = edges.size();
+            edges.resize( idx+2 );
+            return idx;
+        }
+        unsigned int idx = free_pairs.back();
+        free_pairs.pop_back();
+        return idx;
+    }
+    // make slot idx a source-target edge, appended to the out-list of source
+    void link(unsigned int idx, unsigned int source, unsigned int target, const TEdgeProperties& prop) {
+        edge_record& r = edges[idx];
+        r.prop = prop;
+        r.source = source;
+        r.target = target;
+        vertex_record& src = vertices[source];
+        r.prev_out = src.last_out;
+        r.next_out = flat_null_index;
+        if (src.last_out != flat_null_index) edges[src.last_out].next_out = idx;
+        else                                 src.first_out = idx;
+        src.last_out = idx;
+        ++src.out_degree;
+        vertex_record& trg = vertices[target];
+        r.prev_in = flat_null_index;
+        r.next_in = trg.first_in;
+        if (trg.first_in != flat_null_index) edges[trg.first_in].prev_in = idx;
+        trg.first_in = idx;
+        ++trg.in_degree;
+        ++n_edges;
+    }
+};
+
+/// add the twin edges v1-v2 and v2-v1, see half_edge_diagram::add_twin_edges()
+template <class TVertexProperties, class TEdgeProperties>
+std::pair<flat_edge,flat_edge> add_twin_edge_pair(flat_vertex v1, flat_vertex v2,
+                                                  flat_graph<TVertexProperties,TEdgeProperties>& g) {
+    return g.add_edge_pair(v1,v2);
+}
+
+} // end hedi namespace
+
+// BGL interface for flat_graph
+namespace boost {
+
+#define FLAT_GRAPH_TEMPLATE template <class VP, class EP>
+#define FLAT_GRAPH hedi::flat_graph<VP,EP>
+
+FLAT_GRAPH_TEMPLATE
+hedi::flat_vertex source(hedi::flat_edge e, const FLAT_GRAPH& g) { return hedi::flat_vertex( g.edges[e.idx].source ); }
+FLAT_GRAPH_TEMPLATE
+hedi::flat_vertex target(hedi::flat_edge e, const FLAT_GRAPH& g) { return hedi::flat_vertex( g.edges[e.idx].target ); }
+FLAT_GRAPH_TEMPLATE
+unsigned int out_degree(hedi::flat_vertex v, const FLAT_GRAPH& g) { return g.vertices[v.idx].out_degree; }
+FLAT_GRAPH_TEMPLATE
+unsigned int in_degree(hedi::flat_vertex v, const FLAT_GRAPH& g) { return g.vertices[v.idx].in_degree; }
+FLAT_GRAPH_TEMPLATE
+unsigned int degree(hedi::flat_vertex v, const FLAT_GRAPH& g) { return g.vertices[v.idx].out_degree + g.vertices[v.idx].in_degree; }
+FLAT_GRAPH_TEMPLATE
+unsigned int num_vertices(const FLAT_GRAPH& g) { return g.n_vertices; }
+FLAT_GRAPH_TEMPLATE
+unsigned int num_edges(const FLAT_GRAPH& g) { return g.n_edges; }
+
+FLAT_GRAPH_TEMPLATE
+std::pair<typename FLAT_GRAPH::vertex_iterator, typename FLAT_GRAPH::vertex_iterator> vertices(const FLAT_GRAPH& g) {
+    typedef typename FLAT_GRAPH::vertex_iterator Itr;
+    return std::make_pair( Itr(&g.vertices, 0), Itr(&g.vertices, g.vertices.size()) );
+}
+FLAT_GRAPH_TEMPLATE
+std::pair<typename FLAT_GRAPH::edge_iterator, typename FLAT_GRAPH::edge_iterator> edges(const FLAT_GRAPH& g) {
+    typedef typename FLAT_GRAPH::edge_iterator Itr;
+    return std::make_pair( Itr(&g.edges, 0), Itr(&g.edges, g.edges.size()) );
+}
+FLAT_GRAPH_TEMPLATE
+std::pair<typename FLAT_GRAPH::out_edge_iterator, typename FLAT_GRAPH::out_edge_iterator> out_edges(hedi::flat_vertex v, const FLAT_GRAPH& g) {
+    typedef typename FLAT_GRAPH::out_edge_iterator Itr;
+    return std::make_pair( Itr(&g.edges, g.vertices[v.idx].first_out), Itr(&g.edges, hedi::flat_null_index) );
+}
+FLAT_GRAPH_TEMPLATE
+std::pair<typename FLAT_GRAPH::in_edge_iterator, typename FLAT_GRAPH::in_edge_iterator> in_edges(hedi::flat_vertex v, const FLAT_GRAPH& g) {
+    typedef typename FLAT_GRAPH::in_edge_iterator Itr;
+    return std::make_pair( Itr(&g.edges, g.vertices[v.idx].first_in), Itr(&g.edges, hedi::flat_null_index) );
+}
+/// the first v1-v2 edge, if there is one
+FLAT_GRAPH_TEMPLATE
+std::pair<hedi::flat_edge, bool> edge(hedi::flat_vertex v1, hedi::flat_vertex v2, const FLAT_GRAPH& g) {
+    for (unsigned int e = g.vertices[v1.idx].first_out; e != hedi::flat_null_index; e = g.edges[e].next_out) {
+        if ( g.edges[e].target == v2.idx )
+            return std::make_pair( hedi::flat_edge(e), true );
+    }
+    return std::make_pair( hedi::flat_edge(), false );
+}
+
+FLAT_GRAPH_TEMPLATE
+hedi::flat_vertex add_vertex(FLAT_GRAPH& g) { return g.add_vertex( VP() ); }
+FLAT_GRAPH_TEMPLATE
+hedi::flat_vertex add_vertex(const VP& prop, FLAT_GRAPH& g) { return g.add_vertex( prop ); }
+FLAT_GRAPH_TEMPLATE
+void clear_vertex(hedi::flat_vertex v, FLAT_GRAPH& g) { g.clear_vertex(v); }
+FLAT_GRAPH_TEMPLATE
+void remove_vertex(hedi::flat_vertex v, FLAT_GRAPH& g) { g.remove_vertex(v); }
+FLAT_GRAPH_TEMPLATE
+std::pair<hedi::flat_edge, bool> add_edge(hedi::flat_vertex v1, hedi::flat_vertex v2, FLAT_GRAPH& g) {
+    return std::make_pair( g.add_edge(v1, v2, EP() ), true );
+}
+FLAT_GRAPH_TEMPLATE
+std::pair<hedi::flat_edge, bool> add_edge(hedi::flat_vertex v1, hedi::flat_vertex v2, const EP& prop, FLAT_GRAPH& g) {
+    return std::make_pair( g.add_edge(v1, v2, prop), true );
+}
+FLAT_GRAPH_TEMPLATE
+void remove_edge(hedi::flat_edge e, FLAT_GRAPH& g) { g.remove_edge(e); }
+
+#undef FLAT_GRAPH_TEMPLATE
+#undef FLAT_GRAPH
+
+} // end boost namespace
+
+#endif
+// end flat_graph.hpp
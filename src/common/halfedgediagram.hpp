@@ -27,6 +27,8 @@
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/assign/list_of.hpp>
 
+#include "flat_graph.hpp"
+
 // bundled BGL properties, see: http://www.boost.org/doc/libs/1_44_0/libs/graph/doc/bundles.html
 
 // dcel notes from http://www.holmes3d.net/graphics/dcel/
@@ -57,7 +59,8 @@
 /// attaching information to vertices/edges/faces that is 
 /// required for a particular algorithm.
 /// 
-/// Inherits from boost::adjacency_list
+/// Vertices and edges are stored in a boost::adjacency_list, or in a
+/// hedi::flat_graph when TVertexList is hedi::flatS.
 /// minor additions allow storing face-properties.
 ///
 /// the hedi namespace contains functions for manipulating HEDIGraphs
@@ -69,6 +72,44 @@
 
 namespace hedi  { 
 
+/// the graph type used for storing vertices and edges.
+/// boost::adjacency_list, or flat_graph if TVertexList is flatS
+template <class TOutEdgeList, class TVertexList, class TDirected,
+          class TVertexProperties, class TEdgeProperties, class TGraphProperties, class TEdgeList>
+struct graph_storage {
+    typedef boost::adjacency_list< TOutEdgeList, TVertexList, TDirected,
+                                   TVertexProperties, TEdgeProperties,
+                                   TGraphProperties, TEdgeList > type;
+};
+
+template <class TOutEdgeList, class TDirected,
+          class TVertexProperties, class TEdgeProperties, class TGraphProperties, class TEdgeList>
+struct graph_storage<TOutEdgeList, flatS, TDirected, TVertexProperties, TEdgeProperties, TGraphProperties, TEdgeList> {
+    typedef flat_graph< TVertexProperties, TEdgeProperties > type;
+};
+
+/// vertex and edge descriptor types, which are needed before the property-classes are defined.
+/// this is boost::adjacency_list_traits, or flat_vertex/flat_edge if TVertexList is flatS
+template <class TOutEdgeList, class TVertexList, class TDirected, class TEdgeList>
+struct half_edge_diagram_traits {
+    typedef boost::adjacency_list_traits< TOutEdgeList, TVertexList, TDirected, TEdgeList > Traits;
+    typedef typename Traits::vertex_descriptor vertex_descriptor;
+    typedef typename Traits::edge_descriptor edge_descriptor;
+};
+
+template <class TOutEdgeList, class TDirected, class TEdgeList>
+struct half_edge_diagram_traits<TOutEdgeList, flatS, TDirected, TEdgeList> {
+    typedef flat_vertex vertex_descriptor;
+    typedef flat_edge edge_descriptor;
+};
+
+/// add the twin edges v1-v2 and v2-v1. flat_graph overloads this to place them in adjacent slots.
+template <class Graph>
+std::pair< typename boost::graph_traits<Graph>::edge_descriptor, typename boost::graph_traits<Graph>::edge_descriptor >
+add_twin_edge_pair( typename boost::graph_traits<Graph>::vertex_descriptor v1,
+                    typename boost::graph_traits<Graph>::vertex_descriptor v2, Graph& g) {
+    return std::make_pair( boost::add_edge( v1, v2, g).first, boost::add_edge( v2, v1, g).first );
+}
 
 template <class TOutEdgeList, 
           class TVertexList,
@@ -82,14 +123,14 @@ template <class TOutEdgeList,
 class half_edge_diagram {
 public:
     typedef unsigned int Face; 
-    typedef typename boost::adjacency_list< TOutEdgeList,            
-                                            TVertexList,            
-                                            TDirected,   
-                                            TVertexProperties,             
-                                            TEdgeProperties,                
-                                            TGraphProperties,
-                                            TEdgeList
-                                            > BGLGraph;
+    typedef typename graph_storage< TOutEdgeList,            
+                                    TVertexList,            
+                                    TDirected,   
+                                    TVertexProperties,             
+                                    TEdgeProperties,                
+                                    TGraphProperties,
+                                    TEdgeList
+                                    >::type BGLGraph;
     typedef typename boost::graph_traits< BGLGraph >::edge_descriptor   Edge;
     typedef typename boost::graph_traits< BGLGraph >::vertex_descriptor Vertex;
     typedef typename boost::graph_traits< BGLGraph >::vertex_iterator   VertexItr;
@@ -128,7 +169,7 @@ public:
     std::vector< TFaceProperties > faces; // this could maybe be held as a GraphProperty of the BGL-graph?
     BGLGraph g;
     
-// NOTE: there is no HEDIGraph constructor, we use the default one..
+half_edge_diagram() : next_edge_index(0), edge_generation(0) {}
 
 virtual ~half_edge_diagram(){
     // sites are associated with faces. go through all faces and delete the site
@@ -159,12 +200,42 @@ unsigned int num_faces() const { return faces.size(); }
 unsigned int num_vertices() const { return boost::num_vertices( g ); }
 /// return number of edges in graph
 unsigned int num_edges() const { return boost::num_edges( g ); }
+/// one more than the largest edge index given out so far. indices of removed edges are not reused
+/// until compact_edge_indices() is called, so arrays indexed by edge index (e.g. a FilterView)
+/// must be sized with this, not with num_edges().
+unsigned int edge_index_bound() const { return next_edge_index; }
+/// number the edges 0..num_edges()-1, so that edge_index_bound()==num_edges().
+/// this costs one pass over the edges. edge indices held outside the diagram, e.g. in a
+/// FilterView, are no longer valid afterwards.
+void compact_edge_indices() {
+    next_edge_index = 0;
+    BOOST_FOREACH( Edge e, boost::edges( g ) ) {
+        g[e].index = next_edge_index++;
+    }
+    edge_generation++;
+}
+/// give out edge indices from n. used when a saved diagram, with its edge indices, is loaded
+void set_edge_index_bound(unsigned int n) { next_edge_index = n; }
+/// a counter that grows whenever an edge is added or the diagram is cleared.
+/// a snapshot of the diagram, such as a ClearanceIndex, is out of date when this has changed.
+unsigned long generation() const { return edge_generation; }
+/// remove all vertices, edges and faces, and delete the sites of the faces
+void clear() {
+    BOOST_FOREACH( TFaceProperties& fprop, faces ) {
+        if (fprop.site)
+            delete fprop.site;
+    }
+    faces.clear();
+    g.clear();
+    next_edge_index = 0;
+    edge_generation++;
+}
 /// return number of edges on Face f
 unsigned int num_edges(Face f) { return face_edges(f).size(); }
 /// add an edge between vertices v1-v2
-Edge add_edge(Vertex v1, Vertex v2) { return boost::add_edge( v1, v2, g).first; }
+Edge add_edge(Vertex v1, Vertex v2) { return number_edge( boost::add_edge( v1, v2, g).first ); }
 /// add an edge with given properties between vertices v1-v2
-Edge add_edge( Vertex v1, Vertex  v2, const TEdgeProperties& prop ) { return boost::add_edge( v1, v2, prop, g).first; }
+Edge add_edge( Vertex v1, Vertex  v2, const TEdgeProperties& prop ) { return number_edge( boost::add_edge( v1, v2, prop, g).first ); }
 std::pair<OutEdgeItr, OutEdgeItr> out_edge_itr( Vertex v ) { return boost::out_edges( v, g ); }
 /// return true if v1-v2 edge exists
 bool has_edge( Vertex v1, Vertex v2) { return boost::edge( v1, v2, g ).second; }
@@ -213,8 +284,8 @@ void add_vertex_in_edge( Vertex v, Edge e) {
     Edge e2, te1;
     boost::tie(e2,te1) = add_twin_edges( v, etarget );    
     // next-pointers
-    set_next_chain( boost::assign::list_of(previous)(e1)(e2)(g[e].next) );
-    set_next_chain( boost::assign::list_of(twin_previous)(te1)(te2)(g[e_twin].next) );    
+    set_next_chain( previous, e1, e2, g[e].next );
+    set_next_chain( twin_previous, te1, te2, g[e_twin].next );
     // this copies params, face, k, type
     g[e1] = g[e];       g[e2] = g[e];       // NOTE: we use EdgeProperties::operator= here to copy !
     g[te1] = g[e_twin]; g[te2] = g[e_twin];
@@ -222,14 +293,15 @@ void add_vertex_in_edge( Vertex v, Edge e) {
     faces[face].edge = e1;
     faces[twin_face].edge = te1;
     // finally, remove the old edge
-    remove_twin_edges(esource, etarget);
+    remove_edge(e);
+    remove_edge(e_twin);
 }
 
 std::pair<Edge,Edge> add_twin_edges(Vertex v1, Vertex v2) {
     Edge e1,e2;
-    bool b;
-    boost::tie( e1 , b ) = boost::add_edge( v1, v2, g);
-    boost::tie( e2 , b ) = boost::add_edge( v2, v1, g);
+    boost::tie( e1 , e2 ) = add_twin_edge_pair( v1, v2, g);
+    number_edge(e1);
+    number_edge(e2);
     twin_edges(e1,e2);
     return std::make_pair(e1,e2);
 }
@@ -475,8 +547,12 @@ void remove_deg2_vertex( Vertex v ) {
     //    v1_next <- v1 <---------- v2 <- v2_prev
     //                     face2
     
-    EdgeVector v_edges = out_edges(v);
-    assert( v_edges.size() == 2);
+    assert( boost::out_degree(v,g) == 2 );
+    Edge v_edges[2];
+    OutEdgeItr it, it_end;
+    boost::tie( it, it_end ) = boost::out_edges( v, g );
+    v_edges[0] = *it++;
+    v_edges[1] = *it;
     assert( source(v_edges[0]) == v && source(v_edges[1]) == v );
      
     Vertex v1 = target( v_edges[0] );
@@ -553,6 +629,24 @@ void set_next_chain( std::list<Edge> list, Face f, double k) {
     }
 }
 
+// set next-pointers e1->e2->e3->e4 (but don't close to form a cycle)
+// also set face and k properties for the edges
+void set_next_chain( Edge e1, Edge e2, Edge e3, Edge e4, Face f, double k) {
+    set_next_chain(e1,e2,e3,e4);
+    faces[f].edge = e1;
+    g[e1].face = f; g[e1].k = k;
+    g[e2].face = f; g[e2].k = k;
+    g[e3].face = f; g[e3].k = k;
+    g[e4].face = f; g[e4].k = k;
+}
+
+// set next-pointers e1->e2->e3->e4
+void set_next_chain( Edge e1, Edge e2, Edge e3, Edge e4 ) {
+    set_next(e1,e2);
+    set_next(e2,e3);
+    set_next(e3,e4);
+}
+
 // set next-pointers for the list
 void set_next_chain( std::list<Edge> list ) {
     typename std::list<Edge>::iterator it,nxt,end;
@@ -640,13 +734,25 @@ void print_edge(Edge e) {
     std::cout << g[src].index << "-f" << g[e].face << "-" << g[trg].index << "\n";
 }
 
-void print_vertices(VertexVector& q) {
+void print_vertices(const VertexVector& q) {
     BOOST_FOREACH( Vertex v, q) {
         std::cout << g[v].index << "["<< g[v].type << "]" << " ";
     }
     std::cout << std::endl;
 }
 
+private:
+/// give a new edge the next edge index
+Edge number_edge(Edge e) {
+    g[e].index = next_edge_index++;
+    edge_generation++;
+    return e;
+}
+/// the index of the next edge that is added
+unsigned int next_edge_index;
+/// see generation()
+unsigned long edge_generation;
+
 }; // end HEDIGraph class definition
 
 
@@ -50,6 +50,13 @@ namespace numeric {
         else
             return val;
     }
+    dd_real chop(dd_real val) {
+        dd_real _epsilon = 1e-10;
+        if (fabs(val) < _epsilon) 
+            return dd_real(0);
+        else
+            return val;
+    }
     qd_real chop(qd_real val) {
         qd_real _epsilon = 1e-10;
         if (fabs(val) < _epsilon) 
@@ -96,6 +103,11 @@ namespace numeric {
         
         return false;
     }
+    // return true if a and b are the same direction, within eps. 0 and 4 are the same direction.
+    bool diangle_equal(double a, double b, double eps) {
+        double d = fabs(a-b);
+        return ( d <= eps ) || ( 4-d <= eps );
+    }
     // return average of input angles
     double diangle_mid(double alfa1, double alfa2) {
         if (alfa1<=alfa2)
@@ -31,36 +31,36 @@ namespace numeric {
     //double chop8(double a);
     double chop(double val);
     double chop(double val, double tolerance);
+    dd_real chop(dd_real val);
     qd_real chop(qd_real val);
+    /// for solvers templated on the number type, see e.g. LLLSolver
+    inline double to_double(double val) {return val;}
     
     template<class Scalar>
     Scalar sq( Scalar x) {return x*x;}
     
     /// solve quadratic eqn: a*x*x + b*x + c = 0
-    /// returns real roots (0, 1, or 2) as vector
+    /// stores real roots in roots[] and returns the number of roots (0, 1, or 2)
     template<class Scalar>
-    std::vector<Scalar>  quadratic_roots(Scalar a, Scalar b, Scalar c) {
-        std::vector<Scalar> roots;
+    int quadratic_roots(Scalar a, Scalar b, Scalar c, Scalar roots[2]) {
         if ((a == 0) and (b == 0)) {
-            //std::cout << " quadratic_roots() a == b == 0. no roots.\n";
-            return roots;
+            return 0;
         }
         if (a == 0) {
-            roots.push_back( -c / b );
-            return roots;
+            roots[0] = -c / b;
+            return 1;
         }
         if (b == 0) {
             Scalar sqr = -c / a;
             if (sqr > 0) {
-                roots.push_back( sqrt(sqr) );
-                roots.push_back( -roots[0] );
-                return roots;
+                roots[0] = sqrt(sqr);
+                roots[1] = -roots[0];
+                return 2;
             } else if (sqr == 0) {
-                roots.push_back( Scalar(0) );
-                return roots;
+                roots[0] = Scalar(0);
+                return 1;
             } else {
-                //std::cout << " quadratic_roots() b == 0. no roots.\n";
-                return roots;
+                return 0;
             }
         }
         Scalar disc = chop(b*b - 4*a*c); // discriminant, chop!
@@ -70,15 +70,23 @@ namespace numeric {
                 q = (b + sqrt(disc)) / -2;
             else
                 q = (b - sqrt(disc)) / -2;
-            roots.push_back( q / a );
-            roots.push_back( c / q ); 
-            return roots;
+            roots[0] = q / a;
+            roots[1] = c / q; 
+            return 2;
         } else if (disc == 0) {
-            roots.push_back( -b / (2*a) );
-            return roots;
+            roots[0] = -b / (2*a);
+            return 1;
         }
-        //std::cout << " quadratic_roots() disc < 0. no roots. disc= " << disc << "\n";
-        return roots;
+        return 0;
+    }
+
+    /// solve quadratic eqn: a*x*x + b*x + c = 0
+    /// returns real roots (0, 1, or 2) as vector
+    template<class Scalar>
+    std::vector<Scalar>  quadratic_roots(Scalar a, Scalar b, Scalar c) {
+        Scalar roots[2];
+        int n_roots = quadratic_roots(a, b, c, roots);
+        return std::vector<Scalar>( roots, roots+n_roots );
     }
     
     template <class Scalar>
@@ -93,6 +101,7 @@ namespace numeric {
     double diangle_y(double a);
     std::pair<double,double> diangle_xy(double a);
     bool diangle_bracket(double less, double a, double more);
+    bool diangle_equal(double a, double b, double eps);
     double diangle_mid(double alfa1, double alfa2);
     
 } // numeric
@@ -0,0 +1,153 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <limits>
+
+#include <qd/qd_real.h>
+
+#include "predicates.hpp"
+
+namespace ovd {
+namespace predicates {
+
+// unit roundoff of double
+static const double u = 0.5*std::numeric_limits<double>::epsilon();
+// bounds for the absolute error of dx*dx + dy*dy - r*r, relative to dx*dx + dy*dy + r*r.
+// in double, and in dd_real where dx and dy are exact. the bounds are generous.
+static const double in_circle_bound1 = 8*u;
+static const double in_circle_bound2 = 16*u*u;
+
+template<class Scalar>
+static int sign_of(const Scalar& x) {
+    if (x > 0)
+        return 1;
+    else if (x < 0)
+        return -1;
+    return 0;
+}
+
+// make the sign of value agree with the certified sign
+static PredicateResult certified(double value, int sign, int stage) {
+    if (sign == 0)
+        return PredicateResult(0, 0, stage);
+    if ( value*sign <= 0 )
+        value = sign*std::numeric_limits<double>::min();
+    return PredicateResult(value, sign, stage);
+}
+
+// error-free transformations, see Shewchuk 1997, "Adaptive Precision 
+// Floating-Point Arithmetic and Fast Robust Geometric Predicates".
+// a+b = x+y and a*b = x+y exactly, barring overflow and underflow.
+static inline void two_sum(double a, double b, double& x, double& y) {
+    x = a + b;
+    double bv = x - a;
+    double av = x - bv;
+    y = (a - av) + (b - bv);
+}
+
+static inline void split(double a, double& hi, double& lo) {
+    static const double splitter = 134217729.0; // 2^27+1
+    double c = splitter*a;
+    hi = c - (c - a);
+    lo = a - hi;
+}
+
+static inline void two_product(double a, double b, double& x, double& y) {
+    x = a*b;
+    double ahi, alo, bhi, blo;
+    split(a, ahi, alo);
+    split(b, bhi, blo);
+    y = alo*blo - (((x - ahi*bhi) - alo*bhi) - ahi*blo);
+}
+
+// add b to the nonoverlapping expansion e[0..n-1], sorted by increasing magnitude.
+// the result, without zero components, is written to h. returns its length.
+static int grow_expansion(int n, const double* e, double b, double* h) {
+    int m = 0;
+    double q = b;
+    for (int i=0; i<n; ++i) {
+        double hh;
+        two_sum(q, e[i], q, hh);
+        if (hh != 0)
+            h[m++] = hh;
+    }
+    if (q != 0 || m == 0)
+        h[m++] = q;
+    return m;
+}
+
+// the exact sign of dx*dx + dy*dy - r*r, with dx = p.x - c.x and dy = p.y - c.y.
+// each term is written as a sum of doubles, and the terms are summed into an expansion 
+// whose largest (last) component has the sign of the sum.
+static int exact_in_circle_sign(const Point& c, double r, const Point& p) {
+    double terms[14];
+    int n = 0;
+    double dxh, dxl, dyh, dyl;
+    two_sum(p.x, -c.x, dxh, dxl);
+    two_sum(p.y, -c.y, dyh, dyl);
+    two_product(dxh,   dxh, terms[n], terms[n+1]); n += 2;
+    two_product(2*dxh, dxl, terms[n], terms[n+1]); n += 2;
+    two_product(dxl,   dxl, terms[n], terms[n+1]); n += 2;
+    two_product(dyh,   dyh, terms[n], terms[n+1]); n += 2;
+    two_product(2*dyh, dyl, terms[n], terms[n+1]); n += 2;
+    two_product(dyl,   dyl, terms[n], terms[n+1]); n += 2;
+    two_product(-r,    r,   terms[n], terms[n+1]); n += 2;
+    double e[2][16];
+    int len = 0;
+    int cur = 0;
+    for (int i=0; i<n; ++i) {
+        len = grow_expansion(len, e[cur], terms[i], e[1-cur]);
+        cur = 1-cur;
+    }
+    return sign_of( e[cur][len-1] );
+}
+
+PredicateResult in_circle(const Point& c, double r, const Point& p) {
+    // stage 1: double, with a static error-bound
+    double dx = p.x - c.x;
+    double dy = p.y - c.y;
+    double det = dx*dx + dy*dy - r*r;
+    double mag = dx*dx + dy*dy + r*r;
+    int sign;
+    int stage = 1;
+    if ( fabs(det) > in_circle_bound1*mag ) {
+        sign = sign_of(det);
+    } else {
+        // stage 2: dd_real. the difference of two doubles is exact in dd_real,
+        // and the error of the products and the sum is below in_circle_bound2.
+        dd_real ddx = dd_real(p.x) - c.x;
+        dd_real ddy = dd_real(p.y) - c.y;
+        dd_real dr = r;
+        dd_real ddet = ddx*ddx + ddy*ddy - dr*dr;
+        if ( fabs(ddet) > in_circle_bound2*mag ) {
+            sign = sign_of(ddet);
+            stage = 2;
+        } else {
+            // stage 3: exact. p may lie on the circle.
+            sign = exact_in_circle_sign(c, r, p);
+            stage = 3;
+        }
+    }
+    if (sign == 0)
+        return certified(0, 0, stage);
+    return certified( (p-c).norm() - r, sign, stage );
+}
+
+} // predicates
+} // ovd
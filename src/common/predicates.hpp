@@ -0,0 +1,58 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PREDICATES_HPP
+#define PREDICATES_HPP
+
+#include "point.hpp"
+
+namespace ovd {
+
+// this namespace holds geometric predicates with a certified sign.
+// the predicate is first evaluated in double together with an error-bound.
+// only if the result is too close to zero for its sign to be trusted is the 
+// predicate re-evaluated in dd_real arithmetic, and if that is still too close 
+// to zero, exactly.
+namespace predicates {
+
+/// result of a predicate evaluation
+struct PredicateResult {
+    PredicateResult(double v, int s, int st) : value(v), sign(s), stage(st) {}
+    /// the value of the predicate in double. the sign of value is always equal to sign.
+    double value;
+    /// the certified sign of the predicate: -1, 0, or +1
+    int sign;
+    /// the stage that decided the sign: 1 double filter, 2 dd_real, 3 exact
+    int stage;
+    /// true if the double filter decided the sign, i.e. the predicate is not close to zero
+    bool certain() const { return stage == 1; }
+};
+
+/// in-circle predicate for a clearance-disk with center c and radius r.
+/// value is (p-c).norm() - r, so the sign is negative for p inside the disk,
+/// positive for p outside the disk, and zero for p on the circle.
+/// the sign is the exact sign of (p-c).norm_sq() - r*r for the given doubles c, r, and p,
+/// so it is zero only when p lies exactly on the circle.
+PredicateResult in_circle(const Point& c, double r, const Point& p);
+
+} // predicates
+} // ovd
+
+#endif
+// end predicates.hpp
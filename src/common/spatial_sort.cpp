@@ -0,0 +1,105 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "spatial_sort.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+namespace ovd {
+
+// see http://en.wikipedia.org/wiki/Hilbert_curve
+unsigned int hilbert_index(unsigned int x, unsigned int y) {
+    const unsigned int n = 65536;
+    unsigned int d = 0;
+    for (unsigned int s=n/2; s>0; s/=2) {
+        unsigned int rx = (x & s) > 0;
+        unsigned int ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+        // rotate the quadrant so that the curve is continuous
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n-1 - x;
+                y = n-1 - y;
+            }
+            std::swap(x,y);
+        }
+    }
+    return d;
+}
+
+std::vector<unsigned int> brio_order(const std::vector<Point>& pts, unsigned int seed) {
+    const unsigned int n = pts.size();
+    const unsigned int min_round = 64; // smaller rounds are not worth sorting
+    std::vector<unsigned int> order(n);
+    for (unsigned int m=0; m<n; ++m)
+        order[m] = m;
+    if (n == 0)
+        return order;
+
+    // random shuffle (Fisher-Yates)
+    boost::random::mt19937 rng(seed);
+    for (unsigned int m=n-1; m>0; --m) {
+        boost::random::uniform_int_distribution<unsigned int> dist(0,m);
+        std::swap( order[m], order[ dist(rng) ] );
+    }
+
+    // bounding-box of the batch, for mapping points onto the 2^16 x 2^16 Hilbert grid
+    double xmin = pts[0].x, xmax = pts[0].x;
+    double ymin = pts[0].y, ymax = pts[0].y;
+    for (unsigned int m=1; m<n; ++m) {
+        xmin = std::min(xmin, pts[m].x); xmax = std::max(xmax, pts[m].x);
+        ymin = std::min(ymin, pts[m].y); ymax = std::max(ymax, pts[m].y);
+    }
+    double side = std::max(xmax-xmin, ymax-ymin);
+    double scale = (side > 0) ? 65535.0/side : 0.0;
+
+    // rounds are [0,r_k), ..., [n/4, n/2), [n/2, n)
+    std::vector<unsigned int> round_start;
+    for (unsigned int r=n; r>=min_round; r/=2)
+        round_start.push_back(r/2);
+    round_start.push_back(0);
+
+    std::vector< std::pair<unsigned int, unsigned int> > keys; // (hilbert-index, point-index)
+    keys.reserve(n);
+    unsigned int round_end = n;
+    for (unsigned int m=0; m<round_start.size(); ++m) {
+        unsigned int begin = round_start[m];
+        if (begin == round_end)
+            continue;
+        keys.clear();
+        for (unsigned int i=begin; i<round_end; ++i) {
+            const Point& p = pts[ order[i] ];
+            unsigned int hx = (unsigned int)( (p.x-xmin)*scale );
+            unsigned int hy = (unsigned int)( (p.y-ymin)*scale );
+            keys.push_back( std::make_pair( hilbert_index(hx,hy), order[i] ) );
+        }
+        std::sort( keys.begin(), keys.end() );
+        for (unsigned int i=begin; i<round_end; ++i)
+            order[i] = keys[i-begin].second;
+        round_end = begin;
+    }
+    return order;
+}
+
+} // end namespace
+// end spatial_sort.cpp
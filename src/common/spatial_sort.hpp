@@ -0,0 +1,49 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPATIAL_SORT_HPP
+#define SPATIAL_SORT_HPP
+
+#include <vector>
+
+#include "point.hpp"
+
+namespace ovd {
+
+/// position of (x,y) along a Hilbert curve that fills a 2^16 x 2^16 grid.
+/// x and y must be in [0, 65535]
+unsigned int hilbert_index(unsigned int x, unsigned int y);
+
+/// \brief compute a biased randomized insertion order (BRIO) for a batch of points
+///
+/// The points are shuffled and split into rounds of doubling size, roughly
+/// n/2^k, ..., n/4, n/2 points. Each round is sorted along a Hilbert curve
+/// over the bounding-box of the batch. Inserting in this order keeps the
+/// randomization that the incremental algorithm likes, while consecutive
+/// sites are close to each other in the diagram (and in memory).
+/// see Amenta, Choi, Rote, "Incremental constructions con BRIO", 2003.
+///
+/// \param pts the points to order. the coordinates must be finite.
+/// \param seed seed for the random shuffle. The order is deterministic for a given seed.
+/// \return a permutation of 0..pts.size()-1, the order in which to insert pts
+std::vector<unsigned int> brio_order(const std::vector<Point>& pts, unsigned int seed=42);
+
+} // end namespace
+#endif
+// end spatial_sort.hpp
@@ -0,0 +1,167 @@
+/*
+ *  Copyright 2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef DIAGRAM_ARRAYS_HPP
+#define DIAGRAM_ARRAYS_HPP
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+
+#include "graph.hpp"
+#include "site.hpp"
+#include "common/numeric.hpp"
+
+namespace ovd
+{
+
+/// \brief the vertices and edges of a voronoi-diagram as flat arrays.
+///
+/// the arrays are filled in one pass over the diagram, and are laid out as
+/// C-ordered tables, for export without one object per element (see py/diagram_arrays_py.hpp).
+/// vertices and edges are numbered by their row in the tables.
+///
+/// the edges are also sampled as polylines, packed in compressed-sparse-row form:
+/// the points of edge k are the rows edge_offsets[k] ... edge_offsets[k+1]-1 of edge_xy.
+/// straight edges have their two end-points, PARABOLA, ELLIPSE, HYPERBOLA and ARCSITE edges
+/// have edge_points points, and NULLEDGEs have none.
+///
+/// the arrays are a snapshot of the diagram. Call build() again if the diagram changes.
+class DiagramArrays {
+public:
+    /// the columns of edge_table
+    enum EdgeColumn {EDGE_SRC, EDGE_TRG, EDGE_TWIN, EDGE_FACE, EDGE_TYPE, EDGE_VALID, EDGE_COLUMNS};
+    /// the columns of vertex_table
+    enum VertexColumn {VERTEX_INDEX, VERTEX_TYPE, VERTEX_STATUS, VERTEX_COLUMNS};
+
+    DiagramArrays() {}
+    /// fill the arrays from g, with edge_points samples along curved edges
+    void build(HEGraph& g, int edge_points) {
+        vertex_xy.clear();
+        vertex_clearance.clear();
+        vertex_table.clear();
+        edge_table.clear();
+        edge_offsets.clear();
+        edge_xy.clear();
+
+        // the rows of the vertices, by vertex index
+        int max_index = -1;
+        BOOST_FOREACH( HEVertex v, g.vertices() ) {
+            max_index = std::max( max_index, g[v].index );
+        }
+        std::vector<int> vertex_row( max_index+1, -1 );
+        vertex_xy.reserve( 2*g.num_vertices() );
+        vertex_clearance.reserve( g.num_vertices() );
+        vertex_table.reserve( VERTEX_COLUMNS*g.num_vertices() );
+        BOOST_FOREACH( HEVertex v, g.vertices() ) {
+            vertex_row[ g[v].index ] = vertex_clearance.size();
+            vertex_xy.push_back( g[v].position.x );
+            vertex_xy.push_back( g[v].position.y );
+            vertex_clearance.push_back( g[v].dist() );
+            vertex_table.push_back( g[v].index );
+            vertex_table.push_back( g[v].type );
+            vertex_table.push_back( g[v].status );
+        }
+
+        // the rows of the edges, by edge index
+        EdgeVector edges = g.edges();
+        std::vector<int> edge_row( g.edge_index_bound(), -1 );
+        for (unsigned int n=0; n<edges.size(); ++n)
+            edge_row[ g[ edges[n] ].index ] = n;
+        edge_table.reserve( EDGE_COLUMNS*edges.size() );
+        edge_offsets.reserve( edges.size()+1 );
+        edge_offsets.push_back(0);
+        BOOST_FOREACH( HEEdge e, edges ) {
+            HEEdge twin = g[e].twin;
+            edge_table.push_back( vertex_row[ g[ g.source(e) ].index ] );
+            edge_table.push_back( vertex_row[ g[ g.target(e) ].index ] );
+            edge_table.push_back( twin != HEEdge() ? edge_row[ g[twin].index ] : -1 ); // the edges of the outer face have no twin
+            edge_table.push_back( g[e].face );
+            edge_table.push_back( g[e].type );
+            edge_table.push_back( g[e].valid ? 1 : 0 );
+            sample_edge(g, e, edge_points);
+            edge_offsets.push_back( edge_xy.size()/2 );
+        }
+    }
+    /// number of vertices
+    unsigned int num_vertices() const { return vertex_clearance.size(); }
+    /// number of edges
+    unsigned int num_edges() const { return edge_offsets.empty() ? 0 : edge_offsets.size()-1; }
+    /// number of polyline points, for all edges
+    unsigned int num_edge_points() const { return edge_xy.size()/2; }
+
+    /// x,y of each vertex. (num_vertices,2)
+    std::vector<double> vertex_xy;
+    /// the clearance-disk radius of each vertex. (num_vertices)
+    std::vector<double> vertex_clearance;
+    /// index, VoronoiVertexType and VoronoiVertexStatus of each vertex. (num_vertices,VERTEX_COLUMNS)
+    std::vector<int> vertex_table;
+    /// source row, target row, twin row (-1 if none), face, VoronoiEdgeType and valid of each edge.
+    /// (num_edges,EDGE_COLUMNS)
+    std::vector<int> edge_table;
+    /// start of the points of each edge in edge_xy, and the total. (num_edges+1)
+    std::vector<int> edge_offsets;
+    /// x,y of the polyline points of all edges. (num_edge_points,2)
+    std::vector<double> edge_xy;
+private:
+    // append the polyline of e to edge_xy, sampled like VoronoiDiagram_py::getVoronoiEdges()
+    void sample_edge(HEGraph& g, HEEdge e, int edge_points) {
+        HEVertex v1 = g.source(e);
+        HEVertex v2 = g.target(e);
+        switch ( g[e].type ) {
+        case SEPARATOR: case LINE: case LINESITE: case OUTEDGE: case LINELINE: case PARA_LINELINE:
+            add_point( g[v1].position );
+            add_point( g[v2].position );
+            break;
+        case PARABOLA: case ELLIPSE: case HYPERBOLA: {
+            double t_min = std::min( g[v1].dist(), g[v2].dist() );
+            double t_max = std::max( g[v1].dist(), g[v2].dist() );
+            for (int n=0; n<edge_points; n++) {
+                double t = t_min + ((t_max-t_min)/numeric::sq(edge_points-1))*numeric::sq(n);
+                add_point( g[e].point(t) );
+            }
+            break;
+        }
+        case ARCSITE: { // a polyline around the center of the arc
+            Site* s = g[ g[e].face ].site;
+            Point c( s->x(), s->y() );
+            Point p1 = g[v1].position - c;
+            Point p2 = g[v2].position - c;
+            double a1 = atan2( p1.y, p1.x );
+            double da = atan2( p1.cross(p2), p1.dot(p2) ); // arcs are less than a half-circle
+            for (int n=0; n<edge_points; n++) {
+                double a = a1 + da*n/(edge_points-1);
+                add_point( c + s->r()*Point( cos(a), sin(a) ) );
+            }
+            break;
+        }
+        default: // NULLEDGE
+            break;
+        }
+    }
+    void add_point(const Point& p) {
+        edge_xy.push_back(p.x);
+        edge_xy.push_back(p.y);
+    }
+};
+
+} // end namespace
+#endif
+// end file diagram_arrays.hpp
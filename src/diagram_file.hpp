@@ -0,0 +1,559 @@
+/*
+ *  Copyright 2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef DIAGRAM_FILE_HPP
+#define DIAGRAM_FILE_HPP
+
+#include <string>
+#include <vector>
+#include <set>
+#include <ostream>
+#include <cstring>
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <limits>
+
+#include <boost/cstdint.hpp>
+#include <boost/foreach.hpp>
+
+#include "common/point.hpp"
+#include "graph.hpp"
+
+// the binary file format of VoronoiDiagram::save() and VoronoiDiagram::load().
+//
+// all numbers are little-endian, doubles are IEEE-754. The file is a header
+// followed by five tables of fixed-size records. Records refer to each other by
+// their row in a table, so the tables can be used in place, e.g. from a
+// memory-mapped file, see DiagramFileView. The sizes are in bytes.
+//
+// header (DIAGRAM_FILE_HEADER_SIZE)
+//   0 char[8] "OVD-DIAG"
+//   8 u32 version, 12 u32 header size, 16 f64 far-radius, 24 u32 grid bins,
+//  28 i32 next vertex index, 32 u32 edge-index bound, 36 i32 point sites (with the three initial sites),
+//  40 i32 line sites, 44 i32 arc sites, 48 u32 last face, 52 u32 epoch, 56 reserved
+//  64 one entry per table (VERTEX_TABLE ... HANDLE_TABLE): u64 offset, u32 rows, u32 record size
+//
+// vertex (56): 0 f64 x, 8 f64 y, 16 f64 clearance, 24 f64 k3, 32 f64 alfa,
+//              40 i32 index, 44 u32 face, 48 u32 null-face, 52 u8 VoronoiVertexType, 53 u8 VoronoiVertexStatus
+// edge (48):   0 u32 source-row, 4 u32 target-row, 8 u32 next-row, 12 i32 twin-row (-1 if none),
+//              16 u32 face, 20 u32 null-face, 24 u32 index, 28 i32 parameter-row (-1 if none),
+//              32 f64 k, 40 u8 VoronoiEdgeType, 41 u8 flags (EdgeFlag)
+// face (72):   0 i32 edge-row (-1 if none), 4 u32 VoronoiFaceStatus, 8 u8 SiteKind (FACE_NO_SITE if none),
+//              9 u8 cw, 12 u32 face of the site, 16 f64 k of the site, 24 f64 x,y of the point, or of the start,
+//              40 f64 x,y of the end, 56 f64 x,y of the center of an arc
+// parameter (128): 0 f64 x[8], 64 f64 y[8]. twin edges share one parameter row.
+// handle (8):  0 i32 handle from insert_point_site(), 4 u32 vertex-row
+//
+// the faces are in face-index order, so face numbers are also face rows.
+// a file of a newer version is not read.
+
+namespace ovd
+{
+
+/// the version written by DiagramFileWriter
+const unsigned int DIAGRAM_FILE_VERSION = 1;
+/// bytes in the header of a diagram file
+const unsigned int DIAGRAM_FILE_HEADER_SIZE = 144;
+/// the tables of a diagram file, in file order
+enum DiagramFileTable {VERTEX_TABLE, EDGE_TABLE, FACE_TABLE, PARAMETER_TABLE, HANDLE_TABLE, NUM_DIAGRAM_FILE_TABLES};
+/// bytes in a record of the given table
+inline unsigned int diagram_file_record_size(int table) {
+    const unsigned int size[NUM_DIAGRAM_FILE_TABLES] = {56, 48, 72, 128, 8};
+    return size[table];
+}
+/// the flags of an edge record
+enum EdgeFlag {EDGE_HAS_NULL_FACE=1, EDGE_SIGN=2, EDGE_VALID=4, EDGE_INSERTED_DIRECTION=8};
+/// the site-kind of a face without a site (a null-face)
+const unsigned int FACE_NO_SITE = 255;
+
+/// the diagram-wide values in the header of a diagram file
+struct DiagramFileHeader {
+    double far_radius;
+    unsigned int n_bins;
+    int next_vertex_index;
+    unsigned int edge_index_bound;
+    int num_psites;
+    int num_lsites;
+    int num_asites;
+    unsigned int last_face;
+    unsigned int epoch;
+};
+
+/// a vertex record
+struct FileVertex {
+    Point position;
+    double r;
+    double k3;
+    double alfa;
+    int index;
+    unsigned int face;
+    unsigned int null_face;
+    unsigned int type;
+    unsigned int status;
+};
+
+/// an edge record
+struct FileEdge {
+    unsigned int source;
+    unsigned int target;
+    unsigned int next;
+    int twin;
+    unsigned int face;
+    unsigned int null_face;
+    unsigned int index;
+    int parameters;
+    double k;
+    unsigned int type;
+    unsigned int flags;
+};
+
+/// a face record, with the site of the face
+struct FileFace {
+    int edge;
+    unsigned int status;
+    unsigned int site_kind;
+    bool cw;
+    unsigned int site_face;
+    double k;
+    Point start;
+    Point end;
+    Point center;
+};
+
+/// a handle record
+struct FileHandle {
+    int handle;
+    unsigned int vertex;
+};
+
+/// \brief reading and writing of little-endian numbers
+struct LittleEndian {
+    static void store_u32(char* p, boost::uint32_t x) {
+        for (int n=0; n<4; ++n)
+            p[n] = static_cast<char>( (x >> (8*n)) & 0xff );
+    }
+    static void store_u64(char* p, boost::uint64_t x) {
+        for (int n=0; n<8; ++n)
+            p[n] = static_cast<char>( (x >> (8*n)) & 0xff );
+    }
+    static void store_i32(char* p, int x) { store_u32( p, static_cast<boost::uint32_t>(x) ); }
+    static void store_f64(char* p, double x) {
+        boost::uint64_t bits;
+        std::memcpy( &bits, &x, sizeof(bits) );
+        store_u64( p, bits );
+    }
+    static void store_u8(char* p, unsigned int x) { *p = static_cast<char>(x & 0xff); }
+
+    static boost::uint32_t u32(const char* p) {
+        const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+        return boost::uint32_t(b[0]) | (boost::uint32_t(b[1]) << 8) | (boost::uint32_t(b[2]) << 16) | (boost::uint32_t(b[3]) << 24);
+    }
+    static boost::uint64_t u64(const char* p) { return boost::uint64_t( u32(p) ) | ( boost::uint64_t( u32(p+4) ) << 32 ); }
+    static int i32(const char* p) { return static_cast<boost::int32_t>( u32(p) ); }
+    static double f64(const char* p) {
+        boost::uint64_t bits = u64(p);
+        double x;
+        std::memcpy( &x, &bits, sizeof(x) );
+        return x;
+    }
+    static unsigned int u8(const char* p) { return static_cast<unsigned char>(*p); }
+};
+
+/// \brief a diagram file, read in place.
+///
+/// the records are decoded when they are accessed, so a file that is memory-mapped
+/// (or read into memory) can be queried without building a VoronoiDiagram, e.g. with
+/// face_edges() and find_point_face().
+/// the bytes must stay valid while the view is used.
+class DiagramFileView {
+public:
+    DiagramFileView() : data(0), size(0) {}
+    /// use the size bytes at d. returns false, with a message in error(), if they are not
+    /// a diagram file of a known version, or if a table does not fit in the file.
+    bool open(const char* d, std::size_t n) {
+        data = d;
+        size = n;
+        if ( size < DIAGRAM_FILE_HEADER_SIZE || std::memcmp( data, "OVD-DIAG", 8 ) != 0 )
+            return fail("not an openvoronoi diagram file");
+        if ( version() > DIAGRAM_FILE_VERSION )
+            return fail("the diagram file is of a newer version");
+        if ( LittleEndian::u32(data+12) < DIAGRAM_FILE_HEADER_SIZE )
+            return fail("the header of the diagram file is too short");
+        for (int t=0; t<NUM_DIAGRAM_FILE_TABLES; ++t) {
+            offset[t] = LittleEndian::u64( data + 64 + 16*t );
+            rows[t] = LittleEndian::u32( data + 72 + 16*t );
+            stride[t] = LittleEndian::u32( data + 76 + 16*t );
+            if ( stride[t] < diagram_file_record_size(t) || offset[t] > size || rows[t] > (size - offset[t])/stride[t] )
+                return fail("a table does not fit in the diagram file");
+        }
+        message.clear();
+        return true;
+    }
+    /// check that all rows and faces that the records refer to exist, that the vertex and edge
+    /// indices are below the bounds in the header, and that the enum fields have known values.
+    /// returns false, with a message in error(), if not
+    bool check_references() const {
+        DiagramFileHeader h = header();
+        if ( h.next_vertex_index < 0 || ( h.last_face >= num_faces() && h.last_face != 0 ) )
+            return fail("the header refers to a vertex index or face that does not exist");
+        for (unsigned int n=0; n<num_vertices(); ++n) {
+            FileVertex v = vertex(n);
+            if ( v.index < 0 || v.index >= h.next_vertex_index || !face_exists(v.face) || !face_exists(v.null_face) )
+                return fail("a vertex has an index or face that does not exist");
+            if ( v.type > SPLIT || v.status > NEW )
+                return fail("a vertex has an unknown type or status");
+        }
+        for (unsigned int n=0; n<num_edges(); ++n) {
+            FileEdge e = edge(n);
+            if ( e.source >= num_vertices() || e.target >= num_vertices() || e.next >= num_edges()
+                || e.twin < -1 || e.twin >= (int)num_edges() || e.face >= num_faces() || !face_exists(e.null_face)
+                || e.parameters < -1 || e.parameters >= (int)num_parameters() )
+                return fail("an edge refers to a row that does not exist");
+            if ( e.index >= h.edge_index_bound )
+                return fail("an edge has an index that is not below the edge-index bound");
+            if ( e.type > ARCSITE )
+                return fail("an edge has an unknown type");
+        }
+        for (unsigned int n=0; n<num_faces(); ++n) {
+            FileFace f = face(n);
+            if ( f.edge < -1 || f.edge >= (int)num_edges() )
+                return fail("a face refers to an edge that does not exist");
+            if ( f.site_kind != SITE_POINT && f.site_kind != SITE_LINE && f.site_kind != SITE_ARC && f.site_kind != FACE_NO_SITE )
+                return fail("a face has an unknown kind of site");
+            if ( f.status > NONINCIDENT || ( f.site_kind != FACE_NO_SITE && f.site_face >= num_faces() ) )
+                return fail("a face has an unknown status, or a site on a face that does not exist");
+        }
+        for (unsigned int n=0; n<num_handles(); ++n) {
+            if ( handle(n).vertex >= num_vertices() )
+                return fail("a handle refers to a vertex that does not exist");
+        }
+        return true;
+    }
+    /// the reason why open() or check_references() failed
+    const std::string& error() const { return message; }
+    /// the version of the file
+    unsigned int version() const { return LittleEndian::u32(data+8); }
+    /// the diagram-wide values
+    DiagramFileHeader header() const {
+        DiagramFileHeader h;
+        h.far_radius = LittleEndian::f64(data+16);
+        h.n_bins = LittleEndian::u32(data+24);
+        h.next_vertex_index = LittleEndian::i32(data+28);
+        h.edge_index_bound = LittleEndian::u32(data+32);
+        h.num_psites = LittleEndian::i32(data+36);
+        h.num_lsites = LittleEndian::i32(data+40);
+        h.num_asites = LittleEndian::i32(data+44);
+        h.last_face = LittleEndian::u32(data+48);
+        h.epoch = LittleEndian::u32(data+52);
+        return h;
+    }
+    unsigned int num_vertices() const { return rows[VERTEX_TABLE]; }
+    unsigned int num_edges() const { return rows[EDGE_TABLE]; }
+    unsigned int num_faces() const { return rows[FACE_TABLE]; }
+    unsigned int num_parameters() const { return rows[PARAMETER_TABLE]; }
+    unsigned int num_handles() const { return rows[HANDLE_TABLE]; }
+    /// vertex row n
+    FileVertex vertex(unsigned int n) const {
+        const char* p = record(VERTEX_TABLE, n);
+        FileVertex v;
+        v.position = Point( LittleEndian::f64(p), LittleEndian::f64(p+8) );
+        v.r = LittleEndian::f64(p+16);
+        v.k3 = LittleEndian::f64(p+24);
+        v.alfa = LittleEndian::f64(p+32);
+        v.index = LittleEndian::i32(p+40);
+        v.face = LittleEndian::u32(p+44);
+        v.null_face = LittleEndian::u32(p+48);
+        v.type = LittleEndian::u8(p+52);
+        v.status = LittleEndian::u8(p+53);
+        return v;
+    }
+    /// edge row n
+    FileEdge edge(unsigned int n) const {
+        const char* p = record(EDGE_TABLE, n);
+        FileEdge e;
+        e.source = LittleEndian::u32(p);
+        e.target = LittleEndian::u32(p+4);
+        e.next = LittleEndian::u32(p+8);
+        e.twin = LittleEndian::i32(p+12);
+        e.face = LittleEndian::u32(p+16);
+        e.null_face = LittleEndian::u32(p+20);
+        e.index = LittleEndian::u32(p+24);
+        e.parameters = LittleEndian::i32(p+28);
+        e.k = LittleEndian::f64(p+32);
+        e.type = LittleEndian::u8(p+40);
+        e.flags = LittleEndian::u8(p+41);
+        return e;
+    }
+    /// face row n, which is face number n
+    FileFace face(unsigned int n) const {
+        const char* p = record(FACE_TABLE, n);
+        FileFace f;
+        f.edge = LittleEndian::i32(p);
+        f.status = LittleEndian::u32(p+4);
+        f.site_kind = LittleEndian::u8(p+8);
+        f.cw = LittleEndian::u8(p+9) != 0;
+        f.site_face = LittleEndian::u32(p+12);
+        f.k = LittleEndian::f64(p+16);
+        f.start = Point( LittleEndian::f64(p+24), LittleEndian::f64(p+32) );
+        f.end = Point( LittleEndian::f64(p+40), LittleEndian::f64(p+48) );
+        f.center = Point( LittleEndian::f64(p+56), LittleEndian::f64(p+64) );
+        return f;
+    }
+    /// parameter row n
+    EdgeParameters parameters(unsigned int n) const {
+        const char* p = record(PARAMETER_TABLE, n);
+        EdgeParameters ep;
+        for (int m=0; m<8; ++m) {
+            ep.x[m] = LittleEndian::f64(p+8*m);
+            ep.y[m] = LittleEndian::f64(p+64+8*m);
+        }
+        return ep;
+    }
+    /// handle row n
+    FileHandle handle(unsigned int n) const {
+        const char* p = record(HANDLE_TABLE, n);
+        FileHandle h;
+        h.handle = LittleEndian::i32(p);
+        h.vertex = LittleEndian::u32(p+4);
+        return h;
+    }
+    /// the edge rows of face f, in next-order from the first edge of the face.
+    /// the walk stops after num_edges() steps if the next-rows do not lead back to the first edge.
+    void face_edges(unsigned int f, std::vector<unsigned int>& out) const {
+        out.clear();
+        int first = face(f).edge;
+        if ( first < 0 )
+            return;
+        unsigned int current = first;
+        do {
+            out.push_back(current);
+            current = edge(current).next;
+        } while ( current != (unsigned int)first && out.size() < num_edges() );
+    }
+    /// the face of the point-site closest to p, as VoronoiDiagram finds it when a point-site is
+    /// inserted, or -1 if there are no point-sites. In a diagram of only point-sites this is
+    /// the face that contains p.
+    /// Starting at the last face of the header, the walk goes to neighbor faces whose site is
+    /// closer to p, until there is none. Then the faces around it are searched, as long as their
+    /// site is no further from p than the closest point-site found so far. The segment from p to
+    /// the closest point-site only crosses such faces, so only the faces near p are decoded.
+    /// run check_references() first.
+    int find_point_face(const Point& p) const {
+        if ( num_faces() == 0 )
+            return -1;
+        std::vector<unsigned int> edges;
+        // walk
+        unsigned int f = header().last_face;
+        double dist = ( face(f).site_kind != FACE_NO_SITE ) ? site_distance( face(f), p ) : std::numeric_limits<double>::max();
+        for (bool moved = true; moved; ) {
+            moved = false;
+            face_edges(f, edges);
+            BOOST_FOREACH( unsigned int e, edges ) {
+                int twin = edge(e).twin;
+                if ( twin < 0 )
+                    continue;
+                unsigned int neighbor = edge(twin).face;
+                FileFace nf = face(neighbor);
+                if ( nf.site_kind != FACE_NO_SITE && site_distance(nf, p) < dist ) { // null-faces have no site
+                    dist = site_distance(nf, p);
+                    f = neighbor;
+                    moved = true;
+                    break;
+                }
+            }
+        }
+        // search
+        int closest = -1;
+        double closest_dist = 0;
+        std::set<unsigned int> visited;
+        std::vector<unsigned int> queue(1, f);
+        visited.insert(f);
+        for (unsigned int n=0; n<queue.size(); ++n) {
+            FileFace current = face( queue[n] );
+            if ( current.site_kind == SITE_POINT && ( closest < 0 || site_distance(current, p) < closest_dist ) ) {
+                closest_dist = site_distance(current, p);
+                closest = queue[n];
+            }
+            face_edges(queue[n], edges);
+            BOOST_FOREACH( unsigned int e, edges ) {
+                int twin = edge(e).twin;
+                if ( twin < 0 )
+                    continue;
+                unsigned int neighbor = edge(twin).face;
+                if ( !visited.insert(neighbor).second )
+                    continue;
+                FileFace nf = face(neighbor);
+                if ( nf.site_kind == FACE_NO_SITE || closest < 0 || site_distance(nf, p) <= closest_dist ) // null-faces are passed through
+                    queue.push_back(neighbor);
+            }
+        }
+        return closest;
+    }
+    /// the distance from p to the site of face f
+    static double site_distance(const FileFace& f, const Point& p) {
+        if ( f.site_kind == SITE_LINE ) {
+            LineSite s( f.start, f.end, f.k );
+            return ( s.apex_point(p) - p ).norm();
+        } else if ( f.site_kind == SITE_ARC ) {
+            ArcSite s( f.start, f.end, f.center, f.cw, f.k );
+            return ( s.apex_point(p) - p ).norm();
+        }
+        return ( f.start - p ).norm();
+    }
+private:
+    // face 0 also stands for "no face" (HEGraph::HFace()), e.g. in the null-face of a vertex
+    bool face_exists(unsigned int f) const { return f < num_faces() || f == 0; }
+    const char* record(int table, unsigned int n) const { return data + offset[table] + std::size_t(n)*stride[table]; }
+    bool fail(const std::string& msg) const {
+        message = msg;
+        return false;
+    }
+    const char* data;
+    std::size_t size;
+    boost::uint64_t offset[NUM_DIAGRAM_FILE_TABLES];
+    unsigned int rows[NUM_DIAGRAM_FILE_TABLES];
+    unsigned int stride[NUM_DIAGRAM_FILE_TABLES];
+    mutable std::string message;
+};
+
+/// \brief collects the records of a diagram, and writes them as a diagram file.
+class DiagramFileWriter {
+public:
+    DiagramFileHeader header;
+    std::vector<FileVertex> vertices;
+    std::vector<FileEdge> edges;
+    std::vector<FileFace> faces;
+    std::vector<EdgeParameters> parameters;
+    std::vector<FileHandle> handles;
+
+    /// write the file to out. returns false if writing failed
+    bool write(std::ostream& out) const {
+        const unsigned int rows[NUM_DIAGRAM_FILE_TABLES] = { (unsigned int)vertices.size(), (unsigned int)edges.size(),
+            (unsigned int)faces.size(), (unsigned int)parameters.size(), (unsigned int)handles.size() };
+        boost::uint64_t offset[NUM_DIAGRAM_FILE_TABLES+1];
+        offset[0] = DIAGRAM_FILE_HEADER_SIZE;
+        for (int t=0; t<NUM_DIAGRAM_FILE_TABLES; ++t)
+            offset[t+1] = offset[t] + boost::uint64_t(rows[t])*diagram_file_record_size(t);
+        char h[DIAGRAM_FILE_HEADER_SIZE];
+        std::memset( h, 0, sizeof(h) );
+        std::memcpy( h, "OVD-DIAG", 8 );
+        LittleEndian::store_u32( h+8, DIAGRAM_FILE_VERSION );
+        LittleEndian::store_u32( h+12, DIAGRAM_FILE_HEADER_SIZE );
+        LittleEndian::store_f64( h+16, header.far_radius );
+        LittleEndian::store_u32( h+24, header.n_bins );
+        LittleEndian::store_i32( h+28, header.next_vertex_index );
+        LittleEndian::store_u32( h+32, header.edge_index_bound );
+        LittleEndian::store_i32( h+36, header.num_psites );
+        LittleEndian::store_i32( h+40, header.num_lsites );
+        LittleEndian::store_i32( h+44, header.num_asites );
+        LittleEndian::store_u32( h+48, header.last_face );
+        LittleEndian::store_u32( h+52, header.epoch );
+        for (int t=0; t<NUM_DIAGRAM_FILE_TABLES; ++t) {
+            LittleEndian::store_u64( h+64+16*t, offset[t] );
+            LittleEndian::store_u32( h+72+16*t, rows[t] );
+            LittleEndian::store_u32( h+76+16*t, diagram_file_record_size(t) );
+        }
+        out.write( h, sizeof(h) );
+        write_table( out, vertices );
+        write_table( out, edges );
+        write_table( out, faces );
+        write_table( out, parameters );
+        write_table( out, handles );
+        return out.good();
+    }
+    /// the vertex record of v at p
+    static void encode(const FileVertex& v, char* p) {
+        LittleEndian::store_f64( p, v.position.x );
+        LittleEndian::store_f64( p+8, v.position.y );
+        LittleEndian::store_f64( p+16, v.r );
+        LittleEndian::store_f64( p+24, v.k3 );
+        LittleEndian::store_f64( p+32, v.alfa );
+        LittleEndian::store_i32( p+40, v.index );
+        LittleEndian::store_u32( p+44, v.face );
+        LittleEndian::store_u32( p+48, v.null_face );
+        LittleEndian::store_u8( p+52, v.type );
+        LittleEndian::store_u8( p+53, v.status );
+    }
+    /// the edge record of e at p
+    static void encode(const FileEdge& e, char* p) {
+        LittleEndian::store_u32( p, e.source );
+        LittleEndian::store_u32( p+4, e.target );
+        LittleEndian::store_u32( p+8, e.next );
+        LittleEndian::store_i32( p+12, e.twin );
+        LittleEndian::store_u32( p+16, e.face );
+        LittleEndian::store_u32( p+20, e.null_face );
+        LittleEndian::store_u32( p+24, e.index );
+        LittleEndian::store_i32( p+28, e.parameters );
+        LittleEndian::store_f64( p+32, e.k );
+        LittleEndian::store_u8( p+40, e.type );
+        LittleEndian::store_u8( p+41, e.flags );
+    }
+    /// the face record of f at p
+    static void encode(const FileFace& f, char* p) {
+        LittleEndian::store_i32( p, f.edge );
+        LittleEndian::store_u32( p+4, f.status );
+        LittleEndian::store_u8( p+8, f.site_kind );
+        LittleEndian::store_u8( p+9, f.cw ? 1 : 0 );
+        LittleEndian::store_u32( p+12, f.site_face );
+        LittleEndian::store_f64( p+16, f.k );
+        LittleEndian::store_f64( p+24, f.start.x );
+        LittleEndian::store_f64( p+32, f.start.y );
+        LittleEndian::store_f64( p+40, f.end.x );
+        LittleEndian::store_f64( p+48, f.end.y );
+        LittleEndian::store_f64( p+56, f.center.x );
+        LittleEndian::store_f64( p+64, f.center.y );
+    }
+    /// the parameter record of ep at p
+    static void encode(const EdgeParameters& ep, char* p) {
+        for (int m=0; m<8; ++m) {
+            LittleEndian::store_f64( p+8*m, ep.x[m] );
+            LittleEndian::store_f64( p+64+8*m, ep.y[m] );
+        }
+    }
+    /// the handle record of h at p
+    static void encode(const FileHandle& h, char* p) {
+        LittleEndian::store_i32( p, h.handle );
+        LittleEndian::store_u32( p+4, h.vertex );
+    }
+private:
+    // write the records, encoded into a buffer of about 1MB at a time
+    template <class Record>
+    static void write_table(std::ostream& out, const std::vector<Record>& records) {
+        if ( records.empty() )
+            return;
+        const std::size_t size = diagram_file_record_size( table(records[0]) );
+        const std::size_t n_buf = ( (1<<20) + size - 1 ) / size;
+        std::vector<char> buf( std::min( n_buf, records.size() )*size, 0 ); // the reserved bytes stay zero
+        for (std::size_t n=0; n<records.size(); n+=n_buf) {
+            std::size_t m = std::min( n_buf, records.size()-n );
+            for (std::size_t k=0; k<m; ++k)
+                encode( records[n+k], &buf[k*size] );
+            out.write( &buf[0], m*size );
+        }
+    }
+    static int table(const FileVertex&) { return VERTEX_TABLE; }
+    static int table(const FileEdge&) { return EDGE_TABLE; }
+    static int table(const FileFace&) { return FACE_TABLE; }
+    static int table(const EdgeParameters&) { return PARAMETER_TABLE; }
+    static int table(const FileHandle&) { return HANDLE_TABLE; }
+};
+
+} // end namespace
+#endif
+// end file diagram_file.hpp
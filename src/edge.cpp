@@ -24,11 +24,23 @@ using namespace ovd::numeric;
 
 namespace ovd {
 
+const EdgeParameters EdgeProps::zero_parameters;
+
 EdgeProps::EdgeProps() {
-    x[0]=0;x[1]=0;x[2]=0;x[3]=0;x[4]=0;x[5]=0;x[6]=0;x[7]=0;
-    y[0]=0;y[1]=0;y[2]=0;y[3]=0;y[4]=0;y[5]=0;y[6]=0;y[7]=0;
+    null_face = 0;
     has_null_face = false;
+    index = 0;
+    k = 0;
     valid=true;
+    inserted_direction = false;
+}
+
+// return parameters that can be modified without changing the twin edge.
+// a new EdgeParameters is allocated if the current one is shared.
+EdgeParameters& EdgeProps::writable_parameters() {
+    if ( !params || params->refcount > 1 )
+        params = new EdgeParameters();
+    return *params;
 }
 
 /*
@@ -45,7 +57,7 @@ Point EdgeProps::point(double t, Solution& ) const {
     return point(t);
 }*/
 
-double EdgeProps::error(Solution& sl) const {
+double EdgeProps::error(const Solution& sl) const {
     Point p;
     if (type==PARA_LINELINE) {
         p = projection_point( sl );
@@ -57,8 +69,10 @@ double EdgeProps::error(Solution& sl) const {
 
 // the edge is not parametrized by t-value as normal edges
 // so we need a projection of sl onto the edge instead
-Point EdgeProps::projection_point(Solution& sl) const {
+Point EdgeProps::projection_point(const Solution& sl) const {
     assert( type == PARA_LINELINE );
+    const boost::array<double,8>& x = parameters().x;
+    const boost::array<double,8>& y = parameters().y;
     // edge given by
     // x = x[0] + x[1]*t
     // y = y[0] + y[1]*t
@@ -79,11 +93,13 @@ Point EdgeProps::projection_point(Solution& sl) const {
 }
 
 Point EdgeProps::point(double t) const {
+    const boost::array<double,8>& x = parameters().x;
+    const boost::array<double,8>& y = parameters().y;
     double discr1 =  chop( sq(x[4]+x[5]*t) - sq(x[6]+x[7]*t), 1e-14 );
     double discr2 =  chop( sq(y[4]+y[5]*t) - sq(y[6]+y[7]*t), 1e-14 );
     if ( (discr1 >= 0) && (discr2 >= 0) ) {
-        double psig = sign ? +1 : -1;
-        double nsig = sign ? -1 : +1;
+        double psig = parameters().sign ? +1 : -1;
+        double nsig = parameters().sign ? -1 : +1;
         double xc = x[0] - x[1] - x[2]*t + psig * x[3] * sqrt( discr1 );
         double yc = y[0] - y[1] - y[2]*t + nsig * y[3] * sqrt( discr2 );
         if (xc!=xc) { // test for NaN!
@@ -102,75 +118,53 @@ Point EdgeProps::point(double t) const {
 }
 
 void EdgeProps::set_parameters(Site* s1, Site* s2, bool sig) {
-    sign = sig;
+    writable_parameters().sign = sig;
     if (s1->isPoint() && s2->isPoint())        // PP
         set_pp_parameters(s1,s2);
     else if (s1->isPoint() && s2->isLine())    // PL
         set_pl_parameters(s1,s2);
     else if (s2->isPoint() && s1->isLine())  {  // LP
         set_pl_parameters(s2,s1);
-        sign = !sign;
+        params->sign = !params->sign;
     } else if (s1->isLine() && s2->isLine())     // LL
         set_ll_parameters(s2,s1);
-    else
-        assert(0);
-        // AP & PA
-        // AA
-        // AL & LA
+    else if (s1->isArc() && s2->isLine())     // AL
+        set_la_parameters(s1,s2);
+    else if (s1->isLine() && s2->isArc())     // LA
+        set_la_parameters(s2,s1);
+    else                                        // AP & PA & AA
+        set_aa_parameters(s1,s2);
 }
 
 void EdgeProps::copy_parameters(EdgeProps& other) {
-    sign = other.sign;
-    x[0] = other.x[0];
-    x[1] = other.x[1];
-    x[2] = other.x[2];
-    x[3] = other.x[3];
-    x[4] = other.x[4];
-    x[5] = other.x[5];
-    x[6] = other.x[6];        
-    x[7] = other.x[7];
-    y[0] = other.y[0];
-    y[1] = other.y[1];
-    y[2] = other.y[2];
-    y[3] = other.y[3];
-    y[4] = other.y[4];
-    y[5] = other.y[5];
-    y[6] = other.y[6];        
-    y[7] = other.y[7];
+    params = other.params;
 }   
 
+// use the parameters of the twin edge (other), instead of setting our own.
+// twin edges trace the same curve, so this gives point(t) equal to other.point(t).
+// only the parameters are shared, the caller sets the type of this edge.
+void EdgeProps::share_parameters(const EdgeProps& other) {
+    params = other.params;
+}
+
 EdgeProps& EdgeProps::operator=(const EdgeProps &other) {
     if (this == &other)
         return *this;
-    sign = other.sign;
-    x[0] = other.x[0];
-    x[1] = other.x[1];
-    x[2] = other.x[2];
-    x[3] = other.x[3];
-    x[4] = other.x[4];
-    x[5] = other.x[5];
-    x[6] = other.x[6];        
-    x[7] = other.x[7];
-    y[0] = other.y[0];
-    y[1] = other.y[1];
-    y[2] = other.y[2];
-    y[3] = other.y[3];
-    y[4] = other.y[4];
-    y[5] = other.y[5];
-    y[6] = other.y[6];        
-    y[7] = other.y[7];
+    params = other.params; // shared, not copied
     face = other.face; 
     null_face = other.null_face;
     has_null_face = other.has_null_face;
     k=other.k; 
     type = other.type;
     valid = other.valid;
-    // NOTE we do *not* set: twin, next    
+    // NOTE we do *not* set: twin, next, index
     return *this;
 }
 
 // called for point(s1)-point(s2) edges
 void EdgeProps::set_pp_parameters(Site* s1, Site* s2) {
+    boost::array<double,8>& x = writable_parameters().x;
+    boost::array<double,8>& y = writable_parameters().y;
     //std::cout << "set_pp_parameters()\n";
     // x = x1 - x2 - x3*t +/- x4 * sqrt( square(x5+x6*t) - square(x7+x8*t) )
     assert( s1->isPoint() && s2->isPoint() );
@@ -200,6 +194,8 @@ void EdgeProps::set_pp_parameters(Site* s1, Site* s2) {
 
 // called for point(s1)-line(s2) edges
 void EdgeProps::set_pl_parameters(Site* s1, Site* s2) {
+    boost::array<double,8>& x = writable_parameters().x;
+    boost::array<double,8>& y = writable_parameters().y;
     assert( s1->isPoint() && s2->isLine() );
     
     type = PARABOLA;
@@ -209,7 +205,7 @@ void EdgeProps::set_pl_parameters(Site* s1, Site* s2) {
     if (alfa3>0.0) {
         kk = -1.0;
     } else {
-        sign = !sign;
+        params->sign = !params->sign;
     }
     
     x[0]=s1->x();       // xc1
@@ -233,6 +229,8 @@ void EdgeProps::set_pl_parameters(Site* s1, Site* s2) {
 
 // set separator edge-parameters
 void EdgeProps::set_sep_parameters(Point& endp, Point& p) {
+    boost::array<double,8>& x = writable_parameters().x;
+    boost::array<double,8>& y = writable_parameters().y;
     type = SEPARATOR;
     double dx = p.x - endp.x;
     double dy = p.y - endp.y;
@@ -248,6 +246,8 @@ void EdgeProps::set_sep_parameters(Point& endp, Point& p) {
 }
 
 void EdgeProps::set_ll_para_parameters(Site* s1, Site* s2) {
+    boost::array<double,8>& x = writable_parameters().x;
+    boost::array<double,8>& y = writable_parameters().y;
     assert( s1->isLine() && s2->isLine() );
     type = PARA_LINELINE;
     // a1*b2 - b1*a2 = 0
@@ -316,6 +316,8 @@ void EdgeProps::set_ll_para_parameters(Site* s1, Site* s2) {
 
 // line(s1)-line(s2) edge
 void EdgeProps::set_ll_parameters(Site* s1, Site* s2) {  // Held thesis p96
+    boost::array<double,8>& x = writable_parameters().x;
+    boost::array<double,8>& y = writable_parameters().y;
     assert( s1->isLine() && s2->isLine() );
     type = LINELINE;
     double delta =  s1->a()*s2->b() - s1->b()*s2->a() ;
@@ -340,59 +342,83 @@ void EdgeProps::set_ll_parameters(Site* s1, Site* s2) {  // Held thesis p96
     y[1]=0;y[3]=0;y[4]=0;y[5]=0;y[6]=0;y[7]=0;
 }
 
-// point(s1)-arc(s2)
-/*
-void EdgeProps::set_pa_parameters(Site* s1, Site* s2) { 
-    d = sqrt( (xc1 - xc2)^2 + (yc1-yc2)^2 )
-    double alfa1 = (xc2-xc1) / d
-    double alfa2 = (yc2-yc1) / d
-    double alfa3 = ( r2^2 - r1^2 - d^2) / 2d
-    double alfa4 = ( lamb2 * r2 - lamb1 * r1 ) / d
-    x[0] = xc1
-    x[1] = alfa1*alfa3
-    x[2] = alfa1*alfa4
-    x[3] = alfa2
-    x[4] = r1
-    x[5] = lamb1
-    x[6] = alfa3
-    x[7] = alfa4
+// circle(s1)-circle(s2) edge, for the AP, PA and AA bisectors.
+// a point-site is a circle of zero radius, that grows with t (lamb=+1)
+// an arc-site is a circle of radius r, that grows (lamb=k=+1) or shrinks (lamb=k=-1) with t
+//
+// the bisector is at the distance a(t) = -(alfa3 + alfa4*t) from c1 towards c2,
+// and sqrt( (r1+lamb1*t)^2 - a(t)^2 ) to the left (sign==true) or right of c1->c2
+// this is an ellipse when lamb1 != lamb2 and a hyperbola otherwise.
+// with r1=r2=0, this is the same as set_pp_parameters()
+void EdgeProps::set_aa_parameters(Site* s1, Site* s2) { 
+    boost::array<double,8>& x = writable_parameters().x;
+    boost::array<double,8>& y = writable_parameters().y;
+    assert( !s1->isLine() && !s2->isLine() );
+    double r1 = s1->r();
+    double r2 = s2->r();
+    double lamb1 = s1->isPoint() ? +1 : s1->k();
+    double lamb2 = s2->isPoint() ? +1 : s2->k();
+    double d = sqrt( sq(s2->x()-s1->x()) + sq(s2->y()-s1->y()) );
+    assert( d > 0 ); // concentric arcs are not supported
+    double alfa1 = (s2->x() - s1->x()) / d;
+    double alfa2 = (s2->y() - s1->y()) / d;
+    double alfa3 = ( r2*r2 - r1*r1 - d*d ) / (2*d);
+    double alfa4 = ( lamb2*r2 - lamb1*r1 ) / d;
     
-    y[0] = yc1
-    y[1] = alfa2*alfa3
-    y[2] = alfa2*alfa4
-    y[3] = alfa1
-    y[4] = r1
-    y[5] = lamb1
-    y[6] = alfa3
-    y[7] = alfa4
+    if (lamb1 != lamb2)
+        type = ELLIPSE;
+    else if (alfa4 == 0)
+        type = LINE;
+    else
+        type = HYPERBOLA;
+    x[0]=s1->x();
+    x[1]=alfa1*alfa3;
+    x[2]=alfa1*alfa4;
+    x[3]=-alfa2;
+    x[4]=r1;
+    x[5]=lamb1;
+    x[6]=alfa3;
+    x[7]=alfa4;
+    
+    y[0]=s1->y();
+    y[1]=alfa2*alfa3;
+    y[2]=alfa2*alfa4;
+    y[3]=-alfa1;
+    y[4]=r1;
+    y[5]=lamb1;
+    y[6]=alfa3;
+    y[7]=alfa4;
 }
 
-// arc(s1)-line(s2)
+// arc(s1)-line(s2) edge
+// the line-site face is on the side where a*x+b*y+c < 0, at distance t: a*x+b*y+c+t=0
+// the bisector is at the distance -(alfa3+t) from the center along (a,b), 
+// and sqrt( (r1+lamb1*t)^2 - (alfa3+t)^2 ) to the left (sign==true) or right of (a,b)
 void EdgeProps::set_la_parameters(Site* s1, Site* s2) { 
-    d = sqrt( (xc1 - xc2)^2 + (yc1-yc2)^2 )
-    double alfa1 = a2
-    double alfa2 = b2
-    double alfa3 = ( a2*xc1 + b2*yc1 + c2 )
-    double alfa4 = r1
-    x[0]= xc1
-    x[1] = alfa1*alfa3
-    x[2] = -alfa1
-    x[3] = alfa2
-    x[4] = alfa4
-    x[5] = lamb1
-    x[6] = alfa3
-    x[7] = -1
+    boost::array<double,8>& x = writable_parameters().x;
+    boost::array<double,8>& y = writable_parameters().y;
+    assert( s1->isArc() && s2->isLine() );
+    type = PARABOLA;
+    double alfa3 = s2->a()*s1->x() + s2->b()*s1->y() + s2->c(); // signed distance from line to center
+    double lamb1 = s1->k();
+    x[0]=s1->x();
+    x[1]=s2->a()*alfa3;
+    x[2]=s2->a();
+    x[3]=-s2->b();
+    x[4]=s1->r();
+    x[5]=lamb1;
+    x[6]=alfa3;
+    x[7]=+1;
     
-    y[0] = yc1
-    y[1] = alfa2*alfa3
-    y[2] = -alfa2
-    y[3] = alfa1
-    y[4] = alfa4
-    y[5] = lamb1
-    y[6] = alfa3
-    y[7] = -1
+    y[0]=s1->y();
+    y[1]=s2->b()*alfa3;
+    y[2]=s2->b();
+    y[3]=-s2->a();
+    y[4]=s1->r();
+    y[5]=lamb1;
+    y[6]=alfa3;
+    y[7]=+1;
 }
-*/
 
 double EdgeProps::minimum_t( Site* s1, Site* s2) {
     if (s1->isPoint() && s2->isPoint())        // PP
@@ -403,10 +429,8 @@ double EdgeProps::minimum_t( Site* s1, Site* s2) {
         return minimum_pl_t(s2,s1);
     else if (s1->isLine() && s2->isLine())     // LL
         return 0;
-    else
-        assert(0);
-    // todo:  AP, AL, AA
-    return -1;
+    else                                        // AP, PA, AL, LA, AA
+        return minimum_arc_t(s1,s2);
 }
 
 double EdgeProps::minimum_pp_t(Site* s1, Site* s2) {
@@ -417,13 +441,44 @@ double EdgeProps::minimum_pp_t(Site* s1, Site* s2) {
 }
 
 double EdgeProps::minimum_pl_t(Site* , Site* ) {
+    const boost::array<double,8>& x = parameters().x;
     double mint = - x[6]/(2.0*x[7]);
     assert( mint >=0 );
     return mint;
 }
 
 
+// the apex of an edge with an arc-site is where the sqrt() in point() is zero:
+// (x4+x5*t) = +/- (x6+x7*t)
+// there are up to two such points. An ellipse has one apex on each side of the arc-center, 
+// and with arcs of less than 180 degrees only one of them is in the region of the arc.
+double EdgeProps::minimum_arc_t(Site* s1, Site* s2) {
+    const boost::array<double,8>& x = parameters().x;
+    double roots[2];
+    int n_roots = 0;
+    if ( x[5] != x[7] )
+        roots[n_roots++] = (x[6]-x[4]) / (x[5]-x[7]);
+    if ( x[5] != -x[7] )
+        roots[n_roots++] = -(x[6]+x[4]) / (x[5]+x[7]);
+    double mint = -1;
+    bool in_region = false;
+    for (int n=0; n<n_roots; n++) {
+        if ( roots[n] < 0 )
+            continue;
+        Point p = point( roots[n] );
+        bool r = s1->in_region(p) && s2->in_region(p);
+        if ( (mint < 0) || (r && !in_region) || ( (r == in_region) && (roots[n] < mint) ) ) {
+            mint = roots[n];
+            in_region = r;
+        }
+    }
+    assert( mint >= 0 );
+    return mint;
+}
+
 void EdgeProps::print_params() const {
+    const boost::array<double,8>& x = parameters().x;
+    const boost::array<double,8>& y = parameters().y;
     std::cout << "x-params: ";
     for (int m=0;m<8;m++)
         std::cout << x[m] << " ";
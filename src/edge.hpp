@@ -22,10 +22,12 @@
 #include <cassert>
 #include <cmath>
 #include <boost/array.hpp>
+#include <boost/intrusive_ptr.hpp>
 
 #include <boost/graph/adjacency_list.hpp>
 
 #include "common/point.hpp"
+#include "common/halfedgediagram.hpp"
 #include "site.hpp"
 #include "solvers/solution.hpp"
 
@@ -36,29 +38,59 @@ namespace ovd {
 
 
 // note: cannot use vecS since remove_vertex invalidates iterators/edge_descriptors (?)
+// hedi::flatS stores the graph in contiguous arrays instead, see common/flat_graph.hpp
+// build with -DOVD_FLAT_GRAPH (cmake option OVD_FLAT_GRAPH) to use it.
+#ifdef OVD_FLAT_GRAPH
+#define VERTEX_CONTAINER hedi::flatS
+#else
 #define VERTEX_CONTAINER boost::listS
+#endif
 #define EDGE_LIST_CONTAINER boost::listS
 
 // type of edge-descriptors in the graph
-typedef boost::adjacency_list_traits<OUT_EDGE_CONTAINER, 
-                                     VERTEX_CONTAINER, 
-                                     boost::bidirectionalS, 
-                                     EDGE_LIST_CONTAINER >::edge_descriptor HEEdge;
+typedef hedi::half_edge_diagram_traits<OUT_EDGE_CONTAINER, 
+                                       VERTEX_CONTAINER, 
+                                       boost::bidirectionalS, 
+                                       EDGE_LIST_CONTAINER >::edge_descriptor HEEdge;
                                      
 typedef unsigned int HEFace;
 
-enum VoronoiEdgeType {LINE, LINELINE, PARA_LINELINE, OUTEDGE, PARABOLA, ELLIPSE, HYPERBOLA, SEPARATOR, NULLEDGE, LINESITE};
+enum VoronoiEdgeType {LINE, LINELINE, PARA_LINELINE, OUTEDGE, PARABOLA, ELLIPSE, HYPERBOLA, SEPARATOR, NULLEDGE, LINESITE, ARCSITE};
 
 
+/// bisector parameters of a voronoi edge.
+/// the two half-edges of an edge share one EdgeParameters, see EdgeProps::share_parameters()
+struct EdgeParameters {
+    EdgeParameters() : sign(false), refcount(0) {
+        x.assign(0);
+        y.assign(0);
+    }
+    boost::array<double,8> x;
+    boost::array<double,8> y;
+    /// choose either +/- in front of sqrt(). this belongs to the curve, not to the
+    /// half-edge: twins that share the parameters trace the same points.
+    bool sign;
+    /// number of EdgeProps that point to this
+    unsigned int refcount;
+};
+
+inline void intrusive_ptr_add_ref(EdgeParameters* p) { ++p->refcount; }
+inline void intrusive_ptr_release(EdgeParameters* p) {
+    if (--p->refcount == 0)
+        delete p;
+}
+
 /// properties of an edge in the voronoi diagram
 /// each edge stores a pointer to the next HEEdge 
 /// and the HEFace to which this HEEdge belongs
 class EdgeProps {
 public:
     EdgeProps();
-    EdgeProps(HEEdge n, HEFace f): next(n), face(f), has_null_face(false), valid(true) {}
+    EdgeProps(HEEdge n, HEFace f): next(n), face(f), null_face(0), has_null_face(false), index(0),
+        k(0), valid(true), inserted_direction(false) {}
     /// create edge with given next, twin, and face
-    EdgeProps(HEEdge n, HEEdge t, HEFace f): next(n), twin(t), face(f), has_null_face(false), valid(true) {}
+    EdgeProps(HEEdge n, HEEdge t, HEFace f): next(n), twin(t), face(f), null_face(0), has_null_face(false), index(0),
+        k(0), valid(true), inserted_direction(false) {}
     /// the next edge, counterclockwise, from this edge
     HEEdge next; 
     /// the twin edge
@@ -67,32 +99,43 @@ public:
     HEFace face; // each face corresponds to an input Site/generator
     HEFace null_face;
     bool has_null_face;
+    /// edge index, unique within a diagram. set by half_edge_diagram when the edge is added,
+    /// and not copied by operator=. FilterView uses it to hold one bit per edge.
+    unsigned int index;
     
     double k; // offset-direction from the adjacent site, either +1 or -1
     VoronoiEdgeType type;
     
-    boost::array<double,8> x;
-    boost::array<double,8> y;
-    bool sign; // choose either +/- in front of sqrt()
+    /// bisector parameters, shared with the twin edge
+    boost::intrusive_ptr<EdgeParameters> params;
     
     Point point(double t) const; 
-    double error(Solution& sl) const;
+    double error(const Solution& sl) const;
     double minimum_t( Site* s1, Site* s2);
     void copy_parameters(EdgeProps& other);   
+    void share_parameters(const EdgeProps& other);
+    /// the bisector parameters of this edge
+    const EdgeParameters& parameters() const { return params ? *params : zero_parameters; }
     void set_parameters(Site* s1, Site* s2, bool sig);
     void set_sep_parameters(Point& endp, Point& p);
     EdgeProps &operator=(const EdgeProps &p);
     bool valid; // for filtering graph
     bool inserted_direction; // true if linesite-edge inserted in this direction
 private:
-    Point projection_point(Solution& sl) const;
+    /// the parameters of an edge that has not been parametrized are all zero
+    static const EdgeParameters zero_parameters;
+    EdgeParameters& writable_parameters();
+    Point projection_point(const Solution& sl) const;
     double minimum_pp_t(Site* s1, Site* s2);
     double minimum_pl_t(Site* s1, Site* s2);
+    double minimum_arc_t(Site* s1, Site* s2);
 
     void set_pp_parameters(Site* s1, Site* s2);
     void set_pl_parameters(Site* s1, Site* s2);
     void set_ll_parameters(Site* s1, Site* s2);
     void set_ll_para_parameters(Site* s1, Site* s2);
+    void set_aa_parameters(Site* s1, Site* s2);
+    void set_la_parameters(Site* s1, Site* s2);
     void print_params() const;
     
 
@@ -102,12 +102,28 @@ HEFace FaceGrid::grid_find_closest_face(const Point& p) {
 }
 
 
+// a cheap starting point for a walk towards p. Only the bucket of p is searched.
+bool FaceGrid::find_bucket_face(const Point& p, HEFace& f) {
+    FacePropVector* bucket = (*grid)[ get_grid_index( p.x ) ][ get_grid_index( p.y ) ];
+    double closest_distance = 30*far_radius; // a big number...
+    bool found = false;
+    BOOST_FOREACH( const FaceProps& fp, *bucket ) {
+        double d = (fp.site->position() - p).norm_sq();
+        if (d<closest_distance ) {
+            closest_distance=d;
+            f=fp.idx;
+            found = true;
+        }
+    }
+    return found;
+}
+
 // go through the HEFace set and return the one closest to p
 HEFace FaceGrid::find_closest_in_set(  const Point& p ) {
     HEFace closest_face(0);
     double closest_distance = 30*far_radius; // a big number...
     double d;
-    BOOST_FOREACH( FaceProps f, face_set ) {
+    BOOST_FOREACH( const FaceProps& f, face_set ) {
         assert( f.site->isPoint() );
         d = (f.site->position() - p).norm_sq();
         if (d<closest_distance ) {
@@ -136,7 +152,7 @@ void FaceGrid::insert_faces_from_neighbors(  GridIndex row, GridIndex col , Grid
     
 void FaceGrid::insert_faces_from_bucket( GridIndex row, GridIndex col ) {
     FacePropVector* bucket = (*grid)[row][col];
-    BOOST_FOREACH( FaceProps f, *bucket ) {
+    BOOST_FOREACH( const FaceProps& f, *bucket ) {
         //face_set.insert(f);
         face_set.push_back(f);
     }
@@ -57,6 +57,11 @@ class FaceGrid {
         HEFace find_closest_face(const Point& p);
         /// find and return the closest face to a given Point p. Faster grid-search algorithm.
         HEFace grid_find_closest_face(const Point& p);
+        /// find the closest face among the faces in the grid-cell of p, without searching neighbor cells.
+        /// returns false if the cell is empty.
+        bool find_bucket_face(const Point& p, HEFace& f);
+        /// the number of bins in the X and Y direction
+        unsigned int num_bins() const { return nbins; }
 
     private:     
         /// convert an x-coordinate into the corresponding grid index
@@ -0,0 +1,99 @@
+/*
+ *  Copyright 2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef FILTER_VIEW_HPP
+#define FILTER_VIEW_HPP
+
+#include <cassert>
+
+#include <boost/dynamic_bitset.hpp>
+#include <boost/foreach.hpp>
+
+#include "graph.hpp"
+
+namespace ovd
+{
+
+/// \brief the result of one or more filters, held as one bit per edge.
+///
+/// PolygonInterior, IslandFilter and MedialAxis set the valid-property of the edges
+/// of the diagram (with HEGraph::filter_graph()), so a diagram holds only one filter
+/// result at a time, and filter_reset() must be called between uses.
+/// Given a FilterView they set bits in the view instead, and leave the diagram unchanged.
+/// Offset, FaceOffset and MedialAxisWalk accept a view in place of the valid-property,
+/// so one diagram can serve several views at once, also from several threads,
+/// as long as no sites are inserted while the views are in use.
+///
+/// the bits are indexed by EdgeProps::index, so a view holds HEGraph::edge_index_bound() bits.
+/// VoronoiDiagram compacts the edge indices after an insertion when more than half are unused,
+/// which keeps this below two bits per edge. A view can not be used after a site is inserted,
+/// until reset() is called (see up_to_date(), this is asserted). A new view has all edges valid.
+class FilterView {
+public:
+    /// a view of g where all edges are valid
+    explicit FilterView(HEGraph& gi): g(&gi), bits( gi.edge_index_bound() ), generation( gi.generation() ) {
+        bits.set();
+    }
+    /// mark edges invalid where the filter returns false, as HEGraph::filter_graph() does
+    template <class Filter>
+    void filter(Filter f) {
+        BOOST_FOREACH( HEEdge e, boost::edges(g->g) ) {
+            if ( !f(e) )
+                set_invalid(e);
+        }
+    }
+    /// true if e passed all filters
+    bool valid(HEEdge e) const {
+        assert( up_to_date() ); // the diagram changed after the view was created or reset
+        assert( (*g)[e].index < bits.size() );
+        return bits[ (*g)[e].index ];
+    }
+    /// mark e invalid
+    void set_invalid(HEEdge e) {
+        assert( up_to_date() );
+        assert( (*g)[e].index < bits.size() );
+        bits.reset( (*g)[e].index );
+    }
+    /// make all edges valid again
+    void reset() {
+        bits.resize( g->edge_index_bound() );
+        bits.set();
+        generation = g->generation();
+    }
+    /// false if a site was inserted after the view was created or reset
+    bool up_to_date() const { return generation == g->generation(); }
+    /// the number of valid edges
+    unsigned int num_valid() const {
+        unsigned int n = 0;
+        BOOST_FOREACH( HEEdge e, boost::edges(g->g) ) {
+            if ( valid(e) )
+                n++;
+        }
+        return n;
+    }
+private:
+    HEGraph* g;
+    boost::dynamic_bitset<> bits;
+    // HEGraph::generation() when the view was created or reset. inserting a site adds edges,
+    // and may renumber all edges, so the bits are then no longer those of the edges.
+    unsigned long generation;
+};
+
+} // end namespace
+#endif
+// end file filter_view.hpp
@@ -36,19 +36,8 @@ namespace ovd {
 // vecS is slightly faster than listS
 // vecS   5.72us * n log(n)
 // listS  6.18 * n log(n)
-#define OUT_EDGE_CONTAINER boost::listS 
-//#define OUT_EDGE_CONTAINER boost::vecS 
+// OUT_EDGE_CONTAINER, VERTEX_CONTAINER, EDGE_LIST_CONTAINER, and HEEdge are defined in edge.hpp
 
-// note: cannot use vecS since remove_vertex invalidates iterators/edge_descriptors (?)
-#define VERTEX_CONTAINER boost::listS
-#define EDGE_LIST_CONTAINER boost::listS
-
-// type of edge-descriptors in the graph
-typedef boost::adjacency_list_traits<OUT_EDGE_CONTAINER, 
-                                     VERTEX_CONTAINER, 
-                                     boost::bidirectionalS, 
-                                     EDGE_LIST_CONTAINER >::edge_descriptor HEEdge;
-                                     
 // type of face-descriptors in the graph 
 // (if there were a traits-class for HEDIGraph we could use it here, instead of "hard coding" the type)
 typedef unsigned int HEFace;    
@@ -89,8 +78,7 @@ typedef hedi::half_edge_diagram< OUT_EDGE_CONTAINER,     // out-edges storage
                        boost::no_property,       // graph properties
                        EDGE_LIST_CONTAINER       // edge storage
                        > HEGraph;
-// NOTE: if these listS etc. arguments ever change, they must also be updated
-// above where we do: adjacency_list_traits
+// NOTE: HEEdge in edge.hpp is defined with the same storage arguments
 
 typedef boost::graph_traits< HEGraph::BGLGraph >::vertex_descriptor  HEVertex;
 typedef boost::graph_traits< HEGraph::BGLGraph >::vertex_iterator    HEVertexItr;
@@ -22,10 +22,9 @@
 #include <string>
 #include <iostream>
 
-#include <boost/python.hpp>
-
 #include "graph.hpp"
 #include "site.hpp"
+#include "filter_view.hpp"
 
 namespace ovd
 {
@@ -56,6 +55,11 @@ public:
         island_filter flt(g);
         g.filter_graph(flt);
     }
+    /// filter into the view, and leave the valid-property of g unchanged
+    IslandFilter(HEGraph& gi, FilterView& view): g(gi) {
+        island_filter flt(g);
+        view.filter(flt);
+    }
 private:
     IslandFilter(); // don't use.
     HEGraph& g; // original graph
@@ -21,11 +21,16 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
+#include <queue>
+#include <functional>
 
-#include <boost/python.hpp>
+#include <boost/foreach.hpp>
 
 #include "graph.hpp"
 #include "site.hpp"
+#include "filter_view.hpp"
+#include "common/numeric.hpp"
 
 namespace ovd
 {
@@ -36,8 +41,8 @@ namespace ovd
 struct medial_filter {
     medial_filter(HEGraph& gi, double thr=0.8) : g(gi) , _dot_product_threshold(thr) { }
     bool operator()(const HEEdge& e) const {
-        if (g[e].type == LINESITE || g[e].type == NULLEDGE) 
-            return true; // we keep linesites and nulledges
+        if (g[e].type == LINESITE || g[e].type == ARCSITE || g[e].type == NULLEDGE) 
+            return true; // we keep linesites, arcsites and nulledges
         if (g[e].type == SEPARATOR)
             return false; // separators are allways removed
             
@@ -72,7 +77,7 @@ struct medial_filter {
     
     // calculate the dot-product between unit vectors aligned along edges e1->e2
     // since e1 and e2 are both line-sites the direction is easy to find
-    // FIXME: more code needed here for tangent calculation if we have arc-sites
+    // FIXME: for arc-sites this uses the chord, not the tangent
     double edge_dotprod(HEEdge e1, HEEdge e2) const {
         HEVertex src1 = g.source(e1);
         HEVertex trg1 = g.target(e1);
@@ -90,10 +95,10 @@ struct medial_filter {
         return dir1.dot(dir2);
     }
     
-    // find the linesite edge that connects to v.
+    // find the linesite or arcsite edge that connects to v.
     HEEdge find_segment(HEVertex v) const {
         BOOST_FOREACH(HEEdge e, g.out_edges(v)) {
-            if ( g[e].type == LINESITE )
+            if ( g[e].type == LINESITE || g[e].type == ARCSITE )
                 return e;
         }
         assert(0);
@@ -133,6 +138,11 @@ public:
         medial_filter flt(g);
         g.filter_graph(flt);
     }
+    /// filter into the view, and leave the valid-property of g unchanged
+    MedialAxis(HEGraph& gi, FilterView& view): g(gi) {
+        medial_filter flt(g);
+        view.filter(flt);
+    }
 private:
     MedialAxis(); // don't use.
     HEGraph& g; // original graph
@@ -144,13 +154,54 @@ private:
 // -- if there's only one choice for the next edge, go there
 // -- if there are two choices, take one of the choices
 // when done, find another valid start-edge
+// the walked edges are marked in a copy of the valid-flags, so the diagram (or the FilterView) is not modified.
 // FIXME: this could probably be optimized to minimize rapid-traverses
+//
+// walk() returns plain C++ vectors. The python wrapper (py/medial_axis_walk_py.hpp) converts them to lists.
+
+/// a point on the medial axis, and the radius of its clearance-disk
+struct MedialPoint {
+    MedialPoint(const Point& pi, double c): p(pi), clearance(c) {}
+    Point p;
+    double clearance;
+};
+/// the points along one edge of the medial axis
+typedef std::vector<MedialPoint> MedialPointList;
+/// the edges of a connected path along the medial axis, in walking order
+typedef std::vector<MedialPointList> MedialChain;
+/// all the paths of a walk
+typedef std::vector<MedialChain> MedialChainList;
+
+/// \brief walk along the medial axis and produce paths
 class MedialAxisWalk {
 public:
-    MedialAxisWalk(HEGraph& gi): g(gi) {}
+    /// walk the edges with the valid-property set
+    MedialAxisWalk(HEGraph& gi): g(gi), view(0), remaining(gi) {}
+    /// walk the edges that are valid in the view
+    MedialAxisWalk(HEGraph& gi, const FilterView& v): g(gi), view(&v), remaining(gi) {}
 
-    boost::python::list walk() {
-        out = boost::python::list();
+    /// the paths along the valid edges. All valid edges are walked on every call.
+    MedialChainList walk() {
+        out.clear();
+        if (view) {
+            remaining = *view;
+        } else {
+            remaining.reset();
+            BOOST_FOREACH(HEEdge e, g.edges() ) {
+                if ( !g[e].valid )
+                    remaining.set_invalid(e);
+            }
+        }
+        // queue the edges where a path can start. set_invalid() queues the edges
+        // of the vertices that a path passes, since they may become start-edges.
+        edge_list = g.edges();
+        edge_position.assign( g.edge_index_bound(), 0 );
+        start_queue = StartQueue();
+        for (unsigned int n=0; n<edge_list.size(); ++n) {
+            edge_position[ g[ edge_list[n] ].index ] = n;
+            if ( valid_next_edge( edge_list[n] ) && degree_one_source( edge_list[n] ) )
+                start_queue.push(n);
+        }
         HEEdge start;
         while( find_start_edge(start) ) { // find a suitable start-edge
             medial_axis_walk(start); // from the start-edge, walk as far as possible
@@ -162,7 +213,8 @@ public:
     void medial_axis_walk(HEEdge start) {
         // begin chain with start.
         HEEdge next = start; // why does = HEEdge() cause Wuninitialized ?
-        boost::python::list chain;
+        out.push_back( MedialChain() );
+        MedialChain& chain = out.back();
         append_edge(chain, start);
         set_invalid(start);
         while (next_edge(start, next)  ) {
@@ -171,47 +223,38 @@ public:
             start=next; 
             set_invalid(start);
         }
-        // end chain
-        out.append( chain );
     }
     
-    // add the given edge to the current list of edges.
+    // add the given edge to the current chain.
     // for line-edges we add only two endpoints
     // for parabolic edges we add many points
-    void append_edge(boost::python::list& list, HEEdge edge)  {
-        boost::python::list point_list; // the endpoints of each edge
+    void append_edge(MedialChain& chain, HEEdge edge)  {
+        chain.push_back( MedialPointList() );
+        MedialPointList& point_list = chain.back(); // the points of this edge
         HEVertex v1 = g.source( edge );
         HEVertex v2 = g.target( edge );
         // these edge-types are drawn as a single line from source to target.
         if (   (g[edge].type == LINELINE)  || (g[edge].type == PARA_LINELINE)) {
-            boost::python::list pt1;
-            pt1.append( g[v1].position ); pt1.append( g[v1].dist() );
-            point_list.append(pt1);
-            boost::python::list pt2;
-            pt2.append( g[v2].position ); pt2.append( g[v2].dist() );
-            point_list.append(pt2);
-        } else if ( (g[edge].type == PARABOLA) || (g[edge].type == LINE) ) { // these edge-types are drawn as polylines with edge_points number of points
+            point_list.push_back( MedialPoint( g[v1].position, g[v1].dist() ) );
+            point_list.push_back( MedialPoint( g[v2].position, g[v2].dist() ) );
+        } else if ( (g[edge].type == PARABOLA) || (g[edge].type == ELLIPSE) || (g[edge].type == HYPERBOLA) || (g[edge].type == LINE) ) { // these edge-types are drawn as polylines with edge_points number of points
             double t_src = g[v1].dist();
             double t_trg = g[v2].dist();
             double t_min = std::min(t_src,t_trg);
             double t_max = std::max(t_src,t_trg);
             int _edge_points= 20; // number of points to subdivide parabolas. FIXME: make this adjustable
-            
+            point_list.reserve(_edge_points);
             for (int n=0;n< _edge_points;n++) {
                 double t(0);
                 if (t_src<=t_trg) // increasing t-value
-                    t = t_min + ((t_max-t_min)/sq(_edge_points-1))*sq(n); // NOTE: quadratic t-dependece. More points at smaller t.
+                    t = t_min + ((t_max-t_min)/numeric::sq(_edge_points-1))*numeric::sq(n); // NOTE: quadratic t-dependece. More points at smaller t.
                 else if (t_trg<t_src) { // decreasing t-value
                     int m = _edge_points-1-n; // m goes from (N-1)...0   as n goes from 0...(N-1)
-                    t = t_min + ((t_max-t_min)/sq(_edge_points-1))*sq(m);
+                    t = t_min + ((t_max-t_min)/numeric::sq(_edge_points-1))*numeric::sq(m);
                 }
-                Point p = g[edge].point(t);
-                boost::python::list pt;
-                pt.append( p ); pt.append( t );
-                point_list.append(pt);
+                point_list.push_back( MedialPoint( g[edge].point(t), t ) );
             }
         }
-        list.append( point_list );
     }
     // we are at target(e). find the next suitable edge.
     // return true if a next-edge was found, false otherwise.
@@ -232,13 +275,26 @@ public:
     }
     
     void set_invalid(HEEdge e) {
-        g[e].valid = false;
-        g[ g[e].twin ].valid = false;
+        remaining.set_invalid(e);
+        if ( g[e].twin != HEEdge() ) // the edges of the outer face have no twin
+            remaining.set_invalid( g[e].twin );
+        queue_out_edges( g.source(e) );
+        queue_out_edges( g.target(e) );
+    }
+    // the out-edges of v may have become start-edges
+    void queue_out_edges(HEVertex v) {
+        BOOST_FOREACH( HEEdge oe, g.out_edges(v) ) {
+            if ( valid_next_edge(oe) )
+                start_queue.push( edge_position[ g[oe].index ] );
+        }
     }
-    // loop through all edges and find an edge where we can start
+    // find the first edge, in the order of g.edges(), where we can start.
     // valid edges have a source-vertex with exactly one valid out-edge.
+    // the queue holds all such edges, and edges that no longer qualify.
     bool find_start_edge(HEEdge& start) {
-        BOOST_FOREACH(HEEdge e, g.edges() ) { 
+        while ( !start_queue.empty() ) {
+            HEEdge e = edge_list[ start_queue.top() ];
+            start_queue.pop();
             if ( valid_next_edge(e) ) {
                 if (degree_one_source(e)) {
                     start = e;
@@ -248,9 +304,9 @@ public:
         }
         return false;
     }
-    // we can follow an edge if it is valid, and not a LINESITE or NULLEDGE
+    // we can follow an edge if it is valid, and not a LINESITE, ARCSITE or NULLEDGE
     bool valid_next_edge(HEEdge e) {
-        return ( (g[e].type != LINESITE) && (g[e].type !=NULLEDGE) && (g[e].valid) );
+        return ( (g[e].type != LINESITE) && (g[e].type != ARCSITE) && (g[e].type !=NULLEDGE) && remaining.valid(e) );
     }
     // check if the source of the edge is a valid starting-point for a path
     bool degree_one_source(HEEdge e) {
@@ -265,9 +321,16 @@ public:
         return (count==1);
     }
 private:
-    boost::python::list out;
+    MedialChainList out;
     MedialAxisWalk(); // don't use.
     HEGraph& g; // original graph
+    const FilterView* view; // the filter result to walk, or 0 for the valid-property of g
+    FilterView remaining; // the edges not yet walked
+    EdgeVector edge_list; // g.edges()
+    std::vector<unsigned int> edge_position; // the position in edge_list, by edge index
+    /// positions in edge_list, smallest first
+    typedef std::priority_queue< unsigned int, std::vector<unsigned int>, std::greater<unsigned int> > StartQueue;
+    StartQueue start_queue; // candidate start-edges
 
 };
 
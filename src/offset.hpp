@@ -24,8 +24,12 @@
 #include <string>
 #include <iostream>
 
+#include <boost/foreach.hpp>
+
 #include "graph.hpp"
 #include "site.hpp"
+#include "clearance_index.hpp"
+#include "filter_view.hpp"
 
 namespace ovd
 {
@@ -45,6 +49,15 @@ struct OffsetVertex {
 typedef std::list<OffsetVertex> OffsetLoop;
 typedef std::list<OffsetLoop> OffsetLoops;
 
+/// \brief the offset loops at one of the distances given to Offset::offset(const std::vector<double>&)
+struct OffsetLevel {
+    OffsetLevel(unsigned int li, double ti): level(li), t(ti) {}
+    unsigned int level; ///< the position of t in the vector of distances
+    double t; ///< the offset distance
+    OffsetLoops loops;
+};
+typedef std::vector<OffsetLevel> OffsetLevels;
+
 /// \brief From a voronoi-diagram, generate offsets.
 /// an offset is allways a closed loop.
 /// the loop consists of offset-elements from each face that the loop visits.
@@ -56,10 +69,22 @@ typedef std::list<OffsetLoop> OffsetLoops;
 /// This class produces offsets at the given offset-distance on the entire
 /// voronoi-diagram. To produce offsets only inside or outside a given geometry,
 /// use a filter first. The filter sets the valid-property of edges, so that offsets
-/// are not produced on faces with one or more invalid edge.
+/// are not produced on faces with one or more invalid edge. A filter can also write
+/// into a FilterView, which is then given to the constructor instead.
+///
+/// the first call to offset() builds a ClearanceIndex of the diagram. After that an offset
+/// visits only the faces that it crosses, so repeated offsets (e.g. for pocketing) cost
+/// time proportional to the size of the output. If the diagram changes (see HEGraph::generation())
+/// the next offset builds the index again.
 class Offset {
 public:
-    Offset(HEGraph& gi): g(gi) {
+    Offset(HEGraph& gi): g(gi), view(0), next_start(0) {
+        face_done.clear();
+        face_done.assign( g.num_faces(), 1 );
+    }
+    /// offsets on the faces where all edges are valid in the view, instead of in g.
+    /// g is not modified, so several offsets with different views can share a diagram.
+    Offset(HEGraph& gi, const FilterView& v): g(gi), view(&v), next_start(0) {
         face_done.clear();
         face_done.assign( g.num_faces(), 1 );
     }
@@ -77,8 +102,34 @@ public:
         }
         return offset_list;
     }
+    /// offsets at all the distances in ts, e.g. the levels of a pocketing toolpath.
+    /// the edges are swept once in clearance order to find the faces of every level
+    /// (see ClearanceIndex), and then each level is walked as in offset(t).
+    /// levels[n] holds the loops at distance ts[n].
+    OffsetLevels offset(const std::vector<double>& ts) {
+        update_index();
+        std::vector<FaceVector> level_faces;
+        index.faces(ts, level_faces);
+        OffsetLevels levels;
+        levels.reserve( ts.size() );
+        for (unsigned int n=0; n<ts.size(); ++n) {
+            offset_list = OffsetLoops();
+            start_faces.swap( level_faces[n] );
+            set_start_flags();
+            HEFace start;
+            while (find_start_face(start)) {
+                offset_walk(start,ts[n]);
+            }
+            levels.push_back( OffsetLevel(n, ts[n]) );
+            levels.back().loops.swap( offset_list );
+        }
+        return levels;
+    }
+    // the faces found by set_flags() are in increasing order, and a face that is done
+    // stays done. so the search continues from where the previous search stopped.
     bool find_start_face(HEFace& start) {
-        for(HEFace f=0; f<g.num_faces() ; f++) {
+        for( ; next_start<start_faces.size() ; next_start++) {
+            HEFace f = start_faces[next_start];
             if (face_done[f]==0 ) {
                 start=f;
                 return true;
@@ -170,40 +221,44 @@ public:
     
     
     void set_flags(double t) {
+        update_index();
         
-        // go through all faces and set flag=0 if the face requires an offset.
-        for(HEFace f=0; f<g.num_faces() ; f++) {
-            HEEdge start = g[f].edge;
-            HEEdge current = start;
-            do {
-                HEVertex src = g.source(current);
-                HEVertex trg = g.target(current);
-                double src_r = g[src].dist();
-                double trg_r = g[trg].dist();
-                if (t_bracket(src_r,trg_r,t)) {
-                    if ( face_done[f] ) // if 1
-                        face_done[f] = 0; // , set to 0. this is a face that requires an offset!
-                }
-                current = g[current].next;
-            } while ( current!=start );
+        // set flag=0 on the faces that require an offset, i.e. have an edge that brackets t.
+        index.faces(t, start_faces);
+        set_start_flags();
+        //print_status();
+    }
+    // build the index on the first offset, and again when the diagram has changed
+    void update_index() {
+        if ( index.up_to_date(g) )
+            return;
+        index.build(g);
+        face_done.assign( g.num_faces(), 1 );
+    }
+    // set flag=0 on all start_faces, except on faces with invalid edges
+    void set_start_flags() {
+        next_start = 0;
+        BOOST_FOREACH( HEFace f, start_faces ) {
+            face_done[f] = 0; // this is a face that requires an offset!
         }
         
-        // again go through faces again, and set flag=1 in any edge on the face is invalid
+        // set flag=1 again if any edge on the face is invalid.
         // this is required because an upstream filter will set valid=false on some edges, but not all, on a face where we do not want offsets.
-        for(HEFace f=0; f<g.num_faces() ; f++) {
+        // the filter may run after the index was built, so this is checked on every call.
+        BOOST_FOREACH( HEFace f, start_faces ) {
             HEEdge start = g[f].edge;
             HEEdge current = start;
             do {
-                if ( !g[current].valid ) {
+                if ( !edge_valid(current) ) {
                     face_done[f] = 1; // don't offset faces with invalid edges
                 }
                 current = g[current].next;
             } while ( current!=start );
         }
-        
-
-        
-        //print_status();
+    }
+    // the valid-property of e, from the view if there is one
+    bool edge_valid(HEEdge e) const {
+        return view ? view->valid(e) : g[e].valid;
     }
     // is t in (a,b) ?
     bool t_bracket(double a, double b, double t) {
@@ -222,8 +277,16 @@ protected:
 private:
     Offset(); // don't use.
     HEGraph& g;
+    // the filter result to use, or 0 for the valid-property of g
+    const FilterView* view;
     // hold a 0/1 flag for each face, indicating if an offset for this face has been produced or not.
     std::vector<unsigned char> face_done;
+    // the clearance-intervals of all edges, built by update_index()
+    ClearanceIndex index;
+    // the faces that the current offset crosses, in increasing order
+    FaceVector start_faces;
+    // find_start_face() continues from this position in start_faces
+    unsigned int next_start;
 };
 
 
@@ -22,8 +22,12 @@
 #include <string>
 #include <iostream>
 
+#include <boost/foreach.hpp>
+
 #include "graph.hpp"
 #include "site.hpp"
+#include "clearance_index.hpp"
+#include "filter_view.hpp"
 
 namespace ovd
 {
@@ -45,16 +49,24 @@ struct FaceOffsetLoop {
     FaceEdges face_edges;
     HEEdge start_edge;
     double t;
+    unsigned int level; ///< the position of t in the distances given to FaceOffset::offset()
 
-    FaceOffsetLoop(const HEEdge &si, double ti): start_edge(si), t(ti) {}
+    FaceOffsetLoop(const HEEdge &si, double ti, unsigned int li=0): start_edge(si), t(ti), level(li) {}
 };
 typedef std::vector<FaceOffsetLoop> FaceOffsetLoops;
 
 
 // experimental alternative offset approach.
+// like Offset, this uses a ClearanceIndex to visit only the faces that an offset crosses.
 class FaceOffset {
 public:
-    FaceOffset(HEGraph& gi): g(gi) {
+    FaceOffset(HEGraph& gi): g(gi), view(0), next_start(0) {
+        face_done.clear();
+        face_done.assign( g.num_faces(), 1 );
+    }
+    /// offsets on the faces where all edges are valid in the view, instead of in g.
+    /// g is not modified, so several offsets with different views can share a diagram.
+    FaceOffset(HEGraph& gi, const FilterView& v): g(gi), view(&v), next_start(0) {
         face_done.clear();
         face_done.assign( g.num_faces(), 1 );
     }
@@ -67,11 +79,29 @@ public:
         }
         //return offset_list;
     }
+    /// offsets at all the distances in ts, with one sweep over the edges (see Offset).
+    /// the loops of ts[n] have level n.
+    void offset(const std::vector<double>& ts) {
+        offset_list = FaceOffsetLoops();
+        update_index();
+        std::vector<FaceVector> level_faces;
+        index.faces(ts, level_faces);
+        for (unsigned int n=0; n<ts.size(); ++n) {
+            start_faces.swap( level_faces[n] );
+            set_start_flags();
+            HEFace start;
+            while (find_start_face(start)) {
+                offset_walk(start,ts[n],n);
+            }
+        }
+    }
     FaceOffsetLoops get_offset_list() {
         return offset_list;
     }
+    // continue from where the previous search stopped, see Offset::find_start_face()
     bool find_start_face(HEFace& start) {
-        for(HEFace f=0; f<g.num_faces() ; f++) {
+        for( ; next_start<start_faces.size() ; next_start++) {
+            HEFace f = start_faces[next_start];
             if (face_done[f]==0 ) {
                 start=f;
                 return true;
@@ -80,13 +110,13 @@ public:
         return false;
     }
 
-    void offset_walk(HEFace start,double t) {
+    void offset_walk(HEFace start,double t, unsigned int level=0) {
         //std::cout << " offset_walk() starting on face " << start << "\n";
         bool out_in_mode= false; 
         HEEdge start_edge =  find_next_offset_edge( g[start].edge , t, out_in_mode); // the first edge on the start-face
         HEEdge current_edge = start_edge;
         
-        FaceOffsetLoop loop(start_edge, t); // store the output in this loop
+        FaceOffsetLoop loop(start_edge, t, level); // store the output in this loop
         
         // add the first point to the loop.
         //boost::python::list pt;
@@ -172,40 +202,37 @@ public:
     
     
     void set_flags(double t) {
-        
-        // go through all faces and set flag=0 if the face requires an offset.
-        for(HEFace f=0; f<g.num_faces() ; f++) {
-            HEEdge start = g[f].edge;
-            HEEdge current = start;
-            do {
-                HEVertex src = g.source(current);
-                HEVertex trg = g.target(current);
-                double src_r = g[src].dist();
-                double trg_r = g[trg].dist();
-                if (t_bracket(src_r,trg_r,t)) {
-                    if ( face_done[f] ) // if 1
-                        face_done[f] = 0; // , set to 0. this is a face that requires an offset!
-                }
-                current = g[current].next;
-            } while ( current!=start );
-        }
-        
-        // again go through faces again, and set flag=1 in any edge on the face is invalid
-        // this is required because an upstream filter will set valid=false on some edges, but not all, on a face where we do not want offsets.
-        for(HEFace f=0; f<g.num_faces() ; f++) {
+        update_index();
+        // set flag=0 on the faces that require an offset, i.e. have an edge that brackets t.
+        index.faces(t, start_faces);
+        set_start_flags();
+    }
+    // build the index on the first offset, and again when the diagram has changed
+    void update_index() {
+        if ( index.up_to_date(g) )
+            return;
+        index.build(g);
+        face_done.assign( g.num_faces(), 1 );
+    }
+    // set flag=0 on all start_faces, except on faces with invalid edges.
+    // this is required because an upstream filter will set valid=false on some edges, but not all, on a face where we do not want offsets.
+    void set_start_flags() {
+        next_start = 0;
+        BOOST_FOREACH( HEFace f, start_faces ) {
+            face_done[f] = 0; // this is a face that requires an offset!
             HEEdge start = g[f].edge;
             HEEdge current = start;
             do {
-                if ( !g[current].valid ) {
+                if ( !edge_valid(current) ) {
                     face_done[f] = 1; // don't offset faces with invalid edges
                 }
                 current = g[current].next;
             } while ( current!=start );
         }
-        
-
-        
-        //print_status();
+    }
+    // the valid-property of e, from the view if there is one
+    bool edge_valid(HEEdge e) const {
+        return view ? view->valid(e) : g[e].valid;
     }
     // is t in (a,b) ?
     bool t_bracket(double a, double b, double t) {
@@ -229,10 +256,16 @@ protected:
     FaceOffsetLoops offset_list;
 private:
     FaceOffset(); // don't use.
+    // the filter result to use, or 0 for the valid-property of g
+    const FilterView* view;
     // hold a 0/1 flag for each face, indicating if an offset for this face has been produced or not.
     std::vector<unsigned char> face_done;
-    
-
+    // the clearance-intervals of all edges, built by update_index()
+    ClearanceIndex index;
+    // the faces that the current offset crosses, in increasing order
+    FaceVector start_faces;
+    // find_start_face() continues from this position in start_faces
+    unsigned int next_start;
 };
 
 
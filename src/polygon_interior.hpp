@@ -22,10 +22,9 @@
 #include <string>
 #include <iostream>
 
-#include <boost/python.hpp>
-
 #include "graph.hpp"
 #include "site.hpp"
+#include "filter_view.hpp"
 
 namespace ovd
 {
@@ -36,19 +35,20 @@ namespace ovd
 //
 // a polygon/pocket boundary shoud be specified in CW order
 // islands within the polygon should be specified in CCW order
+// arc-sites are treated like line-sites
 struct interior_filter {
     interior_filter(HEGraph& gi, bool side=true) : g(gi), _side(side) { }
     
     // determine if an edge is valid or not
     bool operator()(const HEEdge& e) const {
-        if (g[e].type == LINESITE || g[e].type == NULLEDGE) 
+        if (g[e].type == LINESITE || g[e].type == ARCSITE || g[e].type == NULLEDGE) 
             return true;
         
         // if polygon inserted ccw  as (id1->id2), then the linesite should occur on valid faces as id1->id2
         // for islands and the outside the edge is id2->id1
         HEFace f = g[e].face;
         Site* s = g[f].site;
-        if ( s->isLine() && linesite_ccw(f) ) 
+        if ( !s->isPoint() && linesite_ccw(f) ) 
             return true;
         else if ( s->isPoint() ) {
             // we need to search for an adjacent linesite. (? can we have a situation where this fails?)
@@ -68,7 +68,7 @@ struct interior_filter {
             HEEdge twin = g[current].twin;
             if (twin != HEEdge() ) {
                 HEFace twf = g[twin].face;
-                if ( g[twf].site->isLine() )
+                if ( !g[twf].site->isPoint() )
                     return current;
             }
             current = g[current].next;
@@ -80,8 +80,9 @@ struct interior_filter {
         HEEdge current = g[f].edge;
         HEEdge start = current;
         do {
-            if ( (_side && g[current].type == LINESITE && g[current].inserted_direction) ||
-                  (!_side && g[current].type == LINESITE && !g[current].inserted_direction)  )
+            bool segment = (g[current].type == LINESITE) || (g[current].type == ARCSITE);
+            if ( (_side && segment && g[current].inserted_direction) ||
+                  (!_side && segment && !g[current].inserted_direction)  )
                 return true;
                 
             current = g[current].next;
@@ -100,6 +101,11 @@ public:
         interior_filter flt(g,side);
         g.filter_graph(flt);
     }
+    /// filter into the view, and leave the valid-property of g unchanged
+    PolygonInterior(HEGraph& gi, bool side, FilterView& view): g(gi) {
+        interior_filter flt(g,side);
+        view.filter(flt);
+    }
 private:
     PolygonInterior(); // don't use.
     HEGraph& g; // original graph
@@ -0,0 +1,185 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <time.h>
+
+#include <sstream>
+
+#include "profiler.hpp"
+
+namespace ovd {
+
+namespace {
+
+// "name": {"total": .., "max": ..}
+void write_counter(std::ostream& out, const char* name, const ProfileCounter& c) {
+    out << "\"" << name << "\": {\"total\": " << c.total << ", \"max\": " << c.max << "}";
+}
+
+// the per-insertion sizes as JSON members
+void write_sizes(std::ostream& out, const InsertionProfile& p) {
+    out << "\"delete_tree\": " << p.delete_tree;
+    out << ", \"incident_faces\": " << p.incident_faces;
+    out << ", \"new_vertices\": " << p.new_vertices;
+    out << ", \"face_walk\": " << p.face_walk;
+}
+
+} // end anonymous namespace
+
+Profiler::Profiler() : enabled(false), trace(false) {
+    reset();
+}
+
+void Profiler::reset() {
+    origin = now();
+    last = origin;
+    current = InsertionProfile();
+    kinds.assign( KindProfile() );
+    traced.clear();
+}
+
+void Profiler::end() {
+    if (!enabled)
+        return;
+    KindProfile& k = kinds[current.kind];
+    k.insertions++;
+    for (unsigned int n=0; n<current.n_laps; ++n)
+        k.phases[ current.laps[n].phase ].add( current.laps[n].time );
+    k.delete_tree.add( current.delete_tree );
+    k.incident_faces.add( current.incident_faces );
+    k.new_vertices.add( current.new_vertices );
+    k.face_walk.add( current.face_walk );
+    if (trace)
+        traced.push_back(current);
+}
+
+std::string Profiler::json() const {
+    std::ostringstream out;
+    out.precision(9);
+    out << "{\n";
+    bool first_kind = true;
+    for (unsigned int n=0; n<kinds.size(); ++n) {
+        const KindProfile& k = kinds[n];
+        if ( k.insertions == 0 )
+            continue;
+        if (!first_kind)
+            out << ",\n";
+        first_kind = false;
+        out << " \"" << kind_name( (SiteKind)n ) << "\": {\n";
+        out << "  \"insertions\": " << k.insertions << ",\n";
+        out << "  \"phases\": {";
+        for (unsigned int p=0; p<N_PHASES; ++p) {
+            out << (p ? ",\n   " : "\n   ");
+            write_counter(out, phase_name( (InsertionPhase)p ), k.phases[p] );
+        }
+        out << "\n  },\n  ";
+        write_counter(out, "delete_tree", k.delete_tree);
+        out << ",\n  ";
+        write_counter(out, "incident_faces", k.incident_faces);
+        out << ",\n  ";
+        write_counter(out, "new_vertices", k.new_vertices);
+        out << ",\n  ";
+        write_counter(out, "face_walk", k.face_walk);
+        out << "\n }";
+    }
+    if ( !traced.empty() ) {
+        if (!first_kind)
+            out << ",\n";
+        out << " \"trace\": [";
+        for (unsigned int n=0; n<traced.size(); ++n) {
+            const InsertionProfile& p = traced[n];
+            out << (n ? ",\n  " : "\n  ");
+            out << "{\"kind\": \"" << kind_name(p.kind) << "\", \"start\": " << p.start << ", ";
+            write_sizes(out, p);
+            out << ", \"phases\": {";
+            for (unsigned int m=0; m<p.n_laps; ++m) {
+                if (m)
+                    out << ", ";
+                out << "\"" << phase_name( p.laps[m].phase ) << "\": " << p.laps[m].time;
+            }
+            out << "}}";
+        }
+        out << "\n ]";
+    }
+    out << "\n}\n";
+    return out.str();
+}
+
+// one complete ("X") event per insertion, and one per phase inside it.
+// times are in microseconds.
+std::string Profiler::chrome_trace() const {
+    std::ostringstream out;
+    out.setf( std::ios::fixed );
+    out.precision(3);
+    out << "{\"traceEvents\": [";
+    for (unsigned int n=0; n<traced.size(); ++n) {
+        const InsertionProfile& p = traced[n];
+        double ts = 1e6*p.start;
+        double dur = 0;
+        for (unsigned int m=0; m<p.n_laps; ++m)
+            dur += 1e6*p.laps[m].time;
+        out << (n ? ",\n" : "\n");
+        out << "{\"name\": \"" << kind_name(p.kind) << "\", \"cat\": \"insert\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, ";
+        out << "\"ts\": " << ts << ", \"dur\": " << dur << ", \"args\": {\"n\": " << n << ", ";
+        write_sizes(out, p);
+        out << "}}";
+        for (unsigned int m=0; m<p.n_laps; ++m) {
+            out << ",\n{\"name\": \"" << phase_name( p.laps[m].phase ) << "\", \"cat\": \"phase\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, ";
+            out << "\"ts\": " << ts << ", \"dur\": " << 1e6*p.laps[m].time << "}";
+            ts += 1e6*p.laps[m].time;
+        }
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+const char* Profiler::phase_name(InsertionPhase p) {
+    switch (p) {
+    case PHASE_NULL_FACE:    return "null_face";
+    case PHASE_SEED:         return "seed";
+    case PHASE_AUGMENT:      return "augment";
+    case PHASE_ADD_VERTICES: return "add_vertices";
+    case PHASE_SEPARATORS:   return "separators";
+    case PHASE_ADD_EDGES:    return "add_edges";
+    case PHASE_REPAIR:       return "repair";
+    case PHASE_REMOVE:       return "remove";
+    case PHASE_SPLIT:        return "split";
+    case PHASE_RESET:        return "reset";
+    case PHASE_VALIDATE:     return "validate";
+    default:                 return "unknown";
+    }
+}
+
+const char* Profiler::kind_name(SiteKind k) {
+    switch (k) {
+    case SITE_POINT: return "point";
+    case SITE_LINE:  return "line";
+    case SITE_ARC:   return "arc";
+    default:         return "unknown";
+    }
+}
+
+double Profiler::now() {
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+} // end namespace
+// end profiler.cpp
@@ -0,0 +1,185 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <string>
+#include <vector>
+
+#include <boost/array.hpp>
+
+#include "site.hpp"
+
+namespace ovd {
+
+/// the phases of inserting a site, in the order they run in insert_point_site().
+/// PHASE_NULL_FACE, PHASE_SEPARATORS and PHASE_SPLIT are used only by insert_line_site() and insert_arc_site().
+enum InsertionPhase {
+    PHASE_NULL_FACE,    ///< find_null_face(), and add_linesite_edges() or add_arcsite_edges()
+    PHASE_SEED,         ///< find the closest face and the seed vertex
+    PHASE_AUGMENT,      ///< augment_vertex_set()
+    PHASE_ADD_VERTICES, ///< add_vertices()
+    PHASE_SEPARATORS,   ///< add_separator() at the end-points of a line- or arc-site
+    PHASE_ADD_EDGES,    ///< add_face() and add_edges()
+    PHASE_REPAIR,       ///< repair_face()
+    PHASE_REMOVE,       ///< remove_vertex_set()
+    PHASE_SPLIT,        ///< remove_split_vertex()
+    PHASE_RESET,        ///< reset_status()
+    PHASE_VALIDATE,     ///< validate()
+    N_PHASES
+};
+
+/// the sum and the maximum of a per-insertion quantity
+struct ProfileCounter {
+    ProfileCounter() : total(0), max(0) {}
+    void add(double x) {
+        total += x;
+        if (x > max)
+            max = x;
+    }
+    double total;
+    double max;
+};
+
+/// one timed phase of an insertion
+struct ProfileLap {
+    InsertionPhase phase;
+    /// seconds
+    double time;
+};
+
+/// the profile of one inserted site
+struct InsertionProfile {
+    InsertionProfile() : kind(SITE_POINT), start(0), n_laps(0),
+                         delete_tree(0), incident_faces(0), new_vertices(0), face_walk(0) {}
+    /// the kind of site inserted
+    SiteKind kind;
+    /// seconds since the Profiler was reset
+    double start;
+    /// the phases in the order they ran
+    boost::array<ProfileLap, 16> laps;
+    unsigned int n_laps;
+    /// size of the delete-tree |v0|
+    unsigned int delete_tree;
+    /// number of incident faces
+    unsigned int incident_faces;
+    /// number of NEW vertices
+    unsigned int new_vertices;
+    /// number of edges visited while walking faces
+    unsigned int face_walk;
+};
+
+/// aggregated profiles of all inserted sites of one kind
+struct KindProfile {
+    KindProfile() : insertions(0) {}
+    unsigned long insertions;
+    /// seconds spent in each phase
+    boost::array<ProfileCounter, N_PHASES> phases;
+    ProfileCounter delete_tree;
+    ProfileCounter incident_faces;
+    ProfileCounter new_vertices;
+    ProfileCounter face_walk;
+};
+
+/// \brief per-phase timing of site insertions
+///
+/// VoronoiDiagram calls begin() when a site insertion starts, lap() when a phase ends,
+/// and end() when the insertion is done. Each phase is timed with the monotonic clock.
+/// The profiler is off by default, and then does nothing but test a flag.
+/// With set_trace(true) the profile of every insertion is also kept, for
+/// export as a Chrome trace (chrome://tracing) with chrome_trace().
+class Profiler {
+public:
+    Profiler();
+    /// turn profiling on or off
+    void set_enabled(bool on) { enabled = on; }
+    /// true if profiling is on
+    bool get_enabled() const { return enabled; }
+    /// keep the profile of every insertion. memory grows with the number of sites!
+    void set_trace(bool on) { trace = on; }
+    /// true if insertions are traced
+    bool get_trace() const { return trace; }
+    /// clear all profiles, and restart the clock
+    void reset();
+
+    /// start profiling the insertion of a site
+    void begin(SiteKind kind) {
+        if (!enabled)
+            return;
+        current = InsertionProfile();
+        current.kind = kind;
+        last = now();
+        current.start = last - origin;
+    }
+    /// the time since begin() or the previous lap() was spent in phase p
+    void lap(InsertionPhase p) {
+        if (!enabled)
+            return;
+        double t = now();
+        if ( current.n_laps > 0 && current.laps[current.n_laps-1].phase == p ) {
+            current.laps[current.n_laps-1].time += t - last;
+        } else if ( current.n_laps < current.laps.size() ) {
+            current.laps[current.n_laps].phase = p;
+            current.laps[current.n_laps].time = t - last;
+            current.n_laps++;
+        }
+        last = t;
+    }
+    /// the sizes of the delete-tree, incident faces and new vertices of the current insertion
+    void sizes(unsigned int delete_tree, unsigned int incident_faces, unsigned int new_vertices) {
+        current.delete_tree = delete_tree;
+        current.incident_faces = incident_faces;
+        current.new_vertices = new_vertices;
+    }
+    /// count an edge visited while walking a face
+    void walk() { current.face_walk++; }
+    /// the insertion is done
+    void end();
+
+    /// aggregated profile of the sites of one kind
+    const KindProfile& kind_profile(SiteKind kind) const { return kinds[kind]; }
+    /// the traced insertions
+    const std::vector<InsertionProfile>& insertions() const { return traced; }
+    /// aggregates, and the traced insertions, as JSON
+    std::string json() const;
+    /// the traced insertions in the Chrome trace event format
+    std::string chrome_trace() const;
+
+    /// name of a phase
+    static const char* phase_name(InsertionPhase p);
+    /// name of a site kind
+    static const char* kind_name(SiteKind k);
+    /// the monotonic clock, in seconds
+    static double now();
+private:
+    bool enabled;
+    bool trace;
+    /// now() at reset()
+    double origin;
+    /// now() at the previous begin() or lap()
+    double last;
+    InsertionProfile current;
+    boost::array<KindProfile, 3> kinds;
+    std::vector<InsertionProfile> traced;
+};
+
+} // end namespace
+#endif
+// end profiler.hpp
@@ -0,0 +1,166 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ARRAY_PY_HPP
+#define ARRAY_PY_HPP
+
+#ifndef PYTHON_DWA2002810_HPP
+#include <boost/python.hpp>
+#endif
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstring>
+#include <cassert>
+
+#include <boost/cstdint.hpp>
+
+#include "common/point.hpp"
+
+// conversion between C++ vectors and python arrays, without a numpy dependency.
+// arrays are read through the python buffer protocol, which numpy arrays,
+// array.array, bytearray and memoryview objects provide.
+
+namespace ovd
+{
+
+/// \brief releases the python GIL while in scope, so other python threads can run.
+/// no python objects may be used while the GIL is released.
+class ScopedGILRelease {
+public:
+    ScopedGILRelease() : state( PyEval_SaveThread() ) {}
+    ~ScopedGILRelease() { PyEval_RestoreThread(state); }
+private:
+    PyThreadState* state;
+};
+
+/// true if the byte order of this machine is little-endian
+inline bool host_little_endian() {
+    unsigned int one = 1;
+    return *reinterpret_cast<unsigned char*>(&one) == 1;
+}
+
+/// raise a python ValueError
+inline void array_error(const std::string& msg) {
+    PyErr_SetString(PyExc_ValueError, msg.c_str());
+    boost::python::throw_error_already_set();
+}
+
+/// \brief a C-contiguous array with two columns, read through the buffer protocol.
+///
+/// the array has the shape (n,2), or the shape (2*n) with the columns interleaved.
+class PairArrayView {
+public:
+    PairArrayView(boost::python::object obj) {
+        if ( PyObject_GetBuffer(obj.ptr(), &buf, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0 )
+            boost::python::throw_error_already_set();
+        Py_ssize_t n_items = buf.itemsize ? buf.len / buf.itemsize : 0;
+        if ( buf.ndim == 2 && buf.shape[1] != 2 ) {
+            PyBuffer_Release(&buf);
+            array_error("expected an array of shape (n,2)");
+        }
+        if ( buf.ndim > 2 || n_items % 2 != 0 ) {
+            PyBuffer_Release(&buf);
+            array_error("expected an array of shape (n,2), or a flat array of even length");
+        }
+        n_rows = n_items/2;
+        type = format_type();
+    }
+    ~PairArrayView() { PyBuffer_Release(&buf); }
+    /// number of rows
+    unsigned int size() const { return n_rows; }
+    /// the type of the elements: 'd' for double, 'i' for 32-bit and 'q' for 64-bit signed integers.
+    /// 0 for other types.
+    char element_type() const { return type; }
+    /// element m of row n, of the given type
+    template <class T>
+    T at(unsigned int n, unsigned int m) const {
+        assert( sizeof(T) == (unsigned int)buf.itemsize );
+        T value;
+        std::memcpy( &value, static_cast<const char*>(buf.buf) + (2*n+m)*buf.itemsize, sizeof(T) );
+        return value;
+    }
+private:
+    // the element type from the struct-module format string of the buffer.
+    // only native byte order is accepted.
+    char format_type() const {
+        std::string f = buf.format ? buf.format : "B";
+        if ( !f.empty() && ( f[0]=='@' || f[0]=='=' || (f[0]=='<' && host_little_endian()) ) )
+            f = f.substr(1);
+        if ( f.size() != 1 )
+            return 0;
+        if ( f[0]=='d' && buf.itemsize == sizeof(double) )
+            return 'd';
+        if ( (f[0]=='i' || f[0]=='l' || f[0]=='q') && buf.itemsize == 4 )
+            return 'i';
+        if ( (f[0]=='i' || f[0]=='l' || f[0]=='q') && buf.itemsize == 8 )
+            return 'q';
+        return 0;
+    }
+    PairArrayView(); // don't use.
+    PairArrayView(const PairArrayView&); // don't copy, the buffer is released once.
+    Py_buffer buf;
+    unsigned int n_rows;
+    char type;
+};
+
+/// the rows of an (n,2) array of float64 as points
+inline std::vector<Point> points_from_array(boost::python::object obj) {
+    PairArrayView a(obj);
+    if ( a.element_type() != 'd' )
+        array_error("expected an array of float64");
+    std::vector<Point> points;
+    points.reserve( a.size() );
+    for (unsigned int n=0; n<a.size(); ++n)
+        points.push_back( Point( a.at<double>(n,0), a.at<double>(n,1) ) );
+    return points;
+}
+
+/// the rows of an (m,2) array of int32 or int64 as pairs
+inline std::vector< std::pair<int,int> > pairs_from_array(boost::python::object obj) {
+    PairArrayView a(obj);
+    std::vector< std::pair<int,int> > pairs;
+    pairs.reserve( a.size() );
+    if ( a.element_type() == 'i' ) {
+        for (unsigned int n=0; n<a.size(); ++n)
+            pairs.push_back( std::make_pair( (int)a.at<boost::int32_t>(n,0), (int)a.at<boost::int32_t>(n,1) ) );
+    } else if ( a.element_type() == 'q' ) { // a handle that does not fit an int is never valid
+        for (unsigned int n=0; n<a.size(); ++n) {
+            boost::int64_t i1 = a.at<boost::int64_t>(n,0);
+            boost::int64_t i2 = a.at<boost::int64_t>(n,1);
+            pairs.push_back( std::make_pair( (i1 == (int)i1) ? (int)i1 : -1, (i2 == (int)i2) ? (int)i2 : -1 ) );
+        }
+    } else {
+        array_error("expected an array of int32 or int64");
+    }
+    return pairs;
+}
+
+/// the values as an array.array('i'), which numpy.asarray() uses without a copy
+inline boost::python::object int_array(const std::vector<int>& values) {
+    assert( sizeof(int) == 4 );
+    const char* data = values.empty() ? "" : reinterpret_cast<const char*>( &values[0] );
+    boost::python::object bytes( boost::python::handle<>(
+        PyBytes_FromStringAndSize( data, values.size()*sizeof(int) ) ) );
+    return boost::python::import("array").attr("array")("i", bytes);
+}
+
+} // end namespace
+#endif
+// end array_py.hpp
@@ -0,0 +1,88 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef DIAGRAM_ARRAYS_PY_HPP
+#define DIAGRAM_ARRAYS_PY_HPP
+
+#ifndef PYTHON_DWA2002810_HPP
+#include <boost/python.hpp>
+#endif
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "diagram_arrays.hpp"
+#include "array_py.hpp"
+
+namespace ovd
+{
+
+/// \brief one array of a DiagramArrays, exported with the numpy array interface.
+///
+/// numpy.asarray() makes an array that uses the memory of the DiagramArrays without a copy,
+/// and keeps this object, and with it the DiagramArrays, alive.
+class ArrayRef_py {
+public:
+    ArrayRef_py(boost::shared_ptr<DiagramArrays> o, const std::vector<double>& v, unsigned int cols)
+        : owner(o), data( v.empty() ? 0 : &v[0] ), rows( v.size()/cols ), columns(cols), type("f8") {}
+    ArrayRef_py(boost::shared_ptr<DiagramArrays> o, const std::vector<int>& v, unsigned int cols)
+        : owner(o), data( v.empty() ? 0 : &v[0] ), rows( v.size()/cols ), columns(cols), type("i4") {}
+    /// the __array_interface__ dict, see the numpy documentation
+    boost::python::dict array_interface() const {
+        static double empty = 0; // numpy requires a non-null data pointer, also for empty arrays
+        boost::python::dict d;
+        d["version"] = 3;
+        d["typestr"] = std::string( host_little_endian() ? "<" : ">" ) + type;
+        d["data"] = boost::python::make_tuple( (size_t)( data ? data : &empty ), true ); // read-only
+        if ( columns == 1 )
+            d["shape"] = boost::python::make_tuple( rows );
+        else
+            d["shape"] = boost::python::make_tuple( rows, columns );
+        return d;
+    }
+    /// number of rows
+    unsigned int size() const { return rows; }
+private:
+    boost::shared_ptr<DiagramArrays> owner;
+    const void* data;
+    unsigned int rows;
+    unsigned int columns;
+    std::string type;
+};
+
+/// \brief python wrapper for DiagramArrays
+class DiagramArrays_py {
+public:
+    DiagramArrays_py(boost::shared_ptr<DiagramArrays> a) : arrays(a) {}
+    ArrayRef_py vertex_xy() const { return ArrayRef_py( arrays, arrays->vertex_xy, 2 ); }
+    ArrayRef_py vertex_clearance() const { return ArrayRef_py( arrays, arrays->vertex_clearance, 1 ); }
+    ArrayRef_py vertex_table() const { return ArrayRef_py( arrays, arrays->vertex_table, DiagramArrays::VERTEX_COLUMNS ); }
+    ArrayRef_py edge_table() const { return ArrayRef_py( arrays, arrays->edge_table, DiagramArrays::EDGE_COLUMNS ); }
+    ArrayRef_py edge_offsets() const { return ArrayRef_py( arrays, arrays->edge_offsets, 1 ); }
+    ArrayRef_py edge_xy() const { return ArrayRef_py( arrays, arrays->edge_xy, 2 ); }
+    unsigned int num_vertices() const { return arrays->num_vertices(); }
+    unsigned int num_edges() const { return arrays->num_edges(); }
+private:
+    boost::shared_ptr<DiagramArrays> arrays;
+};
+
+} // end namespace
+#endif
+// end diagram_arrays_py.hpp
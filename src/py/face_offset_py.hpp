@@ -23,6 +23,7 @@
 
 #include "offset2.hpp"
 #include "voronoidiagram.hpp"
+#include "array_py.hpp"
 
 namespace ovd
 {
@@ -31,10 +32,31 @@ namespace ovd
 class FaceOffset_py : public FaceOffset {
 public:
     FaceOffset_py(HEGraph& gi): FaceOffset(gi) { }
+    FaceOffset_py(HEGraph& gi, const FilterView& v): FaceOffset(gi, v) { }
 
+    /// the loops at distance t. the faces are walked with the GIL released.
     boost::python::list offset_py(double t) {
-        offset(t);
-        boost::python::list py_offsets;
+        {
+            ScopedGILRelease nogil;
+            offset(t);
+        }
+        return boost::python::list( loops_py(1)[0] );
+    }
+    /// offsets at all distances in the python list ts. returns one list of loops per distance.
+    boost::python::list offset_levels_py(boost::python::list ts) {
+        std::vector<double> tv;
+        for (int n=0; n<boost::python::len(ts); ++n)
+            tv.push_back( boost::python::extract<double>(ts[n]) );
+        {
+            ScopedGILRelease nogil;
+            offset(tv);
+        }
+        return loops_py( tv.size() );
+    }
+private:
+    // the loops of offset_list, as a list with one python list per level
+    boost::python::list loops_py(unsigned int n_levels) {
+        std::vector<boost::python::list> levels(n_levels);
         BOOST_FOREACH( FaceOffsetLoop loop, offset_list ) { // loop through each loop
             HEEdge current_edge = loop.start_edge;
             boost::python::list py_loop;
@@ -58,11 +80,14 @@ public:
                 py_loop.append(lpt);
                 current_edge = face_edge.next_edge;
             }
-            py_offsets.append( py_loop );
+            levels[loop.level].append( py_loop );
+        }
+        boost::python::list py_levels;
+        BOOST_FOREACH( const boost::python::list& l, levels ) {
+            py_levels.append( l );
         }
-        return py_offsets;
+        return py_levels;
     }
-private:
     FaceOffset_py(); // don't use.
 };
 
@@ -0,0 +1,64 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef FILTERS_PY_HPP
+#define FILTERS_PY_HPP
+
+#ifndef PYTHON_DWA2002810_HPP
+#include <boost/python.hpp>
+#endif
+
+#include "polygon_interior.hpp"
+#include "medial_axis.hpp"
+#include "island_filter.hpp"
+#include "array_py.hpp"
+
+// the filters do their work in the constructor. These factories, registered
+// with boost::python::make_constructor(), run the constructors with the GIL released.
+
+namespace ovd
+{
+
+inline PolygonInterior* polygon_interior_py(HEGraph& g, bool side) {
+    ScopedGILRelease nogil;
+    return new PolygonInterior(g, side);
+}
+inline PolygonInterior* polygon_interior_view_py(HEGraph& g, bool side, FilterView& view) {
+    ScopedGILRelease nogil;
+    return new PolygonInterior(g, side, view);
+}
+inline MedialAxis* medial_axis_py(HEGraph& g) {
+    ScopedGILRelease nogil;
+    return new MedialAxis(g);
+}
+inline MedialAxis* medial_axis_view_py(HEGraph& g, FilterView& view) {
+    ScopedGILRelease nogil;
+    return new MedialAxis(g, view);
+}
+inline IslandFilter* island_filter_py(HEGraph& g) {
+    ScopedGILRelease nogil;
+    return new IslandFilter(g);
+}
+inline IslandFilter* island_filter_view_py(HEGraph& g, FilterView& view) {
+    ScopedGILRelease nogil;
+    return new IslandFilter(g, view);
+}
+
+} // end namespace
+#endif
+// end filters_py.hpp
@@ -0,0 +1,71 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef MEDIAL_AXIS_WALK_PY_HPP
+#define MEDIAL_AXIS_WALK_PY_HPP
+
+#ifndef PYTHON_DWA2002810_HPP
+#include <boost/python.hpp>
+#endif
+
+#include <boost/foreach.hpp>
+
+#include "medial_axis.hpp"
+#include "array_py.hpp"
+
+namespace ovd
+{
+
+/// \brief python wrapper for MedialAxisWalk
+class MedialAxisWalk_py : public MedialAxisWalk {
+public:
+    MedialAxisWalk_py(HEGraph& gi): MedialAxisWalk(gi) { }
+    MedialAxisWalk_py(HEGraph& gi, const FilterView& v): MedialAxisWalk(gi, v) { }
+
+    /// the chains of walk(), as a list of chains.
+    /// each chain is a list of edges, and each edge a list of [Point, clearance]
+    boost::python::list walk_py() {
+        MedialChainList chains;
+        {
+            ScopedGILRelease nogil;
+            chains = walk();
+        }
+        boost::python::list py_chains;
+        BOOST_FOREACH( const MedialChain& chain, chains ) {
+            boost::python::list py_chain;
+            BOOST_FOREACH( const MedialPointList& edge, chain ) {
+                boost::python::list py_edge;
+                BOOST_FOREACH( const MedialPoint& mp, edge ) {
+                    boost::python::list pt;
+                    pt.append( mp.p );
+                    pt.append( mp.clearance );
+                    py_edge.append( pt );
+                }
+                py_chain.append( py_edge );
+            }
+            py_chains.append( py_chain );
+        }
+        return py_chains;
+    }
+private:
+    MedialAxisWalk_py(); // don't use.
+};
+
+} // end namespace
+#endif
+// end medial_axis_walk_py.hpp
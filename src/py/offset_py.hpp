@@ -26,6 +26,7 @@
 #ifndef OFFSET_HPP
 #include "offset.hpp"
 #endif
+#include "array_py.hpp"
 #ifndef VORONOI_DIAGRAM_HPP
 #include "voronoidiagram.hpp"
 #endif
@@ -37,11 +38,36 @@ namespace ovd
 class Offset_py : public Offset {
 public:
     Offset_py(HEGraph& gi): Offset(gi) { }
+    Offset_py(HEGraph& gi, const FilterView& v): Offset(gi, v) { }
 
+    /// the loops at distance t. computed with the GIL released.
     boost::python::list offset_py(double t) {
-        offset(t);
+        {
+            ScopedGILRelease nogil;
+            offset(t);
+        }
+        return loops_py(offset_list);
+    }
+    /// offsets at all distances in the python list ts. returns one list of loops per distance.
+    boost::python::list offset_levels_py(boost::python::list ts) {
+        std::vector<double> tv;
+        for (int n=0; n<boost::python::len(ts); ++n)
+            tv.push_back( boost::python::extract<double>(ts[n]) );
+        OffsetLevels levels;
+        {
+            ScopedGILRelease nogil;
+            levels = offset(tv);
+        }
+        boost::python::list py_levels;
+        BOOST_FOREACH( const OffsetLevel& level, levels ) {
+            py_levels.append( loops_py(level.loops) );
+        }
+        return py_levels;
+    }
+private:
+    boost::python::list loops_py(const OffsetLoops& loops) {
         boost::python::list py_offsets;
-        BOOST_FOREACH( OffsetLoop loop, offset_list ) { // loop through each loop
+        BOOST_FOREACH( OffsetLoop loop, loops ) { // loop through each loop
             boost::python::list py_loop;
             bool first = true;
             BOOST_FOREACH( OffsetVertex lpt, loop ) { //loop through each line/arc
@@ -62,7 +88,6 @@ public:
         }
         return py_offsets;
     }
-private:
     Offset_py(); // don't use.
 };
 
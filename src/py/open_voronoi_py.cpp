@@ -24,24 +24,35 @@
 
 #include "offset_py.hpp"
 #include "face_offset_py.hpp"
-#include "polygon_interior.hpp"
-#include "medial_axis.hpp"
-#include "island_filter.hpp"
+#include "filters_py.hpp"
+#include "medial_axis_walk_py.hpp"
+#include "svg_writer_py.hpp"
 #include "utility/vd2svg.hpp"
 #include "version.hpp"
 
 /*
  *  Boost::Python wrapping of voronoi diagram and related classes.
+ *
+ *  The GIL is released while sites are inserted, and while checks, filters,
+ *  offsets, medial-axis walks, array exports and svg output are computed.
+ *  Python objects are built only after the GIL is taken again.
+ *  See "Python threads" in the README for what may run concurrently.
  */
 
 using namespace ovd;
 
 namespace bp = boost::python;
 
+// write the svg file with the GIL released
+void vd2svg_py(std::string filename, VoronoiDiagram* vd) {
+    ScopedGILRelease nogil;
+    vd2svg(filename, vd);
+}
+
 BOOST_PYTHON_MODULE(openvoronoi) {
     bp::def("version", version);
     bp::def("build_type", build_type);
-    bp::def("vd2svg", vd2svg);
+    bp::def("vd2svg", vd2svg_py);
     
     bp::class_<VoronoiDiagram >("VoronoiDiagram_base", bp::no_init)
     ;
@@ -53,6 +64,10 @@ BOOST_PYTHON_MODULE(openvoronoi) {
         .def("addVertexSite",  &VoronoiDiagram_py::insert_point_site2 ) // (point, step)
         .def("addLineSite",  &VoronoiDiagram_py::insert_line_site2 ) // takes two arguments
         .def("addLineSite",  &VoronoiDiagram_py::insert_line_site3 ) // takes three arguments (idx1, idx2, step)
+        .def("addVertexSites",  &VoronoiDiagram_py::insert_point_sites_py ) // (n,2) float64 array -> int32 array of handles
+        .def("addLineSites",  &VoronoiDiagram_py::insert_line_sites_py ) // (m,2) int array of handles -> int32 array of InsertStatus
+        .def("addArcSite",  &VoronoiDiagram_py::insert_arc_site4 ) // (idx1, idx2, center, cw)
+        .def("addArcSite",  &VoronoiDiagram_py::insert_arc_site5 ) // (idx1, idx2, center, cw, step)
         .def("getGenerators",  &VoronoiDiagram_py::getGenerators)
         .def("getEdgesGenerators",  &VoronoiDiagram_py::getEdgesGenerators)
         .def("getVoronoiVertices",  &VoronoiDiagram_py::getVoronoiVertices)
@@ -61,8 +76,10 @@ BOOST_PYTHON_MODULE(openvoronoi) {
         .def("getFarRadius",  &VoronoiDiagram_py::get_far_radius)
         .def("getVoronoiEdges",  &VoronoiDiagram_py::getVoronoiEdges)
         .def("getVoronoiEdgesOffset",  &VoronoiDiagram_py::getVoronoiEdgesOffset)
+        .def("getArrays",  &VoronoiDiagram_py::get_arrays) // vertices and edges as arrays, for numpy.asarray()
         .def("numPointSites", &VoronoiDiagram_py::num_point_sites)
         .def("numLineSites", &VoronoiDiagram_py::num_line_sites)
+        .def("numArcSites", &VoronoiDiagram_py::num_arc_sites)
         .def("numVertices", &VoronoiDiagram_py::num_vertices)
         .def("numFaces", &VoronoiDiagram_py::num_faces)
         .def("numSplitVertices", &VoronoiDiagram_py::num_split_vertices)
@@ -71,14 +88,56 @@ BOOST_PYTHON_MODULE(openvoronoi) {
         .def("setEdgePoints", &VoronoiDiagram_py::set_edge_points)
         .def("setEdgeOffset", &VoronoiDiagram_py::set_null_edge_offset)
         .def("debug_on", &VoronoiDiagram_py::debug_on)
-        .def("check", &VoronoiDiagram_py::check)
+        .def("check", &VoronoiDiagram_py::check_py)
+        .def("save", &VoronoiDiagram_py::save_py) // (filename) binary file, see diagram_file.hpp
+        .def("load", &VoronoiDiagram_py::load_py) // (filename) replaces this diagram
+        .def("setValidation", &VoronoiDiagram_py::set_validation)
+        .def("getValidation", &VoronoiDiagram_py::get_validation)
+        .def("numValidationFailures", &VoronoiDiagram_py::num_validation_failures)
+        .def("validationError", &VoronoiDiagram_py::validation_error)
+        .def("setAdaptivePrecision", &VoronoiDiagram_py::set_adaptive_precision)
+        .def("getAdaptivePrecision", &VoronoiDiagram_py::get_adaptive_precision)
+        .def("numSolved", &VoronoiDiagram_py::num_solved)
+        .def("numEscalations", &VoronoiDiagram_py::num_escalations)
+        .def("setQLLBestOnly", &VoronoiDiagram_py::set_qll_best_only)
+        .def("getQLLBestOnly", &VoronoiDiagram_py::get_qll_best_only)
+        .def("numQLLFallbacks", &VoronoiDiagram_py::num_qll_fallbacks)
         .staticmethod("reset_vertex_count")
         .def("getStat", &VoronoiDiagram_py::getStat)
+        .def("getTelemetry", &VoronoiDiagram_py::getTelemetry)
+        .def("resetTelemetry", &VoronoiDiagram_py::reset_telemetry)
+        .def("telemetryString", &VoronoiDiagram_py::telemetryString)
+        .def("setProfiling", &VoronoiDiagram_py::set_profiling)
+        .def("getProfiling", &VoronoiDiagram_py::get_profiling)
+        .def("setProfileTrace", &VoronoiDiagram_py::set_profile_trace)
+        .def("resetProfiler", &VoronoiDiagram_py::reset_profiler)
+        .def("profileJSON", &VoronoiDiagram_py::profileJSON)
+        .def("profileChromeTrace", &VoronoiDiagram_py::profileChromeTrace)
         .def("filterReset", &VoronoiDiagram_py::filter_reset)
         .def("getFaceStats", &VoronoiDiagram_py::getFaceStats)
         .def("getGraph", &VoronoiDiagram_py::get_graph_reference, bp::return_value_policy<bp::reference_existing_object>())
     ;
     
+    // arrays are exported with __array_interface__, so numpy.asarray() does not copy them
+    bp::class_<ArrayRef_py>("ArrayRef", bp::no_init)
+        .add_property("__array_interface__", &ArrayRef_py::array_interface)
+        .def("__len__", &ArrayRef_py::size)
+    ;
+    bp::class_<DiagramArrays_py>("DiagramArrays", bp::no_init)
+        .add_property("vertexXY", &DiagramArrays_py::vertex_xy) // (n,2) float64
+        .add_property("vertexClearance", &DiagramArrays_py::vertex_clearance) // (n) float64
+        .add_property("vertexTable", &DiagramArrays_py::vertex_table) // (n,3) int32: index, type, status
+        .add_property("edgeTable", &DiagramArrays_py::edge_table) // (m,6) int32: src, trg, twin, face, type, valid
+        .add_property("edgeOffsets", &DiagramArrays_py::edge_offsets) // (m+1) int32, into edgeXY
+        .add_property("edgeXY", &DiagramArrays_py::edge_xy) // (k,2) float64, the sampled edges
+        .def("numVertices", &DiagramArrays_py::num_vertices)
+        .def("numEdges", &DiagramArrays_py::num_edges)
+    ;
+    bp::enum_<InsertStatus>("InsertStatus")
+        .value("OK", INSERT_OK)
+        .value("BAD_HANDLE", INSERT_BAD_HANDLE)
+        .value("DUPLICATE", INSERT_DUPLICATE)
+    ;
     bp::enum_<VoronoiVertexStatus>("VoronoiVertexStatus")
         .value("OUT", OUT)   
         .value("IN", IN)
@@ -94,6 +153,28 @@ BOOST_PYTHON_MODULE(openvoronoi) {
         .value("APEX", APEX)
         .value("SPLIT", SPLIT)
     ;
+    bp::enum_<ValidationLevel>("ValidationLevel")
+        .value("NONE", VALIDATE_NONE)
+        .value("INCIDENT", VALIDATE_INCIDENT)
+        .value("FULL", VALIDATE_FULL)
+    ;
+    bp::enum_<SolverType>("SolverType")
+        .value("PPP", PPP_SOLVER)
+        .value("LLL", LLL_SOLVER)
+        .value("QLL", QLL_SOLVER)
+        .value("SEP", SEP_SOLVER)
+    ;
+    bp::enum_<SolverPrecision>("SolverPrecision")
+        .value("DOUBLE", PRECISION_DOUBLE)
+        .value("DD", PRECISION_DD)
+        .value("QD", PRECISION_QD)
+    ;
+    bp::enum_<SvgLayer>("SvgLayer") // combine with |, for SvgWriter.setLayers()
+        .value("SITES", SVG_SITES)
+        .value("BISECTORS", SVG_BISECTORS)
+        .value("OFFSETS", SVG_OFFSETS)
+        .value("MEDIAL_AXIS", SVG_MEDIAL_AXIS)
+    ;
     bp::enum_<VoronoiFaceStatus>("VoronoiFaceStatus")
         .value("INCIDENT", INCIDENT)
         .value("NONINCIDENT", NONINCIDENT)
@@ -108,6 +189,7 @@ BOOST_PYTHON_MODULE(openvoronoi) {
         .value("HYPERBOLA", HYPERBOLA)
         .value("SEPARATOR", SEPARATOR)
         .value("LINESITE", LINESITE)
+        .value("ARCSITE", ARCSITE)
         .value("NULLEDGE", NULLEDGE)
     ;
     bp::class_<Point>("Point") 
@@ -129,27 +211,56 @@ BOOST_PYTHON_MODULE(openvoronoi) {
         .def_readwrite("y", &Point::y)
         .def_pickle(point_pickle_suite())
     ;
+    // a filter result that does not modify the graph. The graph and the view
+    // must outlive the Offset, FaceOffset or MedialAxisWalk that uses them.
+    bp::class_<FilterView>("FilterView", bp::no_init)
+        .def(bp::init<HEGraph&>())
+        .def("reset", &FilterView::reset )
+        .def("numValid", &FilterView::num_valid )
+    ;
     bp::class_<Offset_py, boost::noncopyable >("Offset", bp::no_init)
         .def(bp::init<HEGraph&>())
+        .def(bp::init<HEGraph&, const FilterView&>())
         .def("str", &Offset_py::print )
         .def("offset", &Offset_py::offset_py )
+        .def("offset", &Offset_py::offset_levels_py ) // (list of distances) -> one list of loops per distance
     ; 
     bp::class_<FaceOffset_py, boost::noncopyable >("FaceOffset", bp::no_init)
         .def(bp::init<HEGraph&>())
+        .def(bp::init<HEGraph&, const FilterView&>())
         .def("offset", &FaceOffset_py::offset_py )
+        .def("offset", &FaceOffset_py::offset_levels_py ) // (list of distances) -> one list of loops per distance
         .def("str", &FaceOffset_py::print )
     ; 
     bp::class_<PolygonInterior, boost::noncopyable >("PolygonInterior", bp::no_init)
-        .def(bp::init<HEGraph&, bool>())
+        .def("__init__", bp::make_constructor(&polygon_interior_py) ) // (graph, side)
+        .def("__init__", bp::make_constructor(&polygon_interior_view_py) ) // (graph, side, view)
     ;
     bp::class_<MedialAxis, boost::noncopyable >("MedialAxis", bp::no_init)
-        .def(bp::init<HEGraph&>())
+        .def("__init__", bp::make_constructor(&medial_axis_py) ) // (graph)
+        .def("__init__", bp::make_constructor(&medial_axis_view_py) ) // (graph, view)
     ; 
-    bp::class_<MedialAxisWalk, boost::noncopyable >("MedialAxisWalk", bp::no_init)
+    bp::class_<MedialAxisWalk_py, boost::noncopyable >("MedialAxisWalk", bp::no_init)
         .def(bp::init<HEGraph&>())
-        .def("walk", &MedialAxisWalk::walk)
+        .def(bp::init<HEGraph&, const FilterView&>())
+        .def("walk", &MedialAxisWalk_py::walk_py)
     ;
     bp::class_<IslandFilter, boost::noncopyable >("IslandFilter", bp::no_init)
-        .def(bp::init<HEGraph&>())
+        .def("__init__", bp::make_constructor(&island_filter_py) ) // (graph)
+        .def("__init__", bp::make_constructor(&island_filter_view_py) ) // (graph, view)
     ; 
+    bp::class_<SvgWriter_py, boost::noncopyable >("SvgWriter", bp::no_init)
+        .def(bp::init<HEGraph&>())
+        .def("setSize", &SvgWriter_py::set_size ) // (width, height) in pixels
+        .def("setScale", &SvgWriter_py::set_scale ) // pixels per unit
+        .def("setOrigin", &SvgWriter_py::set_origin ) // the Point at the lower left corner
+        .def("setViewport", &SvgWriter_py::set_viewport ) // (min Point, max Point)
+        .def("setTolerance", &SvgWriter_py::set_tolerance ) // in pixels
+        .def("setLayers", &SvgWriter_py::set_layers )
+        .def("addOffset", &SvgWriter_py::add_offset )
+        .def("setMedialAxis", &SvgWriter_py::set_medial_axis, bp::with_custodian_and_ward<1,2>() ) // (FilterView)
+        .def("write", &SvgWriter_py::write_py ) // (filename)
+        .def("numWritten", &SvgWriter_py::num_written )
+        .def("numCulled", &SvgWriter_py::num_culled )
+    ;
 }
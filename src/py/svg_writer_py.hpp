@@ -0,0 +1,47 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SVG_WRITER_PY_HPP
+#define SVG_WRITER_PY_HPP
+
+#ifndef PYTHON_DWA2002810_HPP
+#include <boost/python.hpp>
+#endif
+
+#include "utility/svg_writer.hpp"
+#include "array_py.hpp"
+
+namespace ovd
+{
+
+/// \brief python wrapper for SvgWriter
+class SvgWriter_py : public SvgWriter {
+public:
+    SvgWriter_py(HEGraph& gi): SvgWriter(gi) { }
+    /// write the file with the GIL released
+    bool write_py(std::string filename) {
+        ScopedGILRelease nogil;
+        return write(filename);
+    }
+private:
+    SvgWriter_py(); // don't use.
+};
+
+} // end namespace
+#endif
+// end svg_writer_py.hpp
@@ -24,6 +24,8 @@
 #include "vertex.hpp"
 #include "facegrid.hpp"
 #include "common/numeric.hpp"
+#include "array_py.hpp"
+#include "diagram_arrays_py.hpp"
 
 using namespace ovd::numeric;
 
@@ -47,19 +49,69 @@ public:
         null_edge_offset=0.01;
     }
     
+    // the GIL is released while a site is inserted, see open_voronoi_py.cpp
     int insert_point_site1(const Point& p) {
+        ScopedGILRelease nogil;
         return insert_point_site(p);
     }
     int insert_point_site2(const Point& p, int step) {
+        ScopedGILRelease nogil;
         return insert_point_site(p,step);
     }
     
+    /// insert the rows of an (n,2) float64 array as point-sites, with the GIL released.
+    /// returns the handles as an array.array('i'), with -1 for points outside the far-radius.
+    boost::python::object insert_point_sites_py(boost::python::object xy) {
+        std::vector<Point> points = points_from_array(xy);
+        std::vector<int> handles;
+        {
+            ScopedGILRelease nogil;
+            handles = insert_point_sites(points);
+        }
+        return int_array(handles);
+    }
+    /// insert the rows of an (m,2) integer array of handles as line-sites, with the GIL released.
+    /// returns an InsertStatus for each segment, as an array.array('i').
+    boost::python::object insert_line_sites_py(boost::python::object segments) {
+        std::vector< std::pair<int,int> > pairs = pairs_from_array(segments);
+        std::vector<int> status;
+        {
+            ScopedGILRelease nogil;
+            status = insert_line_sites(pairs);
+        }
+        return int_array(status);
+    }
     bool insert_line_site2(int idx1, int idx2) {
+        ScopedGILRelease nogil;
         return insert_line_site( idx1, idx2);
     }
     bool insert_line_site3(int idx1, int idx2, int step) {
+        ScopedGILRelease nogil;
         return insert_line_site( idx1, idx2, step);
     }
+    bool insert_arc_site4(int idx1, int idx2, const Point& center, bool cw) {
+        ScopedGILRelease nogil;
+        return insert_arc_site( idx1, idx2, center, cw);
+    }
+    bool insert_arc_site5(int idx1, int idx2, const Point& center, bool cw, int step) {
+        ScopedGILRelease nogil;
+        return insert_arc_site( idx1, idx2, center, cw, step);
+    }
+    /// check() with the GIL released
+    bool check_py() {
+        ScopedGILRelease nogil;
+        return check();
+    }
+    /// save() with the GIL released
+    bool save_py(const std::string& filename) {
+        ScopedGILRelease nogil;
+        return save(filename);
+    }
+    /// load() with the GIL released
+    bool load_py(const std::string& filename) {
+        ScopedGILRelease nogil;
+        return load(filename);
+    }
     void set_null_edge_offset(double ofs) {
         null_edge_offset=ofs;
     }
@@ -86,6 +138,7 @@ public:
         }
         return plist;
     }
+    /// the worst dist_error values of the Telemetry, largest first
     boost::python::list getStat() {
         boost::python::list elist;
         BOOST_FOREACH( double  e, vpos->get_stat() ) {
@@ -93,6 +146,41 @@ public:
         }
         return elist;
     }
+    /// return the Telemetry to python, as a dict
+    boost::python::dict getTelemetry() {
+        const Telemetry& t = get_telemetry();
+        boost::python::dict d;
+        d["dist_error"] = histogram( t.dist_error );
+        d["edge_error"] = histogram( t.edge_error );
+        d["calls"] = table( t.calls );
+        d["solved"] = table( t.solved );
+        d["escalations"] = table( t.escalations );
+        d["qll_fallbacks"] = t.qll_fallbacks;
+        d["empty_solutions"] = t.empty_solutions;
+        d["desperate"] = t.desperate;
+        d["large_errors"] = t.large_errors;
+        boost::python::list worst;
+        for (unsigned int n=0; n<t.num_worst(); ++n) {
+            boost::python::list w;
+            w.append( t.worst(n).error );
+            w.append( t.worst(n).str() );
+            worst.append(w);
+        }
+        d["worst"] = worst;
+        return d;
+    }
+    /// the Telemetry as a string
+    std::string telemetryString() {
+        return get_telemetry().str();
+    }
+    /// the insertion Profiler as JSON
+    std::string profileJSON() {
+        return get_profiler().json();
+    }
+    /// the traced insertions in the Chrome trace event format
+    std::string profileChromeTrace() {
+        return get_profiler().chrome_trace();
+    }
     
     /// return list of vd vertices to python
     boost::python::list getVoronoiVertices()  {
@@ -121,6 +209,16 @@ public:
         }
         return plist;
     }
+    /// the vertices and edges as arrays for numpy, see DiagramArrays.
+    /// the arrays are built with the GIL released.
+    DiagramArrays_py get_arrays() {
+        boost::shared_ptr<DiagramArrays> arrays( new DiagramArrays() );
+        {
+            ScopedGILRelease nogil;
+            arrays->build(g, _edge_points);
+        }
+        return DiagramArrays_py(arrays);
+    }
     /// return list of the three special far-vertices to python
     boost::python::list getFarVoronoiVertices()  {
         boost::python::list plist;
@@ -149,7 +247,7 @@ public:
                      (g[edge].type == LINELINE)  || (g[edge].type == PARA_LINELINE)) {
                     point_list.append( g[v1].position );
                     point_list.append( g[v2].position );
-                } else if ( g[edge].type == PARABOLA ) { // these edge-types are drawn as polylines with edge_points number of points
+                } else if ( (g[edge].type == PARABOLA) || (g[edge].type == ELLIPSE) || (g[edge].type == HYPERBOLA) ) { // these edge-types are drawn as polylines with edge_points number of points
                     double t_src = g[v1].dist();
                     double t_trg = g[v2].dist();
                     double t_min = std::min(t_src,t_trg);
@@ -161,6 +259,8 @@ public:
                         point_list.append(pt);
                     }
                     
+                } else if ( g[edge].type == ARCSITE ) { // drawn as a polyline around the center of the arc
+                    arc_points( edge, point_list );
                 } else {
                     //assert(0);
                 } 
@@ -243,7 +343,7 @@ public:
                         }
                     }
                     
-                } else if ( g[edge].type == PARABOLA ) { // these edge-types are drawn as polylines with edge_points number of points
+                } else if ( (g[edge].type == PARABOLA) || (g[edge].type == ELLIPSE) || (g[edge].type == HYPERBOLA) ) { // these edge-types are drawn as polylines with edge_points number of points
                     double t_src = g[v1].dist();
                     double t_trg = g[v2].dist();
                     double t_min = std::min(t_src,t_trg);
@@ -255,6 +355,8 @@ public:
                         point_list.append(pt);
                     }
                     
+                } else if ( g[edge].type == ARCSITE ) { // drawn as a polyline around the center of the arc
+                    arc_points( edge, point_list );
                 } else {
                     //assert(0);
                 } 
@@ -338,6 +440,43 @@ public:
         return stats;
     }
 private:
+    /// the non-empty bins of an ErrorHistogram, as a list of [lower bound, count]
+    static boost::python::list histogram(const ErrorHistogram& h) {
+        boost::python::list bins;
+        for (unsigned int n=0; n<ErrorHistogram::n_bins; ++n) {
+            if ( h.count(n) ) {
+                boost::python::list b;
+                b.append( ErrorHistogram::lower(n) );
+                b.append( h.count(n) );
+                bins.append(b);
+            }
+        }
+        return bins;
+    }
+    /// a counter table of the Telemetry, as a list indexed by [SolverType][SolverPrecision]
+    static boost::python::list table(const unsigned long (&counts)[4][3]) {
+        boost::python::list rows;
+        for (unsigned int t=0; t<4; ++t) {
+            boost::python::list row;
+            for (unsigned int p=0; p<3; ++p)
+                row.append( counts[t][p] );
+            rows.append(row);
+        }
+        return rows;
+    }
+    /// append _edge_points points along an ARCSITE edge, from its source to its target
+    void arc_points(HEEdge edge, boost::python::list& point_list) {
+        Site* s = g[ g[edge].face ].site;
+        Point c( s->x(), s->y() );
+        Point p1 = g[ g.source(edge) ].position - c;
+        Point p2 = g[ g.target(edge) ].position - c;
+        double a1 = atan2( p1.y, p1.x );
+        double da = atan2( p1.cross(p2), p1.dot(p2) ); // arcs are less than a half-circle
+        for (int n=0;n< _edge_points;n++) {
+            double a = a1 + da*n/(_edge_points-1);
+            point_list.append( c + s->r()*Point( cos(a), sin(a) ) );
+        }
+    }
     int _edge_points; // number of points to plot on quadratic edges
     double null_edge_offset;
 };
@@ -195,10 +195,14 @@ protected:
     double r;
 };
 
+/// the kind of a Site. stored in the Site, so that isPoint() and isLine() do not need virtual calls
+enum SiteKind {SITE_POINT, SITE_LINE, SITE_ARC};
+
 /// Base-class for a voronoi-diagram site, or generator.
 class Site {
 public:
-    Site() {}
+    /// create a site of the given kind
+    Site(SiteKind k) : _kind(k) {}
     virtual ~Site() {}
     /// return closest point on site to given point p
     virtual Point apex_point(const Point& p) = 0;
@@ -265,8 +269,11 @@ public:
     
     virtual std::string str() const {assert(0); return "Site";}
     virtual std::string str2() const {assert(0); return "Site";}
-    inline virtual bool isPoint() const { return false;}
-    inline virtual bool isLine() const  { return false;}
+    /// the kind of this site
+    SiteKind kind() const { return _kind; }
+    bool isPoint() const { return _kind == SITE_POINT; }
+    bool isLine() const  { return _kind == SITE_LINE; }
+    bool isArc() const  { return _kind == SITE_ARC; }
     virtual bool in_region(const Point& ) const {
         std::cout << " WARNING: never call Site !\n";
         return false;
@@ -283,12 +290,14 @@ public:
     HEFace face;
 protected:
     Eq<double> eq;
+private:
+    SiteKind _kind;
 };
 
 /// point, or vertex site.
 class PointSite : public Site {
 public:
-    PointSite( const Point& p, HEFace f=0): _p(p) {
+    PointSite( const Point& p, HEFace f=0): Site(SITE_POINT), _p(p) {
         face = f;
         eq.q = true;
         eq.a = -2*p.x;
@@ -307,7 +316,6 @@ public:
     virtual double y() const {return _p.y;}
     virtual double r() const {return 0;}
     virtual double k() const {return 0;}
-    inline virtual bool isPoint() const {return true;}
     virtual std::string str() const {return "PointSite";}
     virtual std::string str2() const {
         std::string out = "PointSite: ";
@@ -317,7 +325,7 @@ public:
     virtual bool in_region(const Point& ) const {return true;}
     virtual double in_region_t(const Point& p) const {return -1;} 
 private:
-    PointSite() {} // don't use!
+    PointSite() : Site(SITE_POINT) {} // don't use!
     Point _p;
 };
 
@@ -325,7 +333,7 @@ private:
 class LineSite : public Site {
 public:
     /// create line-site between start and end Point.
-    LineSite( const Point& s, const Point& e, double koff, HEFace f = 0): _start(s), _end(e) {
+    LineSite( const Point& s, const Point& e, double koff, HEFace f = 0): Site(SITE_LINE), _start(s), _end(e) {
         face = f;
         eq.q = false;
         eq.a = _end.y - _start.y;
@@ -339,7 +347,7 @@ public:
         eq.c /= d;
         assert( fabs( eq.a*eq.a + eq.b*eq.b -1.0 ) < 1e-5);
     }
-    LineSite( Site& s ) {
+    LineSite( Site& s ) : Site(SITE_LINE) {
         eq = s.eqp();
         face = s.face;
         _start = s.start();
@@ -396,7 +404,6 @@ public:
         double t = s_p.dot(s_e) / s_e.dot(s_e);
         return t;
     }
-    inline virtual bool isLine() const {return true;}
     virtual double a() const { return eq.a; }
     virtual double b() const { return eq.b; }
     virtual double c() const { return eq.c; }
@@ -407,39 +414,107 @@ public:
     virtual const Point start() const {return _start;}
     virtual const Point end() const {return _end;}
 private:
-    LineSite() {} // don't use!
+    LineSite() : Site(SITE_LINE) {} // don't use!
     Point _start;
     Point _end;
 };
 
-/// arc or circle site
+/// arc site
+///
+/// a circular arc from start() to end() around center(), with an opening angle of less than 180 degrees.
+/// like a LineSite, an arc is inserted into the diagram as two sites:
+/// the k=+1 site on the convex side of the arc (outside the circle) and
+/// the k=-1 site on the concave side (inside the circle).
+/// the region of the arc is the cone from center() through the arc.
 class ArcSite : public Site {
 public:
-    ArcSite( const Point& s, const Point& e, const Point& center, bool dir): _start(s), _end(e), _center(center), _dir(dir) {
+    /// create arc-site from s to e around center. cw is true if the arc runs clockwise from s to e.
+    /// koff is the side of the arc, +1 outside and -1 inside the circle.
+    ArcSite( const Point& s, const Point& e, const Point& center, bool cw, double koff=+1, HEFace f=0): 
+        Site(SITE_ARC), _start(s), _end(e), _center(center), _cw(cw), _k(koff) {
+        face = f;
         _radius = (_center - _start).norm();
         eq.q = true;
         eq.a = -2*_center.x;
         eq.b = -2*_center.y;
-        eq.k = -2*_radius; 
+        eq.k = -2*_radius; // multiplied by the offset-direction in eqp()
         eq.c = _center.x*_center.x + _center.y*_center.y - _radius*_radius;
+        assert( (_k==1) || (_k==-1) );
     }
     ~ArcSite() {}
-    virtual Ofs* offset(Point p1,Point p2) {return new ArcOfs(p1,p2,_center,-1); } //FIXME: radius
-    Point apex_point(const Point& p) {
-        return p+Point(0,0); // FIXME
+    virtual Ofs* offset(Point p1,Point p2) {
+        return new ArcOfs(p1, p2, _center, (p1-_center).norm() ); 
+    }
+    /// closest point on the arc to given point p.
+    /// the projection of p onto the circle if p is in the region of the arc,
+    /// otherwise the closest end-point of the arc
+    virtual Point apex_point(const Point& p) {
+        if ( in_region(p) ) {
+            Point d = p - _center;
+            double n = d.norm();
+            if (n > 0)
+                return _center + (_radius/n)*d;
+            return _start; // all points of the arc are at the same distance from the center
+        }
+        if ( (p-_start).norm_sq() < (p-_end).norm_sq() )
+            return _start;
+        else
+            return _end;
+    }
+    virtual bool in_region(const Point& p) const {
+        double t = in_region_t(p);
+        return ( (t>=0) && (t<=1) );
+    }
+    /// the angle of p around the center, counted from the ccw start-point of the arc.
+    /// 0 at the ccw start-point and 1 at the ccw end-point.
+    virtual double in_region_t(const Point& p) const {
+        double t = in_region_t_raw(p);
+        double eps = 1e-7;
+        if (fabs(t) < eps)  // rounding, as in LineSite
+            t = 0.0;
+        else if ( fabs(t-1.0) < eps )
+            t = 1.0;
+        return t;
+    }
+    virtual double in_region_t_raw(const Point& p) const {
+        Point s = ccw_start() - _center;
+        Point e = ccw_end() - _center;
+        Point v = p - _center;
+        if ( v.norm() < 1e-9 )
+            return 0; // the center, where the k=-1 face ends, is in the region
+        double span = atan2( s.cross(e), s.dot(e) );
+        double ang = atan2( s.cross(v), s.dot(v) );
+        return ang/span;
     }
     virtual double x() const {return _center.x;}
     virtual double y() const {return _center.y;}
     virtual double r() const {return _radius;}
-    virtual double k() const {return 1;} // ?
+    virtual double k() const {return _k;}
+    virtual const Point start() const {return _start;}
+    virtual const Point end() const {return _end;}
+    /// center of the arc
+    Point center() const {return _center;}
+    /// true if the arc runs clockwise from start() to end()
+    bool cw() const {return _cw;}
+    /// start of the arc, when going counter-clockwise
+    Point ccw_start() const {return _cw ? _end : _start;}
+    /// end of the arc, when going counter-clockwise
+    Point ccw_end() const {return _cw ? _start : _end;}
     virtual std::string str() const {return "ArcSite";}
+    virtual std::string str2() const {
+        std::ostringstream o;
+        o << "ArcSite: " << _start << " - " << _end << " c=" << _center << " cw=" << _cw << " k=" << _k;
+        return o.str();
+    }
 private:
-    ArcSite() {} // don't use!
+    ArcSite() : Site(SITE_ARC) {} // don't use!
     Point _start;
     Point _end;
     Point _center;
-    bool _dir; // CW or CCW
-    double _radius; // redundant?
+    bool _cw;
+    /// offset direction, +1 outside and -1 inside the circle
+    double _k;
+    double _radius;
 };
 
 
@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ppp_batch.hpp"
+
+// the kernels must give the same results as PPPSolver<double>, so a*b+c must not be
+// contracted into a fused multiply-add. this file is compiled with -ffp-contract=off,
+// see src/CMakeLists.txt.
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define OVD_PPP_BATCH_X86
+#include <immintrin.h>
+#endif
+
+namespace ovd {
+
+typedef void (*PPPBatchKernel)(unsigned int, const double*, const double*, const double*, const double*, double*, double*);
+
+// triangles [begin, n) one at a time
+static void ppp_scalar(unsigned int begin, unsigned int n, const double* ax, const double* ay, 
+                       const double* bx, const double* by, double* ux, double* uy) {
+    for (unsigned int i=begin; i<n; i++) {
+        double a2 = ax[i]*ax[i] + ay[i]*ay[i];
+        double b2 = bx[i]*bx[i] + by[i]*by[i];
+        double j2 = (ay[i]*b2)/2.0 - (by[i]*a2)/2.0;
+        double j3 = (ax[i]*b2)/2.0 - (bx[i]*a2)/2.0;
+        double j4 = ax[i]*by[i] - bx[i]*ay[i];
+        ux[i] = -j2/j4;
+        uy[i] =  j3/j4;
+    }
+}
+
+static void ppp_batch_scalar(unsigned int n, const double* ax, const double* ay, 
+                             const double* bx, const double* by, double* ux, double* uy) {
+    ppp_scalar(0, n, ax, ay, bx, by, ux, uy);
+}
+
+#ifdef OVD_PPP_BATCH_X86
+// four triangles at a time
+__attribute__((target("avx2")))
+static void ppp_batch_avx2(unsigned int n, const double* ax, const double* ay, 
+                           const double* bx, const double* by, double* ux, double* uy) {
+    const __m256d two = _mm256_set1_pd(2.0);
+    unsigned int i = 0;
+    for ( ; i+4<=n; i+=4) {
+        __m256d vax = _mm256_loadu_pd(ax+i);
+        __m256d vay = _mm256_loadu_pd(ay+i);
+        __m256d vbx = _mm256_loadu_pd(bx+i);
+        __m256d vby = _mm256_loadu_pd(by+i);
+        __m256d a2 = _mm256_add_pd( _mm256_mul_pd(vax,vax), _mm256_mul_pd(vay,vay) );
+        __m256d b2 = _mm256_add_pd( _mm256_mul_pd(vbx,vbx), _mm256_mul_pd(vby,vby) );
+        __m256d j2 = _mm256_sub_pd( _mm256_div_pd( _mm256_mul_pd(vay,b2), two), _mm256_div_pd( _mm256_mul_pd(vby,a2), two) );
+        __m256d j3 = _mm256_sub_pd( _mm256_div_pd( _mm256_mul_pd(vax,b2), two), _mm256_div_pd( _mm256_mul_pd(vbx,a2), two) );
+        __m256d j4 = _mm256_sub_pd( _mm256_mul_pd(vax,vby), _mm256_mul_pd(vbx,vay) );
+        _mm256_storeu_pd( ux+i, _mm256_div_pd( _mm256_sub_pd(_mm256_setzero_pd(), j2), j4) );
+        _mm256_storeu_pd( uy+i, _mm256_div_pd( j3, j4) );
+    }
+    ppp_scalar(i, n, ax, ay, bx, by, ux, uy);
+}
+
+// eight triangles at a time
+__attribute__((target("avx512f")))
+static void ppp_batch_avx512(unsigned int n, const double* ax, const double* ay, 
+                             const double* bx, const double* by, double* ux, double* uy) {
+    const __m512d two = _mm512_set1_pd(2.0);
+    unsigned int i = 0;
+    for ( ; i+8<=n; i+=8) {
+        __m512d vax = _mm512_loadu_pd(ax+i);
+        __m512d vay = _mm512_loadu_pd(ay+i);
+        __m512d vbx = _mm512_loadu_pd(bx+i);
+        __m512d vby = _mm512_loadu_pd(by+i);
+        __m512d a2 = _mm512_add_pd( _mm512_mul_pd(vax,vax), _mm512_mul_pd(vay,vay) );
+        __m512d b2 = _mm512_add_pd( _mm512_mul_pd(vbx,vbx), _mm512_mul_pd(vby,vby) );
+        __m512d j2 = _mm512_sub_pd( _mm512_div_pd( _mm512_mul_pd(vay,b2), two), _mm512_div_pd( _mm512_mul_pd(vby,a2), two) );
+        __m512d j3 = _mm512_sub_pd( _mm512_div_pd( _mm512_mul_pd(vax,b2), two), _mm512_div_pd( _mm512_mul_pd(vbx,a2), two) );
+        __m512d j4 = _mm512_sub_pd( _mm512_mul_pd(vax,vby), _mm512_mul_pd(vbx,vay) );
+        _mm512_storeu_pd( ux+i, _mm512_div_pd( _mm512_sub_pd(_mm512_setzero_pd(), j2), j4) );
+        _mm512_storeu_pd( uy+i, _mm512_div_pd( j3, j4) );
+    }
+    ppp_batch_avx2(n-i, ax+i, ay+i, bx+i, by+i, ux+i, uy+i); // at most seven remain
+}
+#endif
+
+// pick the widest kernel that the CPU supports
+static PPPBatchKernel select_kernel(const char** name) {
+#ifdef OVD_PPP_BATCH_X86
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx512f") ) {
+        *name = "avx512f";
+        return ppp_batch_avx512;
+    }
+    if ( __builtin_cpu_supports("avx2") ) {
+        *name = "avx2";
+        return ppp_batch_avx2;
+    }
+#endif
+    *name = "scalar";
+    return ppp_batch_scalar;
+}
+
+static const char* kernel_name = 0;
+static const PPPBatchKernel kernel = select_kernel(&kernel_name);
+
+void ppp_batch(unsigned int n, const double* ax, const double* ay, 
+                               const double* bx, const double* by, 
+                               double* ux, double* uy) {
+    kernel(n, ax, ay, bx, by, ux, uy);
+}
+
+const char* ppp_batch_kernel() {
+    return kernel_name;
+}
+
+} // ovd
@@ -0,0 +1,42 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PPP_BATCH_HPP
+#define PPP_BATCH_HPP
+
+namespace ovd {
+
+/// \brief circumcenters of a batch of n point-point-point triangles, in double.
+///
+/// triangle i has corners a, b, c. The input is given relative to c, as
+/// (ax[i],ay[i]) = a-c and (bx[i],by[i]) = b-c. The output (ux[i],uy[i]) is 
+/// the circumcenter relative to c. This is the same computation as in PPPSolver<double>.
+///
+/// On x86 the batch is computed with AVX-512 or AVX2 when the CPU supports it, with 
+/// a scalar loop for the tail. Other CPUs use the scalar loop only. 
+/// All versions give identical results, since they do the same operations in the same order.
+void ppp_batch(unsigned int n, const double* ax, const double* ay, 
+                               const double* bx, const double* by, 
+                               double* ux, double* uy);
+
+/// name of the kernel that ppp_batch() uses on this CPU: "avx512f", "avx2", or "scalar"
+const char* ppp_batch_kernel();
+
+} // ovd
+#endif
@@ -30,6 +30,7 @@ class Site;
 // the input to the solver is three Sites (s1,s2,s3) and three offset-directions (k1,k2,k3) .
 class Solver {
 public:
+    virtual ~Solver() {}
     virtual int solve(Site* s1, double k1, 
                            Site* s2, double k2, 
                            Site* s3, double k3, std::vector<Solution>& slns ) {return 0;}
@@ -33,6 +33,8 @@ namespace ovd {
 
 /// line-line-line vertex positioner.
 /// solves 3x3 system.
+/// Scalar is the number type used for the computation, e.g. double or qd_real
+template<class Scalar>
 class LLLSolver : public Solver {
 public:
 
@@ -54,25 +56,25 @@ int solve( Site* s1, double k1,
            Site* s3, double k3, std::vector<Solution>& slns ) {
     assert( s1->isLine() && s2->isLine() && s3->isLine() );
     
-    std::vector< Eq<qd_real> > eq; // equation-parameters, in quad-precision
+    boost::array< Eq<Scalar>, 3 > eq; // equation-parameters, in Scalar-precision
     boost::array<Site*,3> sites = {{s1,s2,s3}};    
     boost::array<double,3> kvals = {{k1,k2,k3}};
     for (unsigned int i=0;i<3;i++)
-        eq.push_back( sites[i]->eqp_qd( kvals[i] ) );
+        eq[i] = sites[i]->eqp( kvals[i] );
     
     unsigned int i = 0, j=1, k=2;
-    qd_real d = chop( determinant( eq[i].a, eq[i].b, eq[i].k, 
+    Scalar d = chop( determinant( eq[i].a, eq[i].b, eq[i].k, 
                                             eq[j].a, eq[j].b, eq[j].k, 
                                             eq[k].a, eq[k].b, eq[k].k ) ); 
     if (d != 0) {
-        qd_real t = determinant(  eq[i].a, eq[i].b, -eq[i].c, 
+        Scalar t = determinant(  eq[i].a, eq[i].b, -eq[i].c, 
                                   eq[j].a, eq[j].b, -eq[j].c, 
                                   eq[k].a, eq[k].b, -eq[k].c ) / d ; 
         if (t >= 0) {
-            qd_real sol_x = determinant(  -eq[i].c, eq[i].b, eq[i].k, 
+            Scalar sol_x = determinant(  -eq[i].c, eq[i].b, eq[i].k, 
                                           -eq[j].c, eq[j].b, eq[j].k, 
                                           -eq[k].c, eq[k].b, eq[k].k ) / d ; 
-            qd_real sol_y = determinant(  eq[i].a, -eq[i].c, eq[i].k, 
+            Scalar sol_y = determinant(  eq[i].a, -eq[i].c, eq[i].k, 
                                           eq[j].a, -eq[j].c, eq[j].k, 
                                           eq[k].a, -eq[k].c, eq[k].k ) / d ; 
             slns.push_back( Solution( Point( to_double(sol_x), to_double(sol_y) ), to_double(t), k3 ) ); // kk3 just passes through without any effect!?
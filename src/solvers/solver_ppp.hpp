@@ -35,6 +35,7 @@ using namespace ovd::numeric; // sq() chop()
 namespace ovd {
 
 // templated point-class, so we can use qd_real as the coordinate type.
+// to_double() returns the solution coordinates as double type.
 template<class Scalar>
 struct scalar_pt {
     scalar_pt<Scalar>() : x(0), y(0) {}
@@ -42,54 +43,25 @@ struct scalar_pt {
     
     Scalar x;
     Scalar y;
-    double getx() {
-        return x;
-    }
-    double gety() {
-        return y;
-    }
-    
-    scalar_pt<Scalar> &operator=(const Point& p) {
-        x = p.x;
-        y = p.y;
-        return *this;
-    }
-};
-
-// with the qd_real number-type we need to_double() to get the solution coordinates as double type.
-
-template<>
-struct scalar_pt<qd_real> {
-    scalar_pt<qd_real>() : x(qd_real(0)), y(qd_real(0)) {}
-    scalar_pt<qd_real>(qd_real xi, qd_real yi) : x(xi), y(yi) {}
-    
-    qd_real x;
-    qd_real y;
     double getx() {
         return to_double(x);
     }
     double gety() {
         return to_double(y);
     }
-    scalar_pt<qd_real> &operator=(const Point& p) {
+    
+    scalar_pt<Scalar> &operator=(const Point& p) {
         x = p.x;
         y = p.y;
         return *this;
     }
 };
 
-
-/// point-point-point vertex positioner based on Sugihara & Iri paper
-template<class Scalar>
-class PPPSolver : public Solver {
-public:
-
-int solve( Site* s1, Site* s2, Site* s3,  std::vector<Solution>& slns ) {
-    assert( s1->isPoint() && s2->isPoint() && s3->isPoint() );
-    Point pi = s1->position();
-    Point pj = s2->position();
-    Point pk = s3->position();
-    
+/// order the corners of a point-point-point triangle for the circumcenter computation.
+/// 1) pi, pj, pk counter-clockwise
+/// 2) pk opposite the longest side, i.e. at the largest angle
+/// used by PPPSolver and by VertexPositioner for ppp_batch()
+inline void ppp_order(Point& pi, Point& pj, Point& pk) {
     if ( pi.is_right(pj,pk) ) 
         std::swap(pi,pj);
     assert( !pi.is_right(pj,pk) );
@@ -103,6 +75,19 @@ int solve( Site* s1, Site* s2, Site* s3,  std::vector<Solution>& slns ) {
     assert( !pi.is_right(pj,pk) );
     assert( (pi - pj).norm() >=  (pj - pk).norm() );
     assert( (pi - pj).norm() >=  (pk - pi).norm() );
+}
+
+/// point-point-point vertex positioner based on Sugihara & Iri paper
+template<class Scalar>
+class PPPSolver : public Solver {
+public:
+
+int solve( Site* s1, Site* s2, Site* s3,  std::vector<Solution>& slns ) {
+    assert( s1->isPoint() && s2->isPoint() && s3->isPoint() );
+    Point pi = s1->position();
+    Point pj = s2->position();
+    Point pk = s3->position();
+    ppp_order(pi,pj,pk);
     
     // we now convert to a higher precision number-type to do the calculations
     scalar_pt<Scalar> spi,spj,spk;
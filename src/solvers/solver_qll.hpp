@@ -33,80 +33,116 @@ using namespace ovd::numeric; // sq() chop() quadratic_roots()
 
 namespace ovd {
 
-/// point-point-point vertex positioner based on Sugihara & Iri paper
+/// quadratic-linear-linear vertex positioner based on Sugihara & Iri paper
+/// Scalar is the number type used for the computation, e.g. double or qd_real
+///
+/// the two linear equations are solved for two of the unknowns (x,y,t) in terms of 
+/// the third, which is then found from the quadratic equation. By default all three
+/// choices are tried, and all candidate solutions returned. With best_only=true only
+/// the choice with the best-conditioned 2x2 system is solved.
+template<class Scalar>
 class QLLSolver : public Solver {
 public:
+/// \param best_only solve only the best-conditioned permutation, see best_permutation()
+QLLSolver(bool best_only=false) : best_only_(best_only) {}
 
 int solve( Site* s1, double k1, 
                 Site* s2, double k2, 
                 Site* s3, double k3, std::vector<Solution>& solns ) {
-    std::vector< Eq<qd_real> > quads,lins; // equation-parameters, in quad-precision
+    boost::array< Eq<Scalar>, 3 > quads,lins; // equation-parameters, in Scalar-precision
+    unsigned int n_quads = 0, n_lins = 0;
     boost::array<Site*,3> sites = {{s1,s2,s3}};
     boost::array<double,3> kvals = {{k1,k2,k3}};
     for (unsigned int i=0;i<3;i++) {
-        Eq<qd_real> eqn = sites[i]->eqp_qd( kvals[i] );
+        Eq<Scalar> eqn;
+        eqn = sites[i]->eqp( kvals[i] );
         if (sites[i]->is_linear() ) // store site-equations in lins or quads
-            lins.push_back( eqn ); 
+            lins[n_lins++] = eqn; 
         else
-            quads.push_back( eqn );
+            quads[n_quads++] = eqn;
     }
-    assert( !quads.empty() );
+    assert( n_quads > 0 );
     
-    if ( lins.size()==1 || lins.size() == 0 ) {
-        assert( quads.size() == 3 || quads.size() == 2 );
-        for (unsigned int i=1;i<quads.size();i++) {
+    if ( n_lins==1 || n_lins == 0 ) {
+        assert( n_quads == 3 || n_quads == 2 );
+        for (unsigned int i=1;i<n_quads;i++) {
             quads[i] = quads[i] - quads[0]; // subtract the first quad from the other one(s), to create new linear eqn(s)
-            lins.push_back(quads[i]);
+            lins[n_lins++] = quads[i];
         }
     }
-    assert( lins.size() == 2);  // At this point, we should have exactly two linear equations.
+    assert( n_lins == 2);  // At this point, we should have exactly two linear equations.
    
-    // TODO:  pick the solution appraoch with the best numerical stability.    
-    // call all three permutations
     // index shuffling determines if we solve:
     // x and y in terms of t
     // y and t in terms of x
     // t and x in terms of y
-    qll_solver( lins, 0, 1, 2, quads[0], k3, solns);
-    qll_solver( lins, 2, 0, 1, quads[0], k3, solns);
-    qll_solver( lins, 1, 2, 0, quads[0], k3, solns);
-    
+    if (best_only_) {
+        int p = best_permutation(lins);
+        qll_solver( lins, perm[p][0], perm[p][1], perm[p][2], quads[0], k3, solns);
+    } else { // call all three permutations
+        for (int p=0;p<3;p++)
+            qll_solver( lins, perm[p][0], perm[p][1], perm[p][2], quads[0], k3, solns);
+    }
     return solns.size();
 }
 
 
 private:
+/// the (xi,yi,ti) index permutations
+static const int perm[3][3];
+/// only solve the best-conditioned permutation
+bool best_only_;
+
+/// return the permutation for which the 2x2 system of the linear equations
+/// is best conditioned, i.e. the rows are closest to perpendicular.
+int best_permutation(const boost::array< Eq<Scalar>, 3 >& lins) const {
+    int best = 0;
+    double best_cond = -1;
+    for (int p=0;p<3;p++) {
+        double ai = to_double( lins[0][ perm[p][0] ] );
+        double bi = to_double( lins[0][ perm[p][1] ] );
+        double aj = to_double( lins[1][ perm[p][0] ] );
+        double bj = to_double( lins[1][ perm[p][1] ] );
+        double norms = sqrt( (ai*ai+bi*bi)*(aj*aj+bj*bj) );
+        double cond = (norms > 0) ? fabs(ai*bj - aj*bi) / norms : 0; // |sin| of the angle between the rows
+        if ( cond > best_cond ) {
+            best_cond = cond;
+            best = p;
+        }
+    }
+    return best;
+}
+
 // l0 first linear eqn
 // l1 second linear eqn
 // xi,yi,ti  indexes to shuffle around
 // xk, yk, kk, rk = params of one ('last') quadratic site (point or arc)
 // solns = output solution triplets (x,y,t) or (u,v,t)
 // returns number of solutions found
-int qll_solver( const std::vector< Eq<qd_real> >& lins, int xi, int yi, int ti, 
-      const Eq<qd_real>& quad, qd_real k3, std::vector<Solution>& solns) { 
-    assert( lins.size() == 2 );
-    qd_real ai = lins[0][xi]; // first linear 
-    qd_real bi = lins[0][yi];
-    qd_real ki = lins[0][ti];
-    qd_real ci = lins[0].c;
+int qll_solver( const boost::array< Eq<Scalar>, 3 >& lins, int xi, int yi, int ti, 
+      const Eq<Scalar>& quad, Scalar k3, std::vector<Solution>& solns) { 
+    Scalar ai = lins[0][xi]; // first linear 
+    Scalar bi = lins[0][yi];
+    Scalar ki = lins[0][ti];
+    Scalar ci = lins[0].c;
     
-    qd_real aj = lins[1][xi]; // second linear
-    qd_real bj = lins[1][yi];
-    qd_real kj = lins[1][ti];
-    qd_real cj = lins[1].c;
+    Scalar aj = lins[1][xi]; // second linear
+    Scalar bj = lins[1][yi];
+    Scalar kj = lins[1][ti];
+    Scalar cj = lins[1].c;
     
-    qd_real d = chop( ai*bj - aj*bi ); // chop! (determinant for 2 linear eqns (?))
+    Scalar d = chop( ai*bj - aj*bi ); // chop! (determinant for 2 linear eqns (?))
     if (d == 0) // no solution can be found!
         return -1;
     // these are the w-equations for qll_solve()
     // (2) u = a1 w + b1
     // (3) v = a2 w + b2
-    qd_real a0 =  (bi*kj - bj*ki) / d;
-    qd_real a1 = -(ai*kj - aj*ki) / d;
-    qd_real b0 =  (bi*cj - bj*ci) / d;
-    qd_real b1 = -(ai*cj - aj*ci) / d;
+    Scalar a0 =  (bi*kj - bj*ki) / d;
+    Scalar a1 = -(ai*kj - aj*ki) / d;
+    Scalar b0 =  (bi*cj - bj*ci) / d;
+    Scalar b1 = -(ai*cj - aj*ci) / d;
     // based on the 'last' quadratic of (s1,s2,s3)
-    qd_real aargs[3][2];
+    Scalar aargs[3][2];
     aargs[0][0] = 1.0;
     aargs[0][1] = quad.a;
     aargs[1][0] = 1.0;
@@ -114,7 +150,7 @@ int qll_solver( const std::vector< Eq<qd_real> >& lins, int xi, int yi, int ti,
     aargs[2][0] = -1.0;
     aargs[2][1] = quad.k;
     
-    qd_real isolns[2][3];
+    Scalar isolns[2][3];
     // this solves for w, and returns either 0, 1, or 2 triplets of (u,v,t) in isolns
     // NOTE: indexes of aargs shuffled depending on (xi,yi,ti) !
     int scount = qll_solve( aargs[xi][0], aargs[xi][1],
@@ -142,33 +178,32 @@ int qll_solver( const std::vector< Eq<qd_real> >& lins, int xi, int yi, int ti,
 /// (3) v = a2 w + b2
 /// solve (1) for w (can have 0, 1, or 2 roots)
 /// then substitute into (2) and (3) to find (u, v, t)
-int qll_solve( qd_real a0, qd_real b0, qd_real c0, qd_real d0, 
-                      qd_real e0, qd_real f0, qd_real g0, 
-                      qd_real a1, qd_real b1, 
-                      qd_real a2, qd_real b2, 
-                      qd_real soln[][3])
+int qll_solve( Scalar a0, Scalar b0, Scalar c0, Scalar d0, 
+                      Scalar e0, Scalar f0, Scalar g0, 
+                      Scalar a1, Scalar b1, 
+                      Scalar a2, Scalar b2, 
+                      Scalar soln[][3])
 {
     //std::cout << "qll_solver()\n";
     // TODO:  optimize using abs(a0) == abs(c0) == abs(d0) == 1
-    qd_real a = chop( (a0*(a1*a1) + c0*(a2*a2) + e0) ); 
-    qd_real b = chop( (2*a0*a1*b1 + 2*a2*b2*c0 + a1*b0 + a2*d0 + f0) ); 
-    qd_real c = a0*(b1*b1) + c0*(b2*b2) + b0*b1 + b2*d0 + g0;
-    std::vector<qd_real> roots = quadratic_roots(a, b, c); // solves a*w^2 + b*w + c = 0
-    if ( roots.empty() ) { // No roots, no solutions
-        return 0;
-    } else {
-        for (unsigned int i=0; i<roots.size(); i++) {
-            qd_real w = roots[i];
-            soln[i][0] = a1*w + b1; // u
-            soln[i][1] = a2*w + b2; // v
-            soln[i][2] = w;         // t
-        }
-        return roots.size();
+    Scalar a = chop( (a0*(a1*a1) + c0*(a2*a2) + e0) ); 
+    Scalar b = chop( (2*a0*a1*b1 + 2*a2*b2*c0 + a1*b0 + a2*d0 + f0) ); 
+    Scalar c = a0*(b1*b1) + c0*(b2*b2) + b0*b1 + b2*d0 + g0;
+    Scalar roots[2];
+    int n_roots = quadratic_roots(a, b, c, roots); // solves a*w^2 + b*w + c = 0
+    for (int i=0; i<n_roots; i++) {
+        Scalar w = roots[i];
+        soln[i][0] = a1*w + b1; // u
+        soln[i][1] = a2*w + b2; // v
+        soln[i][2] = w;         // t
     }
+    return n_roots;
 }
 
 };
 
+template<class Scalar>
+const int QLLSolver<Scalar>::perm[3][3] = { {0,1,2}, {2,0,1}, {1,2,0} };
 
 } // ovd
 #endif
@@ -34,10 +34,15 @@ int solve( Site* s1, double k1,
            Site* s2, double k2, 
            Site* s3, double k3, std::vector<Solution>& slns ) {
 
-    assert( s1->isLine() && s2->isPoint() );
+    assert( !s1->isPoint() && s2->isPoint() );
     // separator direction
     Point sv(0,0);
-    if (k2 == -1) {
+    if ( s1->isArc() ) {
+        // radial, away from the center on the outside (k1=+1), towards it on the inside (k1=-1)
+        sv = Point( s2->x() - s1->x(), s2->y() - s1->y() );
+        sv.normalize();
+        sv = k1*sv;
+    } else if (k2 == -1) {
         sv.x = s1->a(); //l1.a
         sv.y = s1->b(); //l1.b
     } else {
@@ -53,6 +58,11 @@ int solve( Site* s1, double k1,
 
     } else if (s3->isLine()) {
         tsln = -(s3->a()*s2->x()+s3->b()*s2->y()+s3->c()) / ( sv.x*s3->a() + sv.y*s3->b() + k3  );
+    } else if (s3->isArc()) {
+        // |s2 + t*sv - c3| = r3 + k3*t
+        double dx = s2->x() - s3->x();
+        double dy = s2->y() - s3->y();
+        tsln = ( sq(s3->r()) - (dx*dx+dy*dy) ) / ( 2*( dx*sv.x+dy*sv.y - k3*s3->r() ) );
     } else {
         assert(0);
         exit(-1);
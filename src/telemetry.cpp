@@ -0,0 +1,133 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+
+#include "telemetry.hpp"
+
+namespace ovd {
+
+void ErrorHistogram::add(double err) {
+    unsigned int bin = 0;
+    if ( err >= 1e-18 ) {
+        int decade = (int)floor( log10(err) ) + 19;
+        bin = std::max( 1, std::min( decade, (int)n_bins-1 ) );
+    }
+    bins[bin]++;
+    n++;
+    if ( err > max_value )
+        max_value = err;
+}
+
+void ErrorHistogram::reset() {
+    bins.assign(0);
+    n = 0;
+    max_value = 0;
+}
+
+double ErrorHistogram::lower(unsigned int bin) {
+    if (bin == 0)
+        return 0;
+    return pow(10.0, (int)bin-19);
+}
+
+SiteRecord::SiteRecord(Site* s) : kind( s->kind() ), p1(0,0), p2(0,0), center(0,0), k(0) {
+    if ( s->isPoint() ) {
+        p1 = s->position();
+    } else {
+        p1 = s->start();
+        p2 = s->end();
+        k = s->k();
+        if ( s->isArc() )
+            center = Point( s->x(), s->y() );
+    }
+}
+
+std::string SiteRecord::str() const {
+    std::ostringstream o;
+    o.precision(17);
+    if (kind == SITE_POINT)
+        o << "PointSite " << p1;
+    else if (kind == SITE_LINE)
+        o << "LineSite " << p1 << " - " << p2 << " k=" << k;
+    else
+        o << "ArcSite " << p1 << " - " << p2 << " c=" << center << " k=" << k;
+    return o.str();
+}
+
+std::string TripleRecord::str() const {
+    std::ostringstream o;
+    o.precision(17);
+    o << "s1= " << s1.str() << " (k=" << k1 << ")\n";
+    o << "s2= " << s2.str() << " (k=" << k2 << ")\n";
+    o << "s3= " << s3.str() << "\n";
+    o << "solution " << solution.p << " t=" << solution.t << " k3=" << solution.k3 << " dist_error=" << error << "\n";
+    return o.str();
+}
+
+void Telemetry::reset() {
+    dist_error.reset();
+    edge_error.reset();
+    for (int t=0;t<4;t++) {
+        for (int p=0;p<3;p++) {
+            calls[t][p] = 0;
+            solved[t][p] = 0;
+            escalations[t][p] = 0;
+        }
+    }
+    qll_fallbacks = 0;
+    empty_solutions = 0;
+    desperate = 0;
+    large_errors = 0;
+    n_worst = 0;
+}
+
+// insertion into the sorted array
+void Telemetry::add_worst(const TripleRecord& t) {
+    if ( !is_worst(t.error) )
+        return;
+    unsigned int n = (n_worst < max_worst) ? n_worst++ : max_worst-1;
+    while ( n > 0 && worst_triples[n-1].error < t.error ) {
+        worst_triples[n] = worst_triples[n-1];
+        n--;
+    }
+    worst_triples[n] = t;
+}
+
+std::string Telemetry::str() const {
+    const char* solver[4] = {"PPP", "LLL", "QLL", "SEP"};
+    std::ostringstream o;
+    o << "Telemetry: " << dist_error.total() << " vertices positioned\n";
+    o << " solver  calls(double dd qd)  solved(double dd qd)  escalations(double dd)\n";
+    for (int t=0;t<4;t++) {
+        o << " " << solver[t] << "  " << calls[t][0] << " " << calls[t][1] << " " << calls[t][2];
+        o << "  " << solved[t][0] << " " << solved[t][1] << " " << solved[t][2];
+        o << "  " << escalations[t][0] << " " << escalations[t][1] << "\n";
+    }
+    o << " qll fallbacks " << qll_fallbacks << ", empty solution sets " << empty_solutions;
+    o << ", desperate solutions " << desperate << ", dist_error>1e-9 " << large_errors << "\n";
+    o << " max dist_error " << dist_error.max() << ", max edge_error " << edge_error.max() << "\n";
+    for (unsigned int n=0;n<n_worst;n++)
+        o << worst_triples[n].str();
+    return o.str();
+}
+
+} // end namespace
@@ -0,0 +1,141 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <string>
+
+#include <boost/array.hpp>
+
+#include "common/point.hpp"
+#include "site.hpp"
+#include "solvers/solution.hpp"
+
+namespace ovd {
+
+/// \brief histogram of error values, one bin per decade
+///
+/// bin 0 counts errors below 1e-18 (including zero), 
+/// bin k (1..18) counts errors in [1e(k-19), 1e(k-18) ), and
+/// the last bin counts errors of 1 or more.
+class ErrorHistogram {
+public:
+    /// number of bins
+    static const unsigned int n_bins = 20;
+    ErrorHistogram() { reset(); }
+    /// add an error value
+    void add(double err);
+    /// set all counts to zero
+    void reset();
+    /// number of values in bin
+    unsigned long count(unsigned int bin) const { return bins[bin]; }
+    /// lower limit of bin. zero for bin 0.
+    static double lower(unsigned int bin);
+    /// number of values added
+    unsigned long total() const { return n; }
+    /// the largest value added
+    double max() const { return max_value; }
+private:
+    boost::array<unsigned long, n_bins> bins;
+    unsigned long n;
+    double max_value;
+};
+
+/// the geometry of a Site, for replaying a vertex position computation
+struct SiteRecord {
+    SiteRecord() : kind(SITE_POINT), p1(0,0), p2(0,0), center(0,0), k(0) {}
+    SiteRecord(Site* s);
+    SiteKind kind;
+    /// position of a point-site, start of a line-site or arc-site
+    Point p1;
+    /// end of a line-site or arc-site
+    Point p2;
+    /// center of an arc-site
+    Point center;
+    /// offset-direction of a line-site or arc-site
+    double k;
+    std::string str() const;
+};
+
+/// a vertex position computation: the edge-sites s1 and s2, the new site s3,
+/// the solution and its dist_error
+struct TripleRecord {
+    TripleRecord() : k1(0), k2(0), solution(Point(0,0),0,0), error(0) {}
+    SiteRecord s1;
+    double k1;
+    SiteRecord s2;
+    double k2;
+    SiteRecord s3;
+    Solution solution;
+    double error;
+    std::string str() const;
+};
+
+/// \brief numerical health of the vertex positioning in VertexPositioner
+///
+/// all storage is of fixed size, independent of the number of sites.
+/// VertexPositioner records into this only when the library is compiled without
+/// OVD_NO_TELEMETRY. With OVD_NO_TELEMETRY all counts stay zero.
+class Telemetry {
+public:
+    /// the number of worst triples that are kept
+    static const unsigned int max_worst = 8;
+    Telemetry() { reset(); }
+    /// set everything to zero
+    void reset();
+    /// true if a computation with this error would be kept in the worst triples
+    bool is_worst(double error) const { 
+        return n_worst < max_worst || error > worst_triples[n_worst-1].error; 
+    }
+    /// keep the triple if it is among the max_worst largest errors
+    void add_worst(const TripleRecord& t);
+    /// number of kept worst triples
+    unsigned int num_worst() const { return n_worst; }
+    /// worst triple n, sorted by decreasing error
+    const TripleRecord& worst(unsigned int n) const { return worst_triples[n]; }
+    /// print a summary
+    std::string str() const;
+    
+    /// dist_error() of every positioned vertex
+    ErrorHistogram dist_error;
+    /// edge-error (distance from the solution to the edge) of every positioned vertex
+    ErrorHistogram edge_error;
+    /// solver calls [SolverType][SolverPrecision]
+    unsigned long calls[4][3];
+    /// vertices positioned [SolverType][SolverPrecision]
+    unsigned long solved[4][3];
+    /// adaptive precision: solutions rejected by dist_error() [SolverType][SolverPrecision]
+    unsigned long escalations[4][3];
+    /// best-conditioned QLLSolver eliminations that gave no admissible solution
+    unsigned long qll_fallbacks;
+    /// solution sets that were empty after filtering
+    unsigned long empty_solutions;
+    /// desperate solutions, returned when no admissible solution was found
+    unsigned long desperate;
+    /// solutions with dist_error larger than 1e-9
+    unsigned long large_errors;
+private:
+    boost::array<TripleRecord, max_worst> worst_triples;
+    unsigned int n_worst;
+};
+
+} // end namespace
+#endif
+// end telemetry.hpp
@@ -0,0 +1,52 @@
+import openvoronoi as ovd
+
+import sys
+import pickle
+import gzip
+
+# build the diagram of random line-segments with and without adaptive precision,
+# and with only the best-conditioned elimination in the QLL solver.
+# all diagrams should pass check() and have the same number of vertices.
+def build(segs, adaptive, qll_best=False):
+    vd = ovd.VoronoiDiagram(1,120)
+    vd.setAdaptivePrecision(adaptive)
+    vd.setQLLBestOnly(qll_best)
+    id_list = []
+    for seg in segs:
+        seg_id=[]
+        seg_id.append( vd.addVertexSite( seg[0] ) )
+        seg_id.append( vd.addVertexSite( seg[1] ) )
+        id_list.append( seg_id )
+    for s in id_list:
+        vd.addLineSite(s[0],s[1])
+    return vd
+
+if __name__ == "__main__":  
+    Nmax  = int(sys.argv[1])
+    print "adaptive_precision.py:  ",Nmax," random segments."
+    sys.stdout.flush()
+    filename = "../src/test/data/randomsegments_{0}.pickle.gz".format(Nmax) #  load pre-computed segments 
+    f = gzip.open(filename, 'rb')
+    pstring = f.read()
+    segs = pickle.loads( pstring )
+    f.close()
+
+    vd_qd = build(segs, False)
+    vd_ad = build(segs, True)
+    vd_qb = build(segs, False, True)
+    c = vd_qd.check() and vd_ad.check() and vd_qb.check()
+    print " VD check: ", c
+    print " vertices: ", vd_qd.numVertices(), vd_ad.numVertices(), vd_qb.numVertices()
+    print " QLL fallbacks: ", vd_qb.numQLLFallbacks()
+    for t in [ovd.SolverType.PPP, ovd.SolverType.LLL, ovd.SolverType.QLL, ovd.SolverType.SEP]:
+        print " ",t," solved: ",
+        print [vd_ad.numSolved(t,p) for p in [ovd.SolverPrecision.DOUBLE, ovd.SolverPrecision.DD, ovd.SolverPrecision.QD]],
+        print " escalations: ",
+        print [vd_ad.numEscalations(t,p) for p in [ovd.SolverPrecision.DOUBLE, ovd.SolverPrecision.DD]]
+    print vd_ad.telemetryString()
+    tel = vd_ad.getTelemetry()
+    c = c and (tel["desperate"] == 0) and (tel["large_errors"] == 0)
+    if c and (vd_qd.numVertices() == vd_ad.numVertices()) and (vd_qd.numVertices() == vd_qb.numVertices()):
+        exit(0)
+    else:
+        exit(-1)
@@ -0,0 +1,52 @@
+import openvoronoi as ovd
+import math
+import sys
+
+# this test inserts a rounded rectangle: four line-sites joined by four quarter-circle
+# arc-sites, with tangent joins, and N points inside it.
+# the arcs are inserted before the lines when ORDER is 0, and after the lines when ORDER is 1.
+#
+# call with arc_sites.py ORDER N
+
+if __name__ == "__main__":
+    order = int(sys.argv[1])
+    Nmax = int(sys.argv[2])
+    print "arc_sites.py ORDER=",order," N=",Nmax
+    vd = ovd.VoronoiDiagram(1,120)
+    vd.setValidation(ovd.ValidationLevel.INCIDENT)
+    (x0, x1, y0, y1, r) = (-0.41, 0.37, -0.23, 0.29, 0.08)
+    centers = [ (x1-r,y1-r), (x0+r,y1-r), (x0+r,y0+r), (x1-r,y0+r) ]
+    # points on a grid inside the rectangle
+    n = int(math.sqrt(Nmax))
+    for i in range(n):
+        for j in range(n):
+            vd.addVertexSite( ovd.Point( x0+2*r+(x1-x0-4*r)*(i+0.5)/n, y0+2*r+(y1-y0-4*r)*(j+0.5)/n ) )
+    # the end-points of the arcs, counter-clockwise
+    ids = []
+    for m in range(4):
+        (cx, cy) = centers[m]
+        a0 = m*math.pi/2
+        ids.append( vd.addVertexSite( ovd.Point( cx+r*math.cos(a0), cy+r*math.sin(a0) ) ) )
+        ids.append( vd.addVertexSite( ovd.Point( cx+r*math.cos(a0+math.pi/2), cy+r*math.sin(a0+math.pi/2) ) ) )
+    def add_arcs():
+        for m in range(4):
+            vd.addArcSite( ids[2*m], ids[2*m+1], ovd.Point(centers[m][0],centers[m][1]), False )
+    def add_lines():
+        for m in range(4):
+            vd.addLineSite( ids[2*m+1], ids[(2*m+2)%8] )
+    if order == 0:
+        add_arcs()
+        add_lines()
+    else:
+        add_lines()
+        add_arcs()
+
+    c = vd.check()
+    print " VD check: ", c
+    print " arc-sites: ", vd.numArcSites(), " line-sites: ", vd.numLineSites()
+    print " validation failures: ", vd.numValidationFailures()
+    c = c and (vd.numArcSites() == 4) and (vd.numLineSites() == 4) and (vd.numValidationFailures() == 0)
+    if c:
+        exit(0)
+    else:
+        exit(-1)
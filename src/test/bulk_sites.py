@@ -0,0 +1,58 @@
+import openvoronoi as ovd
+import array
+import math
+import random
+import sys
+
+# this test inserts N random points with addVertexSites(), then a polygon of M
+# vertices with addVertexSites() and addLineSites().
+# points outside the far-radius or with NaN/inf coordinates, two segments with bad handles,
+# and two segments that repeat a polygon edge, must be skipped.
+#
+# call with bulk_sites.py N M
+
+if __name__ == "__main__":
+    Nmax = int(sys.argv[1])
+    Mmax = int(sys.argv[2])
+    print "bulk_sites.py N=",Nmax," M=",Mmax
+    random.seed(42)
+    vd = ovd.VoronoiDiagram(1,120)
+    vd.setValidation(ovd.ValidationLevel.INCIDENT)
+    # random points inside the polygon, and points outside the far-radius or not finite
+    xy = array.array('d')
+    for n in range(Nmax):
+        xy.extend( [ random.uniform(-0.3,0.3), random.uniform(-0.3,0.3) ] )
+    bad_xy = [ [2.0, 0.0], [float('nan'), 0.0], [0.0, float('inf')], [-1e300, 1e300] ]
+    for p in bad_xy:
+        xy.extend( p )
+    handles = vd.addVertexSites(xy)
+    # a polygon, clockwise
+    poly = array.array('d')
+    for m in range(Mmax):
+        a = -2*math.pi*m/Mmax
+        poly.extend( [ 0.5*math.cos(a), 0.5*math.sin(a) ] )
+    poly_handles = vd.addVertexSites(poly)
+    segs = array.array('i')
+    for m in range(Mmax):
+        segs.extend( [ poly_handles[m], poly_handles[(m+1)%Mmax] ] )
+    segs.extend( [ poly_handles[0], poly_handles[0] ] ) # the same end-points
+    segs.extend( [ poly_handles[0], -1 ] ) # not a handle
+    segs.extend( [ poly_handles[1], poly_handles[2] ] ) # already inserted
+    segs.extend( [ poly_handles[3], poly_handles[2] ] ) # already inserted, in the other direction
+    status = vd.addLineSites(segs)
+
+    c = vd.check()
+    print " VD check: ", c
+    print " point-sites: ", vd.numPointSites(), " line-sites: ", vd.numLineSites()
+    print " validation failures: ", vd.numValidationFailures()
+    n_ok = len( [s for s in status if s == int(ovd.InsertStatus.OK)] )
+    n_bad = len( [s for s in status if s == int(ovd.InsertStatus.BAD_HANDLE)] )
+    n_dup = len( [s for s in status if s == int(ovd.InsertStatus.DUPLICATE)] )
+    print " segments inserted: ", n_ok, " bad handles: ", n_bad, " duplicates: ", n_dup
+    c = c and (len(handles) == Nmax+len(bad_xy)) and (max(handles[Nmax:]) == -1) and (min(handles[:Nmax]) >= 0)
+    c = c and (vd.numPointSites() == Nmax+Mmax) and (vd.numLineSites() == Mmax)
+    c = c and (n_ok == Mmax) and (n_bad == 2) and (n_dup == 2) and (vd.numValidationFailures() == 0)
+    if c:
+        exit(0)
+    else:
+        exit(-1)
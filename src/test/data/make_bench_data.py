@@ -0,0 +1,78 @@
+import pickle
+import gzip
+import struct
+import sys
+
+# write the datasets used by the C++ benchmark ovd_bench (see src/bench/ovd_bench.cpp)
+# in its binary chain format. All numbers are little-endian:
+#   char[4]  "OVDC"
+#   uint32   version (1)
+#   uint32   number of chains
+#   for each chain:
+#     uint32   number of points
+#     uint32   1 if the chain is a closed polygon, 0 otherwise
+#     float64  x, y  for each point
+#
+# randomsegments_N.pickle.gz  ->  randomsegments_N.bin   (one open chain per segment)
+# ttt_alphabet.bin, glyph outlines as closed chains, if the ttt module is available
+#
+# call with make_bench_data.py [N1 N2 ...]  in this directory.
+# openvoronoi is not needed, the pickled ovd.Point objects are read as (x,y) tuples.
+
+class PointUnpickler(pickle.Unpickler):
+    def find_class(self, module, name):
+        if module == "openvoronoi" and name == "Point":
+            return lambda x, y: (x, y)
+        return pickle.Unpickler.find_class(self, module, name)
+
+def write_chains(filename, chains, closed):
+    f = open(filename, "wb")
+    f.write(b"OVDC")
+    f.write(struct.pack("<II", 1, len(chains)))
+    for chain in chains:
+        f.write(struct.pack("<II", len(chain), closed))
+        for p in chain:
+            f.write(struct.pack("<dd", p[0], p[1]))
+    f.close()
+    print(" wrote {0}, {1} chains".format(filename, len(chains)))
+
+def convert_segments(n):
+    f = gzip.open("randomsegments_{0}.pickle.gz".format(n), "rb")
+    segs = PointUnpickler(f).load()
+    f.close()
+    write_chains("randomsegments_{0}.bin".format(n), segs, 0)
+
+def ttt_outlines():
+    import ttt
+    scale = 25000
+    chains = []
+    rows = [ ("ABCDEFGHIJKLM", 0.05), ("NOPQRSTUVWXYZ", -0.05), ("abcdefghijklm", -0.15),
+             ("nopqrstuvwxyz", -0.22), ("0123456789+-*/", -0.32) ]
+    for (text, y) in rows:
+        wr = ttt.SEG_Writer()
+        wr.arc = False
+        wr.conic = False
+        wr.cubic = False
+        wr.conic_line_subdivision = 200
+        wr.cubic_line_subdivision = 10
+        wr.scale = float(1)/float(scale)
+        ttt.ttt(text, wr)
+        dx = float(50000)/float(scale)
+        for seg in wr.get_segments():
+            # the same placement as in ttt_alphabet.py
+            poly = [ (p[0] - 0.3*dx, p[1] + y*dx) for p in seg ]
+            poly.pop() # the last point repeats the first
+            poly.reverse()
+            chains.append(poly)
+    write_chains("ttt_alphabet.bin", chains, 1)
+
+if __name__ == "__main__":
+    sizes = [128, 256, 512, 1024, 2048, 4096]
+    if len(sys.argv) > 1:
+        sizes = [ int(a) for a in sys.argv[1:] ]
+    for n in sizes:
+        convert_segments(n)
+    try:
+        ttt_outlines()
+    except ImportError:
+        print(" ttt not found, ttt_alphabet.bin not written")
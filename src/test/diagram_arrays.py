@@ -0,0 +1,73 @@
+import openvoronoi as ovd
+import ctypes
+import math
+import random
+import sys
+
+# this test compares the arrays of getArrays() with getVoronoiVertices() and getVoronoiEdges()
+# for a polygon of M line-sites with N random points inside.
+# the arrays are read through their __array_interface__ with ctypes, so numpy is not required.
+#
+# call with diagram_arrays.py N M
+
+# the shape of the array, and its elements as a flat ctypes array
+def flat(ref):
+    ai = ref.__array_interface__
+    n = 1
+    for s in ai['shape']:
+        n = n*s
+    if ai['typestr'][1:] == 'f8':
+        ct = ctypes.c_double
+    else:
+        ct = ctypes.c_int32
+    return ai['shape'], (ct*n).from_address( ai['data'][0] )
+
+if __name__ == "__main__":
+    Nmax = int(sys.argv[1])
+    Mmax = int(sys.argv[2])
+    print "diagram_arrays.py N=",Nmax," M=",Mmax
+    random.seed(42)
+    vd = ovd.VoronoiDiagram(1,120)
+    ids = []
+    for m in range(Mmax):
+        a = -2*math.pi*m/Mmax
+        ids.append( vd.addVertexSite( ovd.Point( 0.5*math.cos(a), 0.5*math.sin(a) ) ) )
+    for n in range(Nmax):
+        vd.addVertexSite( ovd.Point( random.uniform(-0.3,0.3), random.uniform(-0.3,0.3) ) )
+    for m in range(Mmax):
+        vd.addLineSite( ids[m], ids[(m+1)%Mmax] )
+
+    arrays = vd.getArrays()
+    (vshape, clearance) = flat( arrays.vertexClearance )
+    (tshape, vtable) = flat( arrays.vertexTable )
+    (eshape, etable) = flat( arrays.edgeTable )
+    (oshape, offsets) = flat( arrays.edgeOffsets )
+    (pshape, xy) = flat( arrays.edgeXY )
+
+    errors = 0
+    verts = vd.getVoronoiVertices()
+    if len(verts) != vshape[0] or tshape != (vshape[0],3):
+        errors = errors + 1
+    for n in range( min(len(verts), vshape[0]) ):
+        if verts[n][1] != clearance[n] or verts[n][3] != vtable[3*n]:
+            errors = errors + 1
+    edges = vd.getVoronoiEdges()
+    if len(edges) != eshape[0] or oshape[0] != eshape[0]+1 or offsets[eshape[0]] != pshape[0]:
+        errors = errors + 1
+    for k in range( min(len(edges), eshape[0]) ):
+        pts = edges[k][0]
+        if len(pts) != offsets[k+1]-offsets[k] or int(edges[k][1]) != etable[6*k+4]:
+            errors = errors + 1
+            continue
+        for j in range(len(pts)):
+            if pts[j].x != xy[ 2*(offsets[k]+j) ] or pts[j].y != xy[ 2*(offsets[k]+j)+1 ]:
+                errors = errors + 1
+        twin = etable[6*k+2]
+        if twin >= 0 and ( etable[6*twin+2] != k or etable[6*twin] != etable[6*k+1] ):
+            errors = errors + 1
+    print " vertices: ", vshape[0], " edges: ", eshape[0], " points: ", pshape[0]
+    print " errors: ", errors
+    if vd.check() and errors == 0:
+        exit(0)
+    else:
+        exit(-1)
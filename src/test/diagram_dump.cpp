@@ -0,0 +1,98 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// build a diagram and write a canonical description of it to a file.
+// the test is built twice, once with boost::listS and once with hedi::flatS
+// as the vertex container (OVD_FLAT_GRAPH), and the two files are compared.
+//
+// usage: diagram_dump <output file> <number of points>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+#include <boost/foreach.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include "voronoidiagram.hpp"
+
+using namespace ovd;
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "usage: diagram_dump <output file> <number of points>\n";
+        return -1;
+    }
+    unsigned int n_points = 1000;
+    if (argc > 2)
+        n_points = atoi(argv[2]);
+
+    // random points inside a square of line-sites
+    boost::random::mt19937 rng(42);
+    boost::random::uniform_real_distribution<double> coord(-0.5, 0.5);
+    VoronoiDiagram vd(1, 10);
+    std::vector<int> corners;
+    corners.push_back( vd.insert_point_site( Point(-0.6,-0.6) ) );
+    corners.push_back( vd.insert_point_site( Point( 0.6,-0.6) ) );
+    corners.push_back( vd.insert_point_site( Point( 0.6, 0.6) ) );
+    corners.push_back( vd.insert_point_site( Point(-0.6, 0.6) ) );
+    std::vector<Point> pts;
+    for (unsigned int m=0; m<n_points; ++m) {
+        double x = coord(rng);
+        double y = coord(rng);
+        pts.push_back( Point(x,y) );
+    }
+    vd.insert_point_sites(pts);
+    for (unsigned int m=0; m<corners.size(); ++m)
+        vd.insert_line_site( corners[m], corners[(m+1)%corners.size()] );
+    if ( !vd.check() ) {
+        std::cout << "diagram failed check()\n";
+        return -1;
+    }
+
+    // one line per vertex and per edge, sorted so that the
+    // iteration order of the graph containers does not matter.
+    HEGraph& g = vd.get_graph_reference();
+    std::vector<std::string> lines;
+    BOOST_FOREACH( HEVertex v, g.vertices() ) {
+        std::ostringstream s;
+        s.precision(17);
+        s << "v " << g[v].index << " " << g[v].type << " " << g[v].position.x << " " << g[v].position.y << " " << g[v].dist();
+        lines.push_back( s.str() );
+    }
+    BOOST_FOREACH( HEEdge e, g.edges() ) {
+        std::ostringstream s;
+        s << "e " << g[ g.source(e) ].index << " " << g[ g.target(e) ].index << " " << g[e].type;
+        lines.push_back( s.str() );
+    }
+    std::sort( lines.begin(), lines.end() );
+
+    std::ofstream out( argv[1] );
+    out << vd.num_vertices() << " " << vd.num_faces() << "\n";
+    BOOST_FOREACH( const std::string& line, lines ) {
+        out << line << "\n";
+    }
+    std::cout << vd.num_vertices() << " vertices written to " << argv[1] << "\n";
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// queries on a DiagramFileView must agree with the diagram that was saved:
+// face_edges() must walk as many edges as the face has in the diagram, and
+// find_point_face() must return the face of the closest point-site, found by a
+// search over all faces, in a diagram of points only and after line-sites are added.
+//
+// usage: diagram_file_view <number of points>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include "voronoidiagram.hpp"
+#include "diagram_file.hpp"
+
+using namespace ovd;
+
+int errors = 0;
+
+// the number of edges on face f, by following next-pointers in the diagram
+unsigned int num_face_edges(HEGraph& g, HEFace f) {
+    unsigned int n = 0;
+    HEEdge current = g[f].edge;
+    do {
+        n++;
+        current = g[current].next;
+    } while ( current != g[f].edge );
+    return n;
+}
+
+// the point-site face closest to p, by a search over all faces
+int closest_point_face(const DiagramFileView& view, const Point& p) {
+    int closest = -1;
+    double closest_dist = 0;
+    for (unsigned int f=0; f<view.num_faces(); ++f) {
+        FileFace ff = view.face(f);
+        if ( ff.site_kind == SITE_POINT && ( closest < 0 || DiagramFileView::site_distance(ff, p) < closest_dist ) ) {
+            closest_dist = DiagramFileView::site_distance(ff, p);
+            closest = f;
+        }
+    }
+    return closest;
+}
+
+// save vd, and query the file through a view
+void check_view(VoronoiDiagram& vd, const std::string& name, boost::random::mt19937& rng) {
+    const std::string filename = "diagram_file_view.ovd";
+    if ( !vd.save(filename) ) {
+        std::cout << " " << name << ": save() failed\n";
+        errors++;
+        return;
+    }
+    std::ifstream in( filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate );
+    std::vector<char> bytes( (std::size_t)in.tellg() );
+    in.seekg(0);
+    in.read( &bytes[0], bytes.size() );
+    DiagramFileView view;
+    if ( !view.open( &bytes[0], bytes.size() ) || !view.check_references() ) {
+        std::cout << " " << name << ": " << view.error() << "\n";
+        errors++;
+        return;
+    }
+
+    HEGraph& g = vd.get_graph_reference();
+    std::vector<unsigned int> edges;
+    for (HEFace f=0; f<g.num_faces(); ++f) {
+        view.face_edges(f, edges);
+        bool same = ( edges.size() == num_face_edges(g, f) );
+        for (unsigned int n=0; same && n<edges.size(); ++n)
+            same = ( view.edge(edges[n]).face == f );
+        if ( !same ) {
+            std::cout << " " << name << ": face_edges(" << f << ") has " << edges.size() << " edges, expected " << num_face_edges(g, f) << "\n";
+            errors++;
+        }
+    }
+
+    boost::random::uniform_real_distribution<double> coord(-0.7, 0.7);
+    for (int n=0; n<1000; ++n) {
+        Point p( coord(rng), coord(rng) );
+        int f = view.find_point_face(p);
+        int expected = closest_point_face(view, p);
+        if ( f != expected ) {
+            std::cout << " " << name << ": find_point_face(" << p << ") = " << f << ", expected " << expected << "\n";
+            errors++;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int n_points = 1000;
+    if (argc > 1)
+        n_points = atoi(argv[1]);
+
+    boost::random::mt19937 rng(11);
+    boost::random::uniform_real_distribution<double> coord(-0.5, 0.5);
+    VoronoiDiagram vd(1, 10);
+    std::vector<int> corners;
+    corners.push_back( vd.insert_point_site( Point(-0.6,-0.6) ) );
+    corners.push_back( vd.insert_point_site( Point( 0.6,-0.6) ) );
+    corners.push_back( vd.insert_point_site( Point( 0.6, 0.6) ) );
+    corners.push_back( vd.insert_point_site( Point(-0.6, 0.6) ) );
+    for (unsigned int m=0; m<n_points; ++m)
+        vd.insert_point_site( Point( coord(rng), coord(rng) ) );
+    check_view(vd, "points", rng);
+
+    for (unsigned int m=0; m<corners.size(); ++m)
+        vd.insert_line_site( corners[m], corners[(m+1)%corners.size()] );
+    check_view(vd, "points and a square", rng);
+    std::remove( "diagram_file_view.ovd" );
+
+    std::cout << n_points << " points, " << errors << " errors\n";
+    if (errors)
+        return -1;
+    return 0;
+}
@@ -0,0 +1,200 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// run offsets with different filters on one diagram in parallel threads, each
+// with its own FilterView, and check that the offsets are identical to offsets
+// after filtering the diagram in place with filter_graph(). The threads must
+// leave the valid-property of the diagram unchanged. A MedialAxisWalk with a
+// FilterView must walk the same chains as after in-place filtering.
+//
+// usage: filter_views <number of filters> <number of points>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include <boost/thread.hpp>
+#include <boost/foreach.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include "voronoidiagram.hpp"
+#include "offset.hpp"
+#include "filter_view.hpp"
+#include "medial_axis.hpp"
+
+using namespace ovd;
+
+// keep the edges where both end-points have a clearance-disk smaller than max_dist
+struct clearance_filter {
+    clearance_filter(HEGraph& gi, double d) : g(gi), max_dist(d) {}
+    bool operator()(const HEEdge& e) const {
+        return (g[ g.source(e) ].dist() < max_dist) && (g[ g.target(e) ].dist() < max_dist);
+    }
+private:
+    HEGraph& g;
+    double max_dist;
+};
+
+// the offsets at the distances ts, as text
+std::string offset_text(Offset& o, const std::vector<double>& ts) {
+    std::ostringstream s;
+    s.precision(17);
+    BOOST_FOREACH( const OffsetLevel& level, o.offset(ts) ) {
+        s << "t=" << level.t << " loops=" << level.loops.size() << "\n";
+        BOOST_FOREACH( const OffsetLoop& loop, level.loops ) {
+            BOOST_FOREACH( const OffsetVertex& ov, loop ) {
+                s << ov.p.x << " " << ov.p.y << " " << ov.r << " " << ov.cw << "\n";
+            }
+        }
+    }
+    return s.str();
+}
+
+// the chains of a medial-axis walk, as text
+std::string walk_text(MedialAxisWalk& w) {
+    std::ostringstream s;
+    s.precision(17);
+    MedialChainList chains = w.walk();
+    BOOST_FOREACH( const MedialChain& chain, chains ) {
+        s << "chain " << chain.size() << "\n";
+        BOOST_FOREACH( const MedialPointList& edge, chain ) {
+            BOOST_FOREACH( const MedialPoint& mp, edge ) {
+                s << mp.p.x << " " << mp.p.y << " " << mp.clearance << "\n";
+            }
+        }
+    }
+    return s.str();
+}
+
+// filter number n into its own view, and produce offsets
+void view_offsets(HEGraph* g, double max_dist, const std::vector<double>* ts, std::string* out) {
+    FilterView view(*g);
+    view.filter( clearance_filter(*g, max_dist) );
+    Offset o(*g, view);
+    *out = offset_text(o, *ts);
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int n_filters = 8;
+    unsigned int n_points = 1000;
+    if (argc > 1)
+        n_filters = atoi(argv[1]);
+    if (argc > 2)
+        n_points = atoi(argv[2]);
+
+    boost::random::mt19937 rng(42);
+    boost::random::uniform_real_distribution<double> coord(-0.5, 0.5);
+    VoronoiDiagram vd(1, 10);
+    std::vector<int> corners;
+    corners.push_back( vd.insert_point_site( Point(-0.6,-0.6) ) );
+    corners.push_back( vd.insert_point_site( Point( 0.6,-0.6) ) );
+    corners.push_back( vd.insert_point_site( Point( 0.6, 0.6) ) );
+    corners.push_back( vd.insert_point_site( Point(-0.6, 0.6) ) );
+    std::vector<Point> pts;
+    for (unsigned int m=0; m<n_points; ++m) {
+        double x = coord(rng);
+        double y = coord(rng);
+        pts.push_back( Point(x,y) );
+    }
+    vd.insert_point_sites(pts);
+    FilterView early_view( vd.get_graph_reference() ); // out of date after the line-sites
+    for (unsigned int m=0; m<corners.size(); ++m)
+        vd.insert_line_site( corners[m], corners[(m+1)%corners.size()] );
+    HEGraph& g = vd.get_graph_reference();
+
+    std::vector<double> ts;
+    for (unsigned int m=1; m<=10; ++m)
+        ts.push_back( 0.005*m );
+    std::vector<double> max_dist;
+    for (unsigned int n=0; n<n_filters; ++n)
+        max_dist.push_back( 0.01 + 0.05*n/n_filters );
+
+    std::vector<std::string> in_place(n_filters);
+    for (unsigned int n=0; n<n_filters; ++n) {
+        g.filter_graph( clearance_filter(g, max_dist[n]) );
+        Offset o(g);
+        in_place[n] = offset_text(o, ts);
+        g.filter_reset();
+    }
+
+    std::vector<std::string> threaded(n_filters);
+    boost::thread_group threads;
+    for (unsigned int n=0; n<n_filters; ++n)
+        threads.add_thread( new boost::thread( &view_offsets, &g, max_dist[n], &ts, &threaded[n] ) );
+    threads.join_all();
+
+    int errors = 0;
+    bool stale = !early_view.up_to_date();
+    early_view.reset();
+    if ( !stale || !early_view.up_to_date() ) {
+        std::cout << " a FilterView created before an insertion is not out of date, or not up to date after reset()\n";
+        errors++;
+    }
+    // the views hold edge_index_bound() bits, which stays below two per edge
+    if ( g.edge_index_bound() > 2*g.num_edges() ) {
+        std::cout << " edge_index_bound()=" << g.edge_index_bound() << " for " << g.num_edges() << " edges\n";
+        errors++;
+    }
+    std::vector<bool> index_used( g.edge_index_bound(), false );
+    BOOST_FOREACH( HEEdge e, g.edges() ) {
+        if ( g[e].index >= index_used.size() || index_used[ g[e].index ] ) {
+            std::cout << " edge index " << g[e].index << " is out of range or not unique\n";
+            errors++;
+            break;
+        }
+        index_used[ g[e].index ] = true;
+    }
+    for (unsigned int n=0; n<n_filters; ++n) {
+        if ( in_place[n] != threaded[n] ) {
+            std::cout << " filter " << n << " offsets with a FilterView differ from offsets after filter_graph()\n";
+            errors++;
+        }
+    }
+
+    FilterView medial_view(g);
+    MedialAxis medial(g, medial_view);
+    MedialAxisWalk view_walk(g, medial_view);
+    std::string view_chains = walk_text(view_walk);
+    if ( walk_text(view_walk) != view_chains ) {
+        std::cout << " a second walk() with the same FilterView gave different chains\n";
+        errors++;
+    }
+    BOOST_FOREACH( HEEdge e, g.edges() ) {
+        if ( !g[e].valid ) {
+            std::cout << " a FilterView modified the valid-property of the diagram\n";
+            errors++;
+            break;
+        }
+    }
+    MedialAxis medial_in_place(g);
+    MedialAxisWalk walk(g);
+    if ( walk_text(walk) != view_chains ) {
+        std::cout << " medial-axis walk with a FilterView differs from walk after filter_graph()\n";
+        errors++;
+    }
+    g.filter_reset();
+
+    std::cout << n_filters << " filters on " << n_points << " points, " << errors << " errors\n";
+    if (errors)
+        return -1;
+    return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// the in-circle predicate must give the exact sign for near-cocircular inputs.
+// the inputs are integers and rounded square roots of integers, so that the 
+// exact sign can be computed with (128-bit) integer arithmetic.
+//
+// usage: in_circle <number of random cases>
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include "common/predicates.hpp"
+
+using namespace ovd;
+
+int errors = 0;
+int stages[4] = {0,0,0,0};
+
+void expect(const Point& c, double r, const Point& p, int sign) {
+    predicates::PredicateResult h = predicates::in_circle(c, r, p);
+    stages[h.stage]++;
+    if ( h.sign != sign || (h.value > 0) != (sign > 0) || (h.value < 0) != (sign < 0) ) {
+        std::cout.precision(17);
+        std::cout << " c=" << c << " r=" << r << " p=" << p << " sign=" << h.sign 
+                  << " value=" << h.value << " stage=" << h.stage << ", expected sign=" << sign << "\n";
+        errors++;
+    }
+}
+
+__extension__ typedef __int128 int128;
+
+int sign_of(int128 x) {
+    return (x > 0) - (x < 0);
+}
+
+// the exact sign of dx*dx + dy*dy - r*r, for integers dx and dy, and r = m*2^k
+int exact_sign(long long dx, long long dy, double r) {
+    int k;
+    double f = frexp(r, &k);
+    long long m = (long long)ldexp(f, 53);
+    k -= 53;
+    int128 s = (int128)dx*dx + (int128)dy*dy;
+    if (k >= 0)
+        return sign_of( s - ( ((int128)m*m) << (2*k) ) );
+    return sign_of( (s << (-2*k)) - (int128)m*m );
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int n_cases = 10000;
+    if (argc > 1)
+        n_cases = atoi(argv[1]);
+
+    // exactly on the circle: 3-4-5 triangles
+    expect( Point(0,0), 5, Point(3,4), 0 );
+    expect( Point(1024,-2048), 5, Point(1021,-2044), 0 );
+    expect( Point(0.5,0.25), 5*ldexp(1.0,-30), Point(0.5+3*ldexp(1.0,-30), 0.25-4*ldexp(1.0,-30)), 0 );
+    // the radius one ulp too large or too small
+    expect( Point(0,0), nextafter(5.0,6.0), Point(3,4), -1 );
+    expect( Point(0,0), nextafter(5.0,4.0), Point(3,4), +1 );
+    // p one ulp off the circle
+    expect( Point(0,0), 5, Point(nextafter(3.0,4.0),4), +1 );
+    expect( Point(0,0), 5, Point(3,nextafter(4.0,3.0)), -1 );
+    // dx*dx - r*r cancels in dd_real, the sign is given by dy*dy only
+    double r_edge = nextafter(1.0,0.0);
+    expect( Point(0,0), r_edge, Point(r_edge, ldexp(1.0,-80)), +1 );
+    expect( Point(0,0), r_edge, Point(r_edge, 0), 0 );
+    expect( Point(0,0), r_edge, Point(nextafter(r_edge,0.0), ldexp(1.0,-80)), -1 );
+
+    // random near-cocircular inputs. r is sqrt(dx*dx+dy*dy) rounded to double,
+    // or a few ulps away from it, or exactly on the circle (a pythagorean triple).
+    boost::random::mt19937 rng(1);
+    boost::random::uniform_int_distribution<long long> center(-(1LL<<31), 1LL<<31);
+    boost::random::uniform_int_distribution<long long> delta(-(1LL<<30), 1LL<<30);
+    boost::random::uniform_int_distribution<long long> triple(1, 1LL<<15);
+    boost::random::uniform_int_distribution<int> ulps(-3, 3);
+    boost::random::uniform_int_distribution<int> exponent(-60, 10);
+    for (unsigned int n=0; n<n_cases; ++n) {
+        long long cx = center(rng);
+        long long cy = center(rng);
+        long long dx, dy;
+        double r;
+        if (n%4 == 0) {
+            long long a = triple(rng);
+            long long b = triple(rng);
+            dx = a*a - b*b;
+            dy = 2*a*b;
+            r = (double)(a*a + b*b);
+        } else {
+            dx = delta(rng);
+            dy = delta(rng);
+            r = sqrt( (double)dx*dx + (double)dy*dy );
+        }
+        int u = ulps(rng);
+        for (; u>0; --u) 
+            r = nextafter(r, 2*r+1);
+        for (; u<0; ++u) 
+            r = nextafter(r, 0.0);
+        int sign = exact_sign(dx, dy, r);
+        int e = exponent(rng); // scaling by a power of two does not change the sign
+        expect( Point( ldexp((double)cx,e), ldexp((double)cy,e) ), ldexp(r,e), 
+                Point( ldexp((double)(cx+dx),e), ldexp((double)(cy+dy),e) ), sign );
+    }
+    std::cout << n_cases << " random cases, stages: " << stages[1] << " double, " << stages[2] 
+              << " dd_real, " << stages[3] << " exact. " << errors << " errors\n";
+    if (errors)
+        return -1;
+    return 0;
+}
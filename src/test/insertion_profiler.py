@@ -0,0 +1,45 @@
+import openvoronoi as ovd
+import random
+import math
+import json
+import sys
+
+# this test profiles the insertion of N random points and N/4 random line-segments,
+# and checks that the JSON and Chrome trace exports count every insertion
+#
+# call with insertion_profiler.py N
+
+def randomPoint(far):
+    pradius = 0.5*(1.0/math.sqrt(2))*far
+    x=-pradius+2*pradius*random.random()
+    y=-pradius+2*pradius*random.random()
+    return ovd.Point(x,y)
+
+if __name__ == "__main__":
+    Nmax = int(sys.argv[1])
+    random.seed(1)
+    print "insertion_profiler.py N=",Nmax
+    vd = ovd.VoronoiDiagram(1,120)
+    vd.setProfiling(True)
+    vd.setProfileTrace(True)
+    for n in range(Nmax):
+        vd.addVertexSite( randomPoint(1) )
+    # a square of line-sites around the points
+    corners = [ vd.addVertexSite( ovd.Point(x,y) ) for (x,y) in [(-0.6,-0.6),(0.6,-0.6),(0.6,0.6),(-0.6,0.6)] ]
+    for n in range(4):
+        vd.addLineSite( corners[n], corners[(n+1)%4] )
+
+    c = vd.check()
+    print " VD check: ", c
+    prof = json.loads( vd.profileJSON() )
+    trace = json.loads( vd.profileChromeTrace() )
+    print " point insertions: ", prof["point"]["insertions"], " line insertions: ", prof["line"]["insertions"]
+    print " trace events: ", len(trace["traceEvents"])
+    c = c and (prof["point"]["insertions"] == Nmax+4) and (prof["line"]["insertions"] == 4)
+    c = c and (len(prof["trace"]) == Nmax+8)
+    n_sites = len( [e for e in trace["traceEvents"] if e["cat"]=="insert"] )
+    c = c and (n_sites == Nmax+8)
+    if c:
+        exit(0)
+    else:
+        exit(-1)
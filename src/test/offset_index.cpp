@@ -0,0 +1,180 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// offsets from the ClearanceIndex must equal a brute-force offset that scans all faces,
+// for offset(t) and for every level of offset(ts), also after the diagram has 
+// changed since the index was built.
+// the brute-force offset is the offset without an index: every call looks at every edge
+// of every face to find the faces that t crosses, and then walks the loops from these
+// faces in increasing order, exactly as Offset does.
+//
+// usage: offset_index <number of points>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+#include <boost/foreach.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include "voronoidiagram.hpp"
+#include "offset.hpp"
+
+using namespace ovd;
+
+// the offset loops at t, found by a linear scan of all faces
+class BruteForceOffset {
+public:
+    BruteForceOffset(HEGraph& gi): g(gi) {}
+    OffsetLoops offset(double t) {
+        loops = OffsetLoops();
+        face_done.assign( g.num_faces(), 1 );
+        for (HEFace f=0; f<g.num_faces(); f++) {
+            HEEdge current = g[f].edge;
+            do {
+                if ( bracket( current, t ) )
+                    face_done[f] = 0;
+                current = g[current].next;
+            } while ( current != g[f].edge );
+        }
+        for (HEFace f=0; f<g.num_faces(); f++) {
+            if ( !face_done[f] )
+                walk(f, t);
+        }
+        return loops;
+    }
+private:
+    bool bracket(HEEdge e, double t) {
+        double src_t = g[ g.source(e) ].dist();
+        double trg_t = g[ g.target(e) ].dist();
+        return std::min(src_t, trg_t) < t && t < std::max(src_t, trg_t);
+    }
+    // the next edge from e on the face, where the offset goes out (src_t < t < trg_t)
+    // or in (trg_t < t < src_t)
+    HEEdge next_edge(HEEdge e, double t, bool in) {
+        HEEdge current = e;
+        do {
+            double src_t = g[ g.source(current) ].dist();
+            double trg_t = g[ g.target(current) ].dist();
+            if ( (!in && src_t < t && t < trg_t) || (in && trg_t < t && t < src_t) )
+                return current;
+            current = g[current].next;
+        } while ( current != e );
+        return e;
+    }
+    void walk(HEFace start, double t) {
+        HEEdge start_edge = next_edge( g[start].edge, t, false );
+        HEEdge current = start_edge;
+        OffsetLoop loop;
+        loop.push_back( OffsetVertex( g[current].point(t) ) );
+        do {
+            bool in = g[ g.source(current) ].dist() < t;
+            HEEdge next = next_edge( g[current].next, t, in );
+            HEFace f = g[current].face;
+            Ofs* o = g[f].site->offset( g[current].point(t), g[next].point(t) );
+            bool cw = g[f].site->isLine() || o->center().is_right( o->start(), o->end() );
+            loop.push_back( OffsetVertex( g[next].point(t), o->radius(), o->center(), cw ) );
+            face_done[f] = 1;
+            current = g[next].twin;
+        } while ( current != start_edge );
+        loops.push_back( loop );
+    }
+    HEGraph& g;
+    std::vector<unsigned char> face_done;
+    OffsetLoops loops;
+};
+
+int errors = 0;
+
+bool same_vertex(const OffsetVertex& a, const OffsetVertex& b) {
+    return (a.p-b.p).norm() < 1e-12 && a.r == b.r && ( a.r == -1 || ( (a.c-b.c).norm() < 1e-12 && a.cw == b.cw ) );
+}
+
+void compare(const std::string& name, double t, const OffsetLoops& loops, const OffsetLoops& expected) {
+    if ( loops.size() != expected.size() ) {
+        std::cout << " " << name << " t=" << t << ": " << loops.size() << " loops, expected " << expected.size() << "\n";
+        errors++;
+        return;
+    }
+    OffsetLoops::const_iterator expected_loop = expected.begin();
+    BOOST_FOREACH( const OffsetLoop& loop, loops ) {
+        if ( loop.size() != expected_loop->size() || !std::equal( loop.begin(), loop.end(), expected_loop->begin(), same_vertex ) ) {
+            std::cout << " " << name << " t=" << t << ": a loop of " << loop.size() << " vertices differs from the expected loop of " << expected_loop->size() << "\n";
+            errors++;
+            return;
+        }
+        ++expected_loop;
+    }
+}
+
+// compare offset(t) and offset(ts) with the brute-force offset
+void check_offsets(Offset& ofs, HEGraph& g, const std::vector<double>& ts) {
+    BruteForceOffset brute_force(g);
+    BOOST_FOREACH( double t, ts ) {
+        compare( "offset(t)", t, ofs.offset(t), brute_force.offset(t) );
+    }
+    OffsetLevels levels = ofs.offset(ts);
+    if ( levels.size() != ts.size() ) {
+        std::cout << " offset(ts) returned " << levels.size() << " levels, expected " << ts.size() << "\n";
+        errors++;
+        return;
+    }
+    BOOST_FOREACH( const OffsetLevel& level, levels ) {
+        compare( "offset(ts)", level.t, level.loops, brute_force.offset( ts[level.level] ) );
+    }
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int n_points = 500;
+    if (argc > 1)
+        n_points = atoi(argv[1]);
+
+    // random points inside a square, the line-sites of the square are added later
+    boost::random::mt19937 rng(7);
+    boost::random::uniform_real_distribution<double> coord(-0.5, 0.5);
+    VoronoiDiagram vd(1, 10);
+    std::vector<int> corners;
+    corners.push_back( vd.insert_point_site( Point(-0.6,-0.6) ) );
+    corners.push_back( vd.insert_point_site( Point( 0.6,-0.6) ) );
+    corners.push_back( vd.insert_point_site( Point( 0.6, 0.6) ) );
+    corners.push_back( vd.insert_point_site( Point(-0.6, 0.6) ) );
+    for (unsigned int m=0; m<n_points; ++m)
+        vd.insert_point_site( Point( coord(rng), coord(rng) ) );
+
+    std::vector<double> ts; // in random order, offset(ts) must not depend on it
+    boost::random::uniform_real_distribution<double> distance(0.0005, 0.05);
+    for (int n=0; n<12; ++n)
+        ts.push_back( distance(rng) );
+
+    HEGraph& g = vd.get_graph_reference();
+    Offset ofs(g);
+    check_offsets(ofs, g, ts);
+
+    // the diagram changes after the index was built. the next offsets must see the new sites.
+    for (unsigned int m=0; m<corners.size(); ++m)
+        vd.insert_line_site( corners[m], corners[(m+1)%corners.size()] );
+    check_offsets(ofs, g, ts);
+
+    std::cout << n_points << " points and a square, " << ts.size() << " distances, " << errors << " errors\n";
+    if (errors)
+        return -1;
+    return 0;
+}
@@ -11,6 +11,23 @@ foreach( CASE ${LINESEG_CASES} )
     ADD_TEST(random_linesegments_${CASE} python ../src/test/random_linesegments.py ${CASE})
 endforeach()
 
+set( ADAPTIVE_CASES 128 1024)
+foreach( CASE ${ADAPTIVE_CASES} )
+    ADD_TEST(adaptive_precision_${CASE} python ../src/test/adaptive_precision.py ${CASE})
+endforeach()
+
+ADD_TEST(insertion_profiler python ../src/test/insertion_profiler.py 1000)
+
+set( ARC_ORDERS 0 1) # arcs before lines, and lines before arcs
+foreach( CASE ${ARC_ORDERS} )
+    ADD_TEST(arc_sites_${CASE} python ../src/test/arc_sites.py ${CASE} 100)
+endforeach()
+
+ADD_TEST(bulk_sites python ../src/test/bulk_sites.py 1000 40)
+ADD_TEST(diagram_arrays python ../src/test/diagram_arrays.py 300 30)
+ADD_TEST(save_load python ../src/test/save_load.py 300 30)
+ADD_TEST(svg_writer python ../src/test/svg_writer.py 300 30)
+
 set( 2OPT_RPG_CASES 5 10 15 20 30) # the number of vertices in the polygon
 set( 2OPT_RPG_MAX_SEED 100) # run test for seeds 0,1,2,3,...,max-1
 foreach( CASE ${2OPT_RPG_CASES} )
@@ -31,3 +48,50 @@ set( TTT_ALPHA_CASES 200 100 50 25 12)
 foreach( CASE ${TTT_ALPHA_CASES}) # characters A..Z
     ADD_TEST(ttt_alphabet_${CASE} python ../src/test/ttt_alphabet.py ${CASE})
 endforeach()
+
+# diagrams built in parallel threads must be identical to diagrams built serially
+find_package( Boost COMPONENTS thread system )
+if(Boost_THREAD_FOUND)
+    add_executable( threaded_diagrams ${CMAKE_SOURCE_DIR}/test/threaded_diagrams.cpp )
+    target_link_libraries( threaded_diagrams openvoronoi_static ${QD_LIBRARY} ${Boost_THREAD_LIBRARY} ${Boost_SYSTEM_LIBRARY} ${RT_LIBRARY} )
+    ADD_TEST(NAME threaded_diagrams COMMAND threaded_diagrams 8 500)
+
+    # offsets with FilterViews in parallel threads must equal offsets after in-place filtering
+    add_executable( filter_views ${CMAKE_SOURCE_DIR}/test/filter_views.cpp )
+    target_link_libraries( filter_views openvoronoi_static ${QD_LIBRARY} ${Boost_THREAD_LIBRARY} ${Boost_SYSTEM_LIBRARY} ${RT_LIBRARY} )
+    ADD_TEST(NAME filter_views COMMAND filter_views 8 500)
+endif()
+
+# the in-circle predicate must give the exact sign for near-cocircular inputs
+add_executable( in_circle ${CMAKE_SOURCE_DIR}/test/in_circle.cpp )
+target_link_libraries( in_circle openvoronoi_static ${QD_LIBRARY} ${RT_LIBRARY} )
+ADD_TEST(NAME in_circle COMMAND in_circle 100000)
+
+# ppp_batch() must give the same circumcenters as PPPSolver<double>
+add_executable( ppp_batch ${CMAKE_SOURCE_DIR}/test/ppp_batch.cpp )
+target_link_libraries( ppp_batch openvoronoi_static ${QD_LIBRARY} ${RT_LIBRARY} )
+ADD_TEST(NAME ppp_batch COMMAND ppp_batch 10000)
+
+# offset(t) and offset(ts) must equal a brute-force offset, also after the diagram changes
+add_executable( offset_index ${CMAKE_SOURCE_DIR}/test/offset_index.cpp )
+target_link_libraries( offset_index openvoronoi_static ${QD_LIBRARY} ${RT_LIBRARY} )
+ADD_TEST(NAME offset_index COMMAND offset_index 500)
+
+# queries on a DiagramFileView of a saved diagram must agree with the diagram
+add_executable( diagram_file_view ${CMAKE_SOURCE_DIR}/test/diagram_file_view.cpp )
+target_link_libraries( diagram_file_view openvoronoi_static ${QD_LIBRARY} ${RT_LIBRARY} )
+ADD_TEST(NAME diagram_file_view COMMAND diagram_file_view 1000)
+
+# the same diagram built with boost::listS and with hedi::flatS (OVD_FLAT_GRAPH) must be identical
+add_executable( diagram_dump ${CMAKE_SOURCE_DIR}/test/diagram_dump.cpp )
+target_link_libraries( diagram_dump openvoronoi_static ${QD_LIBRARY} ${RT_LIBRARY} )
+add_executable( diagram_dump_flat ${CMAKE_SOURCE_DIR}/test/diagram_dump.cpp ${OVD_SRC} )
+set_target_properties( diagram_dump_flat PROPERTIES COMPILE_DEFINITIONS OVD_FLAT_GRAPH )
+target_link_libraries( diagram_dump_flat ${QD_LIBRARY} ${RT_LIBRARY} )
+ADD_TEST(NAME diagram_dump COMMAND diagram_dump diagram_dump_lists.txt 2000)
+ADD_TEST(NAME diagram_dump_flat COMMAND diagram_dump_flat diagram_dump_flat.txt 2000)
+ADD_TEST(NAME flat_graph_same COMMAND ${CMAKE_COMMAND} -E compare_files diagram_dump_lists.txt diagram_dump_flat.txt)
+set_tests_properties( flat_graph_same PROPERTIES DEPENDS "diagram_dump;diagram_dump_flat" )
+
+# the small cases of the C++ benchmark, all diagrams must pass check()
+ADD_TEST(NAME ovd_bench_quick COMMAND ovd_bench --quick --data ${CMAKE_SOURCE_DIR}/test/data)
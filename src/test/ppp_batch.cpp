@@ -0,0 +1,99 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// the circumcenters from ppp_batch() must be identical to those from PPPSolver<double>,
+// for batches of every length (so that the vector kernels and the scalar tail are both used),
+// and for well-shaped as well as nearly collinear triangles.
+//
+// usage: ppp_batch <number of triangles>
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include "site.hpp"
+#include "solvers/solution.hpp"
+#include "solvers/solver_ppp.hpp"
+#include "solvers/ppp_batch.hpp"
+
+using namespace ovd;
+
+int main(int argc, char* argv[]) {
+    unsigned int n_triangles = 1000;
+    if (argc > 1)
+        n_triangles = atoi(argv[1]);
+
+    boost::random::mt19937 rng(1);
+    boost::random::uniform_real_distribution<double> coord(-1, 1);
+    boost::random::uniform_real_distribution<double> offset(-1e-7, 1e-7);
+    std::vector<Point> pi, pj, pk;
+    for (unsigned int n=0; n<n_triangles; ++n) {
+        Point a( coord(rng), coord(rng) );
+        Point b( coord(rng), coord(rng) );
+        Point c( coord(rng), coord(rng) );
+        if (n%2) // nearly collinear
+            c = a + (b-a)*coord(rng) + Point( offset(rng), offset(rng) );
+        ppp_order(a,b,c);
+        pi.push_back(a);
+        pj.push_back(b);
+        pk.push_back(c);
+    }
+
+    // the scalar solutions
+    PPPSolver<double> solver;
+    std::vector<Solution> scalar;
+    for (unsigned int n=0; n<n_triangles; ++n) {
+        PointSite s1(pi[n]), s2(pj[n]), s3(pk[n]);
+        solver.solve( &s1, &s2, &s3, scalar );
+    }
+
+    int errors = 0;
+    for (unsigned int len=1; len<=17; ++len) { // batch lengths around the vector widths 4 and 8
+        std::vector<double> ax, ay, bx, by;
+        for (unsigned int n=0; n<n_triangles; ++n) {
+            ax.push_back( pi[n].x - pk[n].x );
+            ay.push_back( pi[n].y - pk[n].y );
+            bx.push_back( pj[n].x - pk[n].x );
+            by.push_back( pj[n].y - pk[n].y );
+        }
+        std::vector<double> ux(n_triangles), uy(n_triangles);
+        for (unsigned int begin=0; begin<n_triangles; begin+=len) {
+            unsigned int count = std::min(len, n_triangles-begin);
+            ppp_batch( count, &ax[begin], &ay[begin], &bx[begin], &by[begin], &ux[begin], &uy[begin] );
+        }
+        for (unsigned int n=0; n<n_triangles; ++n) {
+            Point p( ux[n] + pk[n].x, uy[n] + pk[n].y );
+            if ( p.x != scalar[n].p.x || p.y != scalar[n].p.y ) {
+                if (errors < 10) {
+                    std::cout.precision(17);
+                    std::cout << " batch length " << len << " triangle " << n << ": " << p 
+                              << " != " << scalar[n].p << "\n";
+                }
+                errors++;
+            }
+        }
+    }
+    std::cout << n_triangles << " triangles, kernel " << ppp_batch_kernel() << ", " << errors << " errors\n";
+    if (errors)
+        return -1;
+    return 0;
+}
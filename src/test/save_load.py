@@ -0,0 +1,102 @@
+import openvoronoi as ovd
+import math
+import os
+import random
+import struct
+import sys
+import tempfile
+
+# this test saves a diagram of N random points and the M vertices of a polygon,
+# and loads it into a diagram with a different far-radius and grid.
+# the diagrams must be identical, also after the M line-sites of the polygon
+# are inserted into both. A file that is not a diagram, or a diagram file with
+# a corrupted index, face or enum field, must not be loaded.
+#
+# call with save_load.py N M
+
+# vertices, edges and offsets of the diagram, as numbers
+def dump(vd):
+    out = []
+    for v in vd.getVoronoiVertices():
+        out.append( (v[0].x, v[0].y, v[1], v[2]) )
+    for e in vd.getVoronoiEdges():
+        out.append( tuple( [ (p.x, p.y) for p in e[0] ] ) + (int(e[1]),) )
+    of = ovd.Offset( vd.getGraph() )
+    for loop in of.offset(0.01):
+        out.append( tuple( [ (ov[0].x, ov[0].y, ov[1]) for ov in loop ] ) )
+    return out
+
+# (name, table, byte in the record, struct format, value) of the corruptions.
+# the tables are VERTEX_TABLE=0, EDGE_TABLE=1, FACE_TABLE=2, or -1 for the header.
+corruptions = [ ("edge index", 1, 24, '<I', 100000000),
+                ("vertex index", 0, 40, '<i', 100000000),
+                ("vertex face", 0, 44, '<I', 100000000),
+                ("vertex type", 0, 52, '<B', 200),
+                ("edge null-face", 1, 20, '<I', 100000000),
+                ("edge type", 1, 40, '<B', 200),
+                ("face status", 2, 4, '<I', 7),
+                ("last face", -1, 48, '<I', 100000000) ]
+
+# the bytes of a saved diagram, with one field overwritten
+def corrupt(data, table, byte, fmt, value):
+    out = bytearray(data)
+    if table < 0:
+        struct.pack_into( fmt, out, byte, value )
+    else:
+        (offset, rows, size) = struct.unpack_from( '<QII', out, 64 + 16*table )
+        struct.pack_into( fmt, out, offset + (rows-1)*size + byte, value ) # the last record
+    return out
+
+if __name__ == "__main__":
+    Nmax = int(sys.argv[1])
+    Mmax = int(sys.argv[2])
+    print "save_load.py N=",Nmax," M=",Mmax
+    random.seed(42)
+    vd = ovd.VoronoiDiagram(1,120)
+    for n in range(Nmax):
+        vd.addVertexSite( ovd.Point( random.uniform(-0.3,0.3), random.uniform(-0.3,0.3) ) )
+    ids = []
+    for m in range(Mmax): # a polygon, clockwise
+        a = -2*math.pi*m/Mmax
+        ids.append( vd.addVertexSite( ovd.Point( 0.5*math.cos(a), 0.5*math.sin(a) ) ) )
+
+    (fd, filename) = tempfile.mkstemp(suffix=".ovd")
+    os.close(fd)
+    saved = vd.save(filename)
+    vd2 = ovd.VoronoiDiagram(2,10)
+    loaded = vd2.load(filename)
+    same_points = ( dump(vd) == dump(vd2) )
+    for m in range(Mmax):
+        vd.addLineSite( ids[m], ids[(m+1)%Mmax] )
+        vd2.addLineSite( ids[m], ids[(m+1)%Mmax] )
+    same_lines = ( dump(vd) == dump(vd2) )
+
+    f = open(filename, "wb")
+    f.write( "not a diagram".encode() )
+    f.close()
+    rejected = not vd2.load(filename)
+    unchanged = ( dump(vd) == dump(vd2) )
+
+    vd.save(filename)
+    f = open(filename, "rb")
+    data = f.read()
+    f.close()
+    for (name, table, byte, fmt, value) in corruptions:
+        f = open(filename, "wb")
+        f.write( corrupt(data, table, byte, fmt, value) )
+        f.close()
+        if vd2.load(filename):
+            print " corrupted ", name, " was loaded"
+            rejected = False
+    unchanged = unchanged and ( dump(vd) == dump(vd2) ) and vd2.save(filename)
+    os.remove(filename)
+
+    print " saved: ", saved, " loaded: ", loaded
+    print " identical after load: ", same_points, " after line-sites: ", same_lines
+    print " bad files rejected: ", rejected, " diagram unchanged: ", unchanged
+    c = vd2.check()
+    print " VD check: ", c
+    if c and saved and loaded and same_points and same_lines and rejected and unchanged and vd2.numLineSites() == Mmax:
+        exit(0)
+    else:
+        exit(-1)
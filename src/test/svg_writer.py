@@ -0,0 +1,79 @@
+import openvoronoi as ovd
+import math
+import os
+import random
+import sys
+import tempfile
+import xml.dom.minidom
+
+# this test draws a diagram of N random points and an M-polygon with SvgWriter.
+# vd2svg() must write the same file as an SvgWriter with default settings.
+# A zoomed-in picture must leave out edges, a coarser tolerance must not give more
+# points, and all the layers must be drawn.
+#
+# call with svg_writer.py N M
+
+# the svg elements of a file, and the number of points in its polylines
+def read_svg(filename):
+    doc = xml.dom.minidom.parse(filename)
+    npts = 0
+    for pl in doc.getElementsByTagName("polyline"):
+        npts = npts + len( pl.getAttribute("points").split() )
+    groups = [ g.getAttribute("id") for g in doc.getElementsByTagName("g") ]
+    n = len(doc.getElementsByTagName("polyline")) + len(doc.getElementsByTagName("circle")) + len(doc.getElementsByTagName("path"))
+    return (n, npts, groups)
+
+if __name__ == "__main__":
+    Nmax = int(sys.argv[1])
+    Mmax = int(sys.argv[2])
+    print "svg_writer.py N=",Nmax," M=",Mmax
+    random.seed(42)
+    vd = ovd.VoronoiDiagram(1,120)
+    ids = []
+    for m in range(Mmax): # a polygon, clockwise
+        a = -2*math.pi*(m+0.5)/Mmax
+        ids.append( vd.addVertexSite( ovd.Point( 0.7*math.cos(a), 0.7*math.sin(a) ) ) )
+    for n in range(Nmax):
+        vd.addVertexSite( ovd.Point( random.uniform(-0.3,0.3), random.uniform(-0.3,0.3) ) )
+    for m in range(Mmax):
+        vd.addLineSite( ids[m], ids[(m+1)%Mmax] )
+
+    (fd, filename) = tempfile.mkstemp(suffix=".svg")
+    os.close(fd)
+    ovd.vd2svg(filename, vd)
+    old = open(filename).read()
+    w = ovd.SvgWriter( vd.getGraph() )
+    ok = w.write(filename)
+    same = ( old == open(filename).read() )
+    (n_full, pts_full, groups) = read_svg(filename)
+    written = ( n_full == w.numWritten() )
+
+    w.setTolerance(4)
+    w.write(filename)
+    (n_coarse, pts_coarse, groups) = read_svg(filename)
+
+    z = ovd.SvgWriter( vd.getGraph() )
+    z.setViewport( ovd.Point(0,0), ovd.Point(0.1,0.1) )
+    z.write(filename)
+    (n_zoom, pts_zoom, groups) = read_svg(filename)
+    culled = ( n_zoom < n_full ) and ( z.numCulled() > 0 )
+
+    view = ovd.FilterView( vd.getGraph() )
+    ma = ovd.MedialAxis( vd.getGraph(), view )
+    layers = ovd.SvgWriter( vd.getGraph() )
+    layers.setLayers( ovd.SvgLayer.SITES | ovd.SvgLayer.BISECTORS | ovd.SvgLayer.OFFSETS | ovd.SvgLayer.MEDIAL_AXIS )
+    layers.addOffset( 0.05 )
+    layers.setMedialAxis( view )
+    layers.write(filename)
+    (n_layers, pts_layers, groups) = read_svg(filename)
+    all_layers = ( groups == ["bisectors", "sites", "offsets", "medial_axis"] )
+    os.remove(filename)
+
+    print " written: ", ok, " same as vd2svg: ", same, " elements: ", n_full, " counted: ", written
+    print " points: ", pts_full, " with tolerance 4px: ", pts_coarse
+    print " zoomed elements: ", n_zoom, " culled: ", z.numCulled()
+    print " layers: ", groups
+    if ok and same and written and pts_coarse <= pts_full and culled and all_layers:
+        exit(0)
+    else:
+        exit(-1)
@@ -0,0 +1,112 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// build independent diagrams in parallel threads, and check that they
+// are identical to the same diagrams built one after another.
+//
+// usage: threaded_diagrams <number of diagrams> <number of points per diagram>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include <boost/thread.hpp>
+#include <boost/foreach.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include "voronoidiagram.hpp"
+
+using namespace ovd;
+
+// a description of the diagram, equal for identical diagrams
+struct DiagramSummary {
+    DiagramSummary() : valid(false) {}
+    bool valid;
+    std::string text;
+};
+
+// build diagram number n: random points inside a square of line-sites
+void build_diagram(unsigned int n, unsigned int n_points, DiagramSummary* out) {
+    boost::random::mt19937 rng(n);
+    boost::random::uniform_real_distribution<double> coord(-0.5, 0.5);
+    VoronoiDiagram vd(1, 10);
+    std::ostringstream s;
+    s.precision(17);
+    std::vector<int> corners;
+    corners.push_back( vd.insert_point_site( Point(-0.6,-0.6) ) );
+    corners.push_back( vd.insert_point_site( Point( 0.6,-0.6) ) );
+    corners.push_back( vd.insert_point_site( Point( 0.6, 0.6) ) );
+    corners.push_back( vd.insert_point_site( Point(-0.6, 0.6) ) );
+    std::vector<Point> pts;
+    for (unsigned int m=0; m<n_points; ++m) {
+        double x = coord(rng);
+        double y = coord(rng);
+        pts.push_back( Point(x,y) );
+    }
+    BOOST_FOREACH( int idx, vd.insert_point_sites(pts) ) {
+        s << idx << " ";
+    }
+    for (unsigned int m=0; m<corners.size(); ++m)
+        vd.insert_line_site( corners[m], corners[(m+1)%corners.size()] );
+
+    HEGraph& g = vd.get_graph_reference();
+    s << "\n" << vd.num_vertices() << " " << vd.num_faces() << "\n";
+    BOOST_FOREACH( HEVertex v, g.vertices() ) {
+        s << g[v].index << " " << g[v].position.x << " " << g[v].position.y << "\n";
+    }
+    out->valid = vd.check();
+    out->text = s.str();
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int n_diagrams = 8;
+    unsigned int n_points = 1000;
+    if (argc > 1)
+        n_diagrams = atoi(argv[1]);
+    if (argc > 2)
+        n_points = atoi(argv[2]);
+
+    std::vector<DiagramSummary> serial(n_diagrams);
+    for (unsigned int n=0; n<n_diagrams; ++n)
+        build_diagram(n, n_points, &serial[n]);
+
+    std::vector<DiagramSummary> threaded(n_diagrams);
+    boost::thread_group threads;
+    for (unsigned int n=0; n<n_diagrams; ++n)
+        threads.add_thread( new boost::thread( &build_diagram, n, n_points, &threaded[n] ) );
+    threads.join_all();
+
+    int errors = 0;
+    for (unsigned int n=0; n<n_diagrams; ++n) {
+        if ( !serial[n].valid || !threaded[n].valid ) {
+            std::cout << " diagram " << n << " failed check()\n";
+            errors++;
+        } else if ( serial[n].text != threaded[n].text ) {
+            std::cout << " diagram " << n << " built in a thread differs from serial build\n";
+            errors++;
+        }
+    }
+    std::cout << n_diagrams << " diagrams with " << n_points << " points, " << errors << " errors\n";
+    if (errors)
+        return -1;
+    return 0;
+}
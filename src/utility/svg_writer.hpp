@@ -0,0 +1,402 @@
+/*
+ *  Copyright 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com)
+ *
+ *  This file is part of OpenVoronoi.
+ *
+ *  OpenVoronoi is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenVoronoi is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenVoronoi.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SVG_WRITER_HPP
+#define SVG_WRITER_HPP
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+#include <openvoronoi/voronoidiagram.hpp>
+#include <openvoronoi/offset.hpp>
+#include <openvoronoi/filter_view.hpp>
+#include <openvoronoi/common/point.hpp>
+
+#include <boost/foreach.hpp>
+
+namespace ovd {
+
+/// \brief the parts of a diagram that SvgWriter draws. Combine with |
+enum SvgLayer {
+    SVG_SITES = 1,       ///< point-sites, line-sites and arc-sites
+    SVG_BISECTORS = 2,   ///< the voronoi edges
+    SVG_OFFSETS = 4,     ///< offsets at the distances given with add_offset()
+    SVG_MEDIAL_AXIS = 8  ///< the edges that are valid in the view given with set_medial_axis()
+};
+
+/// \brief streaming svg output of a voronoi diagram
+///
+/// each edge is written to the stream as soon as it is sampled, so memory use does
+/// not grow with the size of the diagram. The picture is width x height pixels.
+/// A diagram point p is drawn at pixel ( scale*(p.x-origin.x), height-scale*(p.y-origin.y) ).
+///
+/// - edges that cannot reach the picture are not written (a bounding-box test)
+/// - curved edges are sampled until the drawn polyline is within tolerance pixels of the curve,
+///   so a zoomed-out picture of a large diagram has few points per edge
+/// - edges shorter than tolerance pixels are not written
+/// - each undirected edge is written once, not once per half-edge
+///
+/// the defaults (1024x1024 pixels, scale 500, origin (-1,-1), sites and bisectors)
+/// give the picture that vd2svg() has always written.
+class SvgWriter {
+public:
+    SvgWriter(HEGraph& gi): g(gi), width(1024), height(1024), scale(500), origin(-1,-1),
+        tolerance(0.25), layers(SVG_SITES|SVG_BISECTORS), medial_view(0), written(0), culled(0) {}
+    /// the size of the picture in pixels
+    void set_size(double w, double h) {
+        assert( w > 0 && h > 0 );
+        width = w;
+        height = h;
+    }
+    /// pixels per unit of the diagram
+    void set_scale(double s) {
+        assert( s > 0 );
+        scale = s;
+    }
+    /// the diagram point at the lower left corner of the picture
+    void set_origin(const Point& p) { origin = p; }
+    /// set scale and origin so that the box from pmin to pmax fills the picture, centered
+    void set_viewport(const Point& pmin, const Point& pmax) {
+        assert( pmax.x > pmin.x && pmax.y > pmin.y );
+        scale = std::min( width/(pmax.x-pmin.x), height/(pmax.y-pmin.y) );
+        Point mid = 0.5*(pmin+pmax);
+        origin = mid - Point( 0.5*width/scale, 0.5*height/scale );
+    }
+    /// the largest distance, in pixels, between a drawn curve and the true curve
+    void set_tolerance(double px) {
+        assert( px > 0 );
+        tolerance = px;
+    }
+    /// the layers to draw, see SvgLayer
+    void set_layers(int l) { layers = l; }
+    /// draw offsets at distance t, in the SVG_OFFSETS layer
+    void add_offset(double t) { offsets.push_back(t); }
+    /// draw the edges that are valid in v, e.g. after MedialAxis(g,v), in the SVG_MEDIAL_AXIS layer.
+    /// v must live until write() returns.
+    void set_medial_axis(const FilterView& v) { medial_view = &v; }
+
+    /// write the picture to a file. returns false if the file cannot be written
+    bool write(const std::string& filename) {
+        std::ofstream out( filename.c_str() );
+        if ( !out.good() )
+            return false;
+        write(out);
+        out.close();
+        return !out.fail();
+    }
+    /// write the picture to out
+    void write(std::ostream& out) {
+        written = 0;
+        culled = 0;
+        std::ios::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << "<?xml version=\"1.0\" standalone=\"no\" ?>\n"
+            << "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\n"
+            << "<svg width=\"" << width << "px\" height=\"" << height << "px\" "
+            << "xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n";
+        out << std::fixed << std::setprecision(2); // pixel coordinates
+        if ( layers & SVG_BISECTORS ) {
+            begin_group(out, "bisectors", "rgb(0,0,255)", 1);
+            write_edges(out, BISECTOR_EDGES, "rgb(0,128,0)");
+            out << "</g>\n";
+        }
+        if ( layers & SVG_SITES ) {
+            begin_group(out, "sites", "rgb(255,255,0)", 1);
+            write_edges(out, SITE_EDGES, 0);
+            write_point_sites(out);
+            out << "</g>\n";
+        }
+        if ( (layers & SVG_OFFSETS) && !offsets.empty() ) {
+            begin_group(out, "offsets", "rgb(255,0,0)", 1);
+            write_offsets(out);
+            out << "</g>\n";
+        }
+        if ( (layers & SVG_MEDIAL_AXIS) && medial_view ) {
+            begin_group(out, "medial_axis", "rgb(255,0,255)", 2);
+            write_edges(out, MEDIAL_EDGES, 0);
+            out << "</g>\n";
+        }
+        out << "</svg>\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+    /// the number of elements (edges, sites, offset loops) in the last picture
+    unsigned int num_written() const { return written; }
+    /// the number of edges, sites and offset loops left out of the last picture because they are outside it
+    unsigned int num_culled() const { return culled; }
+private:
+    SvgWriter(); // don't use.
+    enum EdgeSet { BISECTOR_EDGES, SITE_EDGES, MEDIAL_EDGES };
+    /// an axis-aligned box in diagram coordinates
+    struct Box {
+        Box(double x1, double y1, double x2, double y2): xmin(x1), ymin(y1), xmax(x2), ymax(y2) {}
+        Box(const Point& p, double r): xmin(p.x-r), ymin(p.y-r), xmax(p.x+r), ymax(p.y+r) {}
+        void add(const Point& p, double r) {
+            xmin = std::min(xmin, p.x-r);
+            ymin = std::min(ymin, p.y-r);
+            xmax = std::max(xmax, p.x+r);
+            ymax = std::max(ymax, p.y+r);
+        }
+        bool overlaps(const Box& b) const {
+            return (xmin <= b.xmax) && (b.xmin <= xmax) && (ymin <= b.ymax) && (b.ymin <= ymax);
+        }
+        double xmin, ymin, xmax, ymax;
+    };
+
+    void begin_group(std::ostream& out, const char* id, const char* color, double stroke_width) const {
+        out << "<g id=\"" << id << "\" fill=\"none\" stroke=\"" << color << "\" stroke-width=\"" << stroke_width << "\">\n";
+    }
+    /// the picture in diagram coordinates, with a margin of a few pixels for the stroke width
+    Box viewport() const {
+        double m = 4/scale;
+        return Box( origin.x-m, origin.y-m, origin.x+width/scale+m, origin.y+height/scale+m );
+    }
+    Point to_svg(const Point& p) const {
+        return Point( scale*(p.x-origin.x), height-scale*(p.y-origin.y) );
+    }
+    static bool is_straight(VoronoiEdgeType t) {
+        return (t == LINE) || (t == LINELINE) || (t == PARA_LINELINE) || (t == OUTEDGE) ||
+               (t == SEPARATOR) || (t == LINESITE) || (t == NULLEDGE);
+    }
+    static bool is_curved(VoronoiEdgeType t) {
+        return (t == PARABOLA) || (t == ELLIPSE) || (t == HYPERBOLA);
+    }
+    // one half-edge of each edge is drawn: the one with the lower index
+    bool first_of_twins(HEEdge e) const {
+        HEEdge tw = g[e].twin;
+        return ( tw == HEEdge() ) || ( g[e].index < g[tw].index );
+    }
+    bool in_set(HEEdge e, EdgeSet set) const {
+        VoronoiEdgeType t = g[e].type;
+        if ( set == MEDIAL_EDGES )
+            return medial_view->valid(e) && (t != NULLEDGE);
+        if ( set == SITE_EDGES )
+            return (t == LINESITE) || (t == ARCSITE);
+        return (t != LINESITE) && (t != ARCSITE) && (t != NULLEDGE);
+    }
+    /// write the edges of the set. curved edges are drawn in curve_color, if given
+    void write_edges(std::ostream& out, EdgeSet set, const char* curve_color) {
+        const Box view = viewport();
+        BOOST_FOREACH( HEEdge e, boost::edges(g.g) ) {
+            if ( !in_set(e, set) || !first_of_twins(e) )
+                continue;
+            if ( !edge_box(e).overlaps(view) ) {
+                culled++;
+                continue;
+            }
+            points.clear();
+            sample_edge(e);
+            if ( points.size() == 2 && (points[0]-points[1]).norm() < tolerance )
+                continue; // too small to see
+            out << "<polyline ";
+            if ( curve_color && is_curved(g[e].type) )
+                out << "stroke=\"" << curve_color << "\" ";
+            out << "points=\"";
+            for (unsigned int n=0; n<points.size(); ++n)
+                out << (n ? " " : "") << points[n].x << "," << points[n].y;
+            out << "\"/>\n";
+            written++;
+        }
+    }
+    void write_point_sites(std::ostream& out) {
+        const Box view = viewport();
+        const double r = 2; // pixels
+        BOOST_FOREACH( HEVertex v, boost::vertices(g.g) ) {
+            if ( g[v].type != POINTSITE )
+                continue;
+            if ( !Box(g[v].position, 0).overlaps(view) ) {
+                culled++;
+                continue;
+            }
+            Point p = to_svg( g[v].position );
+            out << "<circle cx=\"" << p.x << "\" cy=\"" << p.y << "\" r=\"" << r << "\" fill=\"rgb(255,255,0)\"/>\n";
+            written++;
+        }
+    }
+    // each loop is a path of lines and svg arcs
+    void write_offsets(std::ostream& out) {
+        const Box view = viewport();
+        Offset o(g);
+        OffsetLevels levels = o.offset(offsets);
+        BOOST_FOREACH( const OffsetLevel& level, levels ) {
+            BOOST_FOREACH( const OffsetLoop& loop, level.loops ) {
+                if ( loop.empty() )
+                    continue;
+                Box box( loop.front().p, 0 );
+                BOOST_FOREACH( const OffsetVertex& ov, loop ) {
+                    if ( ov.r > 0 )
+                        box.add( ov.c, ov.r );
+                    else
+                        box.add( ov.p, 0 );
+                }
+                if ( !box.overlaps(view) ) {
+                    culled++;
+                    continue;
+                }
+                out << "<path d=\"";
+                Point previous = loop.front().p;
+                Point p = to_svg( previous );
+                out << "M " << p.x << " " << p.y;
+                OffsetLoop::const_iterator it = loop.begin();
+                for (++it; it != loop.end(); ++it) {
+                    p = to_svg( it->p );
+                    if ( it->r <= 0 ) {
+                        out << " L " << p.x << " " << p.y;
+                    } else {
+                        double da = arc_angle( previous, it->p, it->c, it->cw );
+                        if ( da > 1.9*M_PI ) { // (almost) a full circle. draw two halves, since an svg arc with equal end-points is not drawn.
+                            Point half = to_svg( 2*it->c - previous );
+                            write_arc(out, scale*it->r, false, it->cw, half);
+                            da -= M_PI;
+                        }
+                        write_arc(out, scale*it->r, da > M_PI, it->cw, p);
+                    }
+                    previous = it->p;
+                }
+                out << "\"/>\n";
+                written++;
+            }
+        }
+    }
+    void write_arc(std::ostream& out, double r, bool large, bool cw, const Point& p) const {
+        // the y-axis is flipped, so a clockwise arc in the diagram has the positive svg sweep-direction
+        out << " A " << r << " " << r << " 0 " << (large ? 1 : 0) << " " << (cw ? 1 : 0) << " " << p.x << " " << p.y;
+    }
+    /// the angle of the arc around c from p1 to p2, in (0, 2*pi]
+    static double arc_angle(const Point& p1, const Point& p2, const Point& c, bool cw) {
+        Point d1 = p1-c;
+        Point d2 = p2-c;
+        double a = atan2( d1.cross(d2), d1.dot(d2) ); // counter-clockwise, in (-pi, pi]
+        if (cw)
+            a = -a;
+        if (a <= 0)
+            a += 2*M_PI;
+        return a;
+    }
+
+    /// a box that contains edge e
+    Box edge_box(HEEdge e) const {
+        HEVertex src = g.source(e);
+        HEVertex trg = g.target(e);
+        Box box( g[src].position, 0 );
+        box.add( g[trg].position, 0 );
+        VoronoiEdgeType t = g[e].type;
+        if ( is_straight(t) )
+            return box;
+        if ( t == ARCSITE ) {
+            Site* s = g[ g[e].face ].site;
+            return Box( Point( s->x(), s->y() ), s->r() );
+        }
+        // all points of the edge are within clearance t_max of the site of each adjacent face
+        double t_max = std::max( g[src].dist(), g[trg].dist() );
+        Box site_box(0,0,0,0);
+        if ( !face_box( g[e].face, t_max, site_box ) )
+            return Box( Point(0,0), 1e300 ); // no site to bound the edge
+        HEEdge tw = g[e].twin;
+        Box twin_box(0,0,0,0);
+        if ( tw != HEEdge() && face_box( g[tw].face, t_max, twin_box ) ) {
+            site_box.xmin = std::max(site_box.xmin, twin_box.xmin);
+            site_box.ymin = std::max(site_box.ymin, twin_box.ymin);
+            site_box.xmax = std::min(site_box.xmax, twin_box.xmax);
+            site_box.ymax = std::min(site_box.ymax, twin_box.ymax);
+        }
+        return site_box;
+    }
+    /// the box of all points within distance t of the site of face f
+    bool face_box(HEFace f, double t, Box& box) const {
+        Site* s = g[f].site;
+        if ( !s )
+            return false;
+        if ( s->isPoint() ) {
+            box = Box( s->position(), t );
+        } else if ( s->isLine() ) {
+            box = Box( s->start(), t );
+            box.add( s->end(), t );
+        } else {
+            box = Box( Point( s->x(), s->y() ), s->r()+t );
+        }
+        return true;
+    }
+
+    /// the points of the polyline that draws e, in svg coordinates
+    void sample_edge(HEEdge e) {
+        HEVertex src = g.source(e);
+        HEVertex trg = g.target(e);
+        Point src_p = to_svg( g[src].position );
+        Point trg_p = to_svg( g[trg].position );
+        points.push_back( src_p );
+        VoronoiEdgeType t = g[e].type;
+        if ( is_curved(t) ) {
+            subdivide( e, g[src].dist(), src_p, g[trg].dist(), trg_p, 0 );
+        } else if ( t == ARCSITE ) {
+            // around the center of the arc, from src to trg
+            Site* s = g[ g[e].face ].site;
+            Point c( s->x(), s->y() );
+            Point p1 = g[src].position - c;
+            Point p2 = g[trg].position - c;
+            double a1 = atan2( p1.y, p1.x );
+            double da = atan2( p1.cross(p2), p1.dot(p2) );
+            double r_px = scale*s->r();
+            int n_max = 1;
+            if ( r_px > tolerance ) // segments of angle 2*acos(1-tolerance/r) are within tolerance of the arc
+                n_max = std::min( 1024, (int)ceil( fabs(da) / (2*acos(1-tolerance/r_px)) ) );
+            for (int n=1; n<n_max; n++) {
+                double a = a1 + da*n/n_max;
+                points.push_back( to_svg( c + s->r()*Point( cos(a), sin(a) ) ) );
+            }
+        }
+        points.push_back( trg_p );
+    }
+    /// add the points of the curve strictly between clearance t1 (at p1) and t2 (at p2)
+    /// the curve is split at the middle clearance while the middle point is further than tolerance
+    /// from the middle of the chord. Bisectors have no inflection points, so then the whole curve
+    /// is within tolerance of the chord.
+    void subdivide(HEEdge e, double t1, const Point& p1, double t2, const Point& p2, int depth) {
+        if ( depth >= 10 || (p2-p1).norm() < tolerance )
+            return;
+        double tm = 0.5*(t1+t2);
+        Point pm = to_svg( g[e].point(tm) );
+        if ( (pm - 0.5*(p1+p2)).norm() <= tolerance )
+            return;
+        subdivide(e, t1, p1, tm, pm, depth+1);
+        points.push_back( pm );
+        subdivide(e, tm, pm, t2, p2, depth+1);
+    }
+
+    HEGraph& g;
+    double width;
+    double height;
+    double scale;
+    Point origin;
+    double tolerance;
+    int layers;
+    std::vector<double> offsets;
+    const FilterView* medial_view;
+    std::vector<Point> points; // the polyline of the current edge
+    unsigned int written;
+    unsigned int culled;
+};
+
+} // end namespace
+#endif
+// end svg_writer.hpp
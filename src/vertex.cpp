@@ -29,17 +29,20 @@ namespace ovd {
 
 inline double sq(double x) {return x*x;}
 
-int VoronoiVertex::count = 0;
-
 // the expected degree of a vertex. checked by topology-checker
-VertexDegreeMap VoronoiVertex::expected_degree = boost::assign::map_list_of 
-    (OUTER,4)     // special outer vertices
-    (NORMAL,6)    // normal vertex in the graph
-    (POINTSITE,0) // point site
-    (ENDPOINT,6)  // end-point of line or arc
-    (SEPPOINT,6)  // end-point of separator
-    (SPLIT,4)     // split point, to avoid loops in delete-tree
-    (APEX,4) ;    // apex point on quadratic bisector
+unsigned int VoronoiVertex::expected_degree(VoronoiVertexType t) {
+    switch (t) {
+        case OUTER:     return 4; // special outer vertices
+        case NORMAL:    return 6; // normal vertex in the graph
+        case POINTSITE: return 0; // point site
+        case ENDPOINT:  return 6; // end-point of line or arc
+        case SEPPOINT:  return 6; // end-point of separator
+        case SPLIT:     return 4; // split point, to avoid loops in delete-tree
+        case APEX:      return 4; // apex point on quadratic bisector
+    }
+    assert(0);
+    return 0;
+}
 
 VoronoiVertex::VoronoiVertex() {
     init();
@@ -63,13 +66,15 @@ VoronoiVertex::VoronoiVertex( Point p, VoronoiVertexStatus st, VoronoiVertexType
     init(p,st,t,initDist,lk3);
 }
 
-/// set index, increase count, initialize in_queue to false.
+/// initialize in_queue to false. the index is set when the vertex is added to a diagram.
 void VoronoiVertex::init() {
-    index = count;
-    count++;
+    index = -1;
     in_queue = false;
+    epoch = 0;
     alfa=-1; // invalid/non-initialized alfa value
     null_face = std::numeric_limits<HEFace>::quiet_NaN();    
+    face = 0;
+    k3 = 0;
     type = NORMAL;
     //status = UNDECIDED;
 }
@@ -26,6 +26,7 @@
 #include <boost/graph/adjacency_list.hpp>
 
 #include "common/point.hpp"
+#include "common/predicates.hpp"
 #include "site.hpp"
 
 namespace ovd {
@@ -46,10 +47,6 @@ enum VoronoiVertexStatus {OUT, IN, UNDECIDED, NEW };
 /// APEX vertices split quadratic edges at their apex(closest point to site)
 enum VoronoiVertexType {OUTER, NORMAL, POINTSITE, ENDPOINT, SEPPOINT, APEX, SPLIT};
 
-/// a map of this type is used by topology-checker to check that all vertices
-/// have the expected (correct) degree (i.e. number of edges)
-typedef std::map<VoronoiVertexType, unsigned int> VertexDegreeMap;
-
 typedef unsigned int HEFace;
                                      
 /// A vertex in the voronoi diagram
@@ -74,17 +71,27 @@ public:
     double dist(const Point& p) const { return (position-p).norm(); }
     /// return clearance-disk radius
     void zero_dist() {r=0;}
+    /// set the clearance-disk radius. used when a saved diagram is loaded
+    void set_dist(double d) {r=d;}
     double dist() const { return r; }
-    /// in-circle predicate 
-    double in_circle(const Point& p) const { return dist(p) - r; }
-    static void reset_count() { count = 0; }
+    /// in-circle predicate, negative if p is inside the clearance-disk.
+    /// the sign is certified, see predicates::in_circle()
+    double in_circle(const Point& p) const { return in_circle_test(p).value; }
+    /// in-circle predicate with information on how the sign was decided
+    predicates::PredicateResult in_circle_test(const Point& p) const { return predicates::in_circle(position, r, p); }
+    /// the expected degree of a vertex of type t. checked by topology-checker
+    static unsigned int expected_degree(VoronoiVertexType t);
 // DATA
+    /// vertex index, unique within a diagram. set by VoronoiDiagram when the vertex is added.
     int index;
     /// vertex status. when the incremental algorithm runs
     /// vertices are marked: undecided, in, out, or new
     VoronoiVertexStatus status;
     VoronoiVertexType type;
     bool in_queue;
+    /// the insertion-epoch in which this vertex was last added to the list of modified vertices.
+    /// a vertex is on the list iff epoch equals the epoch of the current insertion.
+    unsigned int epoch;
     /// the position of the vertex
     Point position;
     void set_alfa(const Point& dir);
@@ -100,10 +107,6 @@ protected:
     void init(Point p, VoronoiVertexStatus st, VoronoiVertexType t, Point initDist);
     void init(Point p, VoronoiVertexStatus st, VoronoiVertexType t, Point initDist, double k3);
 
-    /// global vertex count
-    static int count;
-    /// map for checking topology correctness
-    static VertexDegreeMap expected_degree;
     /// clearance-disk radius, i.e. the closest site is at this distance
     double r;
     
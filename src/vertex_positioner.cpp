@@ -29,26 +29,71 @@
 #include "solvers/solver_lll.hpp"
 #include "solvers/solver_qll.hpp"
 #include "solvers/solver_sep.hpp"
+#include "solvers/ppp_batch.hpp"
 
 using namespace ovd::numeric; // sq() chop()
 
+// the Telemetry is recorded with TELEMETRY(), removed by compiling with OVD_NO_TELEMETRY
+#ifdef OVD_NO_TELEMETRY
+#define TELEMETRY(x)
+#else
+#define TELEMETRY(x) x
+#endif
+
 namespace ovd {
 
+/// the solvers for one number-type. 
+/// the solvers are held by value, so solve() is called without virtual dispatch
+template<class Scalar>
+struct ScalarSolvers {
+    ScalarSolvers() : qll_best(true) {}
+    PPPSolver<Scalar> ppp;
+    LLLSolver<Scalar> lll;
+    QLLSolver<Scalar> qll;
+    QLLSolver<Scalar> qll_best; // for set_qll_best_only()
+};
+
+/// all solvers. SEPSolver computes in double only.
+struct SolverSet {
+    ScalarSolvers<double> d;
+    ScalarSolvers<dd_real> dd;
+    ScalarSolvers<qd_real> qd;
+    SEPSolver sep;
+};
+
+// call the PPP, LLL, or QLL solver of the given number-type
+template<class Scalar>
+static inline int dispatch(ScalarSolvers<Scalar>& solvers, SolverType type, bool best_only, 
+                           Site* s1, double k1, Site* s2, double k2, Site* s3, double k3, std::vector<Solution>& solns) {
+    switch (type) {
+    case LLL_SOLVER:
+        return solvers.lll.solve( s1,k1,s2,k2,s3,k3, solns ); // all lines.
+    case PPP_SOLVER:
+        return solvers.ppp.solve( s1,s2,s3, solns ); // all points, no need to specify k1,k2,k3, they are all +1
+    default:
+        if (best_only)
+            return solvers.qll_best.solve( s1,k1,s2,k2,s3,k3, solns );
+        return solvers.qll.solve( s1,k1,s2,k2,s3,k3, solns ); // general case solver
+    }
+}
+
 VertexPositioner::VertexPositioner(HEGraph& gi): g(gi) {
-    ppp_solver = new PPPSolver<qd_real>();
-    //ppp_solver = new PPPSolver<double>(); // faster, but inaccurate
-    lll_solver = new LLLSolver();
-    qll_solver = new QLLSolver();
-    sep_solver = new SEPSolver();
-    errstat.clear();
+    solvers = new SolverSet();
+    solutions.reserve(8);
+    adaptive = false;
+    set_far_radius(1.0);
+    qll_best = false;
 }
 
 VertexPositioner::~VertexPositioner() {
-    delete ppp_solver;
-    delete lll_solver;
-    delete qll_solver;
-    delete sep_solver;
-    errstat.clear();
+    delete solvers;
+}
+
+std::vector<double> VertexPositioner::get_stat() const {
+    std::vector<double> errors;
+    for (unsigned int n=0; n<stats.num_worst(); n++)
+        errors.push_back( stats.worst(n).error );
+    return errors;
 }
 
 // calculate the position of a new vertex on the given edge e
@@ -59,48 +104,120 @@ VertexPositioner::~VertexPositioner() {
 // - site to the right of HEEdge e
 // - given new Site s
 Solution VertexPositioner::position(HEEdge e, Site* s3) {
-    edge = e;
+    set_edge(e);
     HEFace face = g[e].face;     
     HEEdge twin = g[e].twin;
     HEFace twin_face = g[twin].face;
 
+    Site* s1 =  g[face].site;
+    Site* s2 = g[twin_face].site;
+
+    Solution sl = position(  s1 , g[e].k, s2, g[twin].k, s3 );
+    return checked(sl, s3);
+}
+
+// position new vertices on all edges.
+// with adaptive precision the PPP vertices are computed with ppp_batch(), and validated
+// like the adaptive-precision solutions in position(s1,k1,s2,k2,s3). 
+// the rest, and the PPP vertices that fail validation, are positioned one by one.
+void VertexPositioner::position(const EdgeVector& edges, Site* s3, std::vector<Solution>& slns) {
+    slns.clear();
+    batch_slot.assign( edges.size(), -1 );
+    batch_ax.clear(); batch_ay.clear(); batch_bx.clear(); batch_by.clear();
+    batch_pi.clear(); batch_pk.clear();
+    if ( adaptive && s3->isPoint() ) {
+        for (unsigned int m=0; m<edges.size(); ++m) {
+            HEEdge e = edges[m];
+            Site* s1 = g[ g[e].face ].site;
+            Site* s2 = g[ g[ g[e].twin ].face ].site;
+            if ( g[e].type == SEPARATOR || !s1->isPoint() || !s2->isPoint() )
+                continue;
+            Point pi = s1->position();
+            Point pj = s2->position();
+            Point pk = s3->position();
+            ppp_order(pi,pj,pk);
+            batch_slot[m] = batch_ax.size();
+            batch_ax.push_back( pi.x - pk.x );
+            batch_ay.push_back( pi.y - pk.y );
+            batch_bx.push_back( pj.x - pk.x );
+            batch_by.push_back( pj.y - pk.y );
+            batch_pi.push_back( pi );
+            batch_pk.push_back( pk );
+        }
+    }
+    if ( !batch_ax.empty() ) {
+        batch_ux.resize( batch_ax.size() );
+        batch_uy.resize( batch_ax.size() );
+        ppp_batch( batch_ax.size(), &batch_ax[0], &batch_ay[0], &batch_bx[0], &batch_by[0], &batch_ux[0], &batch_uy[0] );
+        TELEMETRY( stats.calls[PPP_SOLVER][PRECISION_DOUBLE] += batch_ax.size() );
+    }
+    for (unsigned int m=0; m<edges.size(); ++m) {
+        int n = batch_slot[m];
+        if ( n >= 0 ) {
+            set_edge(edges[m]);
+            Point p( batch_ux[n] + batch_pk[n].x, batch_uy[n] + batch_pk[n].y );
+            Solution sl( p, (p - batch_pi[n]).norm(), +1 );
+            if ( t_min <= sl.t && sl.t <= t_max && dist_error(edge, sl, s3) <= adaptive_tolerance ) {
+                TELEMETRY( stats.solved[PPP_SOLVER][PRECISION_DOUBLE]++ );
+                slns.push_back( checked(sl, s3) );
+                continue;
+            }
+        }
+        slns.push_back( position(edges[m], s3) );
+    }
+}
+
+// set the edge on which we position a vertex, and the t-range of the solution
+void VertexPositioner::set_edge(HEEdge e) {
+    edge = e;
     HEVertex src = g.source(e);
     HEVertex trg = g.target(e);
     double t_src = g[src].dist();
     double t_trg = g[trg].dist();
     t_min = std::min( t_src, t_trg ); // the solution we seek must have t_min<t<t_max
     t_max = std::max( t_src, t_trg );
+}
 
-    Site* s1 =  g[face].site;
-    Site* s2 = g[twin_face].site;
-
-    Solution sl = position(  s1 , g[e].k, s2, g[twin].k, s3 );
-
+// sanity-checks and error logging of a solution on the current edge
+Solution VertexPositioner::checked(const Solution& sl, Site* s3) {
     assert( solution_on_edge(sl) );
     assert( check_far_circle(sl) );
     assert( check_dist(edge, sl, s3) );
     
-    // error logging (FIXME: make optional, for max performance?)
-    {
-        errstat.push_back( dist_error(edge, sl, s3) );
-        if ( dist_error(edge, sl, s3) > 1e-9 ) {
-            std::cout << " VertexPositioner::position() WARNING; large dist_error = " << dist_error(edge,  sl, s3) << "\n";
-        }
-    }
-    
+    TELEMETRY( record(sl, s3, dist_error(edge, sl, s3)) );
     return sl;
 }
 
+// record the errors of a solution on the current edge in the telemetry
+void VertexPositioner::record(const Solution& sl, Site* s3, double err) {
+    stats.dist_error.add( err );
+    stats.edge_error.add( g[edge].error(sl) );
+    if ( err > 1e-9 )
+        stats.large_errors++;
+    if ( stats.is_worst(err) ) {
+        HEEdge twin = g[edge].twin;
+        TripleRecord t;
+        t.s1 = SiteRecord( g[ g[edge].face ].site );
+        t.k1 = g[edge].k;
+        t.s2 = SiteRecord( g[ g[twin].face ].site );
+        t.k2 = g[twin].k;
+        t.s3 = SiteRecord( s3 );
+        t.solution = sl;
+        t.error = err;
+        stats.add_worst(t);
+    }
+}
+
 // find vertex that is equidistant from s1, s2, s3
 // should lie on the k1 side of s1, k2 side of s2
 // we try both k3=-1 and k3=+1 for s3
 Solution VertexPositioner::position(Site* s1, double k1, Site* s2, double k2, Site* s3) {
     assert( (k1==1) || (k1 == -1) );
     assert( (k2==1) || (k2 == -1) );
-    std::vector<Solution> solutions;
+    solutions.clear();
     
-    if ( g[edge].type == SEPARATOR && s1->isLine() && s2->isLine() ) {
-        // the parallell lineseg case
+    if ( g[edge].type == SEPARATOR && !s1->isPoint() && !s2->isPoint() ) {
+        // the parallell lineseg case, or the separator between the two sides of an arc
         if ( g[edge].has_null_face ) {
             s2 = g[ g[edge].null_face ].site;
             assert( s2->isPoint() ); // the sites of null-faces are allwais PointSite
@@ -110,76 +227,40 @@ Solution VertexPositioner::position(Site* s1, double k1, Site* s2, double k2, Si
             assert( s2->isPoint() );
             k2 = +1;
         }
-    } else if ( g[edge].type == SEPARATOR && s1->isPoint() && s2->isLine() ) {
-        // swap sites, so sep_solver can assume s1=line s2=point
+    } else if ( g[edge].type == SEPARATOR && s1->isPoint() && !s2->isPoint() ) {
+        // swap sites, so sep_solver can assume s1=line/arc s2=point
         Site* tmp = s1;
         double k_tmp = k1;
         s1 = s2;
         s2 = tmp;
         k1 = k2;
         k2 = k_tmp;
-        assert( s1->isLine() );
+        assert( !s1->isPoint() );
         assert( s2->isPoint() );
     }
     
-    solver_dispatch(s1,k1,s2,k2,s3,+1, solutions); // a single k3=+1 call for s3->isPoint()
-    
-    if (!s3->isPoint()) 
-        solver_dispatch(s1,k1,s2,k2,s3,-1, solutions); // for lineSite or ArcSite we try k3=-1 also    
-    
-    if (solutions.empty() ) 
-        std::cout << "WARNING empty solution set!!\n";
-        
-    if ( solutions.size() == 1 && (t_min<=solutions[0].t) && (t_max>=solutions[0].t) && (s3->in_region( solutions[0].p)) )
-        return solutions[0];
-    
-    // choose only in_region() solutions
-    solutions.erase( std::remove_if(solutions.begin(),solutions.end(), in_region_filter(s3) ), solutions.end() );
-    if (solutions.empty() ) 
-        std::cout << "WARNING in_region_filter() results in empty solution set!!\n";
-    
-    
-    // choose only t_min < t < t_max solutions 
-    solutions.erase( std::remove_if(solutions.begin(),solutions.end(), t_filter(t_min,t_max) ), solutions.end() );
-    if (solutions.empty() ) 
-        std::cout << "WARNING t_filter() results in empty solution set!!\n";
-
-    
-    
-    if ( solutions.size() == 1)
-        return solutions[0];
-    else if (solutions.size()>1) {
-        // two or more points remain so we must further filter here!
-        // filter further using edge_error
-        double min_error=100;
-        Solution min_solution(Point(0,0),0,0);
-        //std::cout << " edge_error filter: \n";
-        BOOST_FOREACH(Solution s, solutions) {
-            double err = g[edge].error(s);
-            //std::cout << s.p << " k3=" << s.k3 << " t=" <<  s.t << " err=" << err << "\n";
-            if ( err < min_error) {
-                min_solution = s;
-                min_error = err;
+    SolverType type = solver_type(s1,s2,s3);
+    Solution sl(Point(0,0),0,0);
+    if ( adaptive && type != SEP_SOLVER ) {
+        // try the cheaper number-types first.
+        // a solution is accepted if it is equidistant from the three sites
+        for (int prec=PRECISION_DOUBLE; prec<PRECISION_QD; prec++) {
+            if ( solve(s1,k1,s2,k2,s3, (SolverPrecision)prec, sl, false) && dist_error(edge, sl, s3) <= adaptive_tolerance ) {
+                TELEMETRY( stats.solved[type][prec]++ );
+                return sl;
             }
+            TELEMETRY( stats.escalations[type][prec]++ );
         }
-        if (min_error >= 1e-6) {
-            /*
-            std::cout << "WARNING: EDGE ERROR TOO LARGE\n";
-            std::cout << " s1 = " << s1->str2() << " k1= " << k1 << "\n";
-            std::cout << " s2 = " << s2->str2() << " k2= " << k2 << "\n";
-            std::cout << " s3 = " << s3->str2() << "\n";
-            std::cout << " sln=" << min_solution.p << " err=" << min_error << "\n";
-            std::cout << " edge: " << g[ g.source(edge) ].position << " - " << g[ g.target(edge) ].position;
-            std::cout << " edge-point(t="<<min_solution.t << ")= " << g[edge].point(min_solution.t) << "\n";
-            */
-            //assert(0);
-        }
-        //assert( min_error < 1e-6 );
-        return min_solution;
-    } 
+    }
+    
+    if ( solve(s1,k1,s2,k2,s3, PRECISION_QD, sl, true) ) {
+        TELEMETRY( stats.solved[type][ (type==SEP_SOLVER) ? PRECISION_DOUBLE : PRECISION_QD ]++ );
+        return sl;
+    }
 
     // either 0, or >= 2 solutions found. error.
     // std::cout << " None, or too many solutions found! solutions.size()=" << solutions.size() << "\n";
+#ifndef NDEBUG
     std::cout << " solution edge: " << g[ g.source(edge) ].position << "[" << g[ g.source(edge) ].type << "](t=" << g[ g.source(edge) ].dist() << ")";
     std::cout << " - " << g[ g.target(edge) ].position << "[" << g[ g.target(edge) ].type << "](t=" << g[ g.target(edge) ].dist() << ") \n";
     std::cout << " solution edge: " << g[ g.source(edge) ].index << "[" << g[ g.source(edge) ].type<<"]{" << g[ g.source(edge) ].status<<"}";
@@ -209,6 +290,7 @@ Solution VertexPositioner::position(Site* s1, double k1, Site* s2, double k2, Si
     }
 
     assert(0); // in Debug mode, stop here.
+#endif
     
     // try a desperate solution
     double t_mid = 0.5*(t_min+t_max);
@@ -226,27 +308,126 @@ Solution VertexPositioner::position(Site* s1, double k1, Site* s2, double k2, Si
         } else {
             desp_k3 = (s3->k()==1) ? 1 : -1;
         }
+    } else if ( s3->isArc() ) {
+        // outside or inside the circle
+        desp_k3 = ( (p_mid-Point(s3->x(),s3->y())).norm() > s3->r() ) ? 1 : -1;
     }
     Solution desp( p_mid, t_mid, desp_k3 ); // FIXME k3=1 is not correct here!
     
-    std::cout << "WARNING: Returning desperate solution: \n";
-    std::cout << desp.p << " t=" << desp.t << " k3=" << desp.k3  << " e_err=" << g[edge].error(desp) <<"\n";
+    TELEMETRY( stats.desperate++ );
     return desp;
 }
 
-int VertexPositioner::solver_dispatch(Site* s1, double k1, Site* s2, double k2, Site* s3, double k3, std::vector<Solution>& solns) {
+// run the solver at precision prec, and select a solution with select_solution()
+// with qll_best the best-conditioned permutation of QLLSolver is tried first, 
+// and all three permutations only if it gives no admissible solution.
+bool VertexPositioner::solve(Site* s1, double k1, Site* s2, double k2, Site* s3, SolverPrecision prec, Solution& sl, bool warn) {
+    if ( qll_best && solver_type(s1,s2,s3) == QLL_SOLVER ) {
+        solutions.clear();
+        solver_dispatch(s1,k1,s2,k2,s3,+1, solutions, prec, true);
+        if (!s3->isPoint())
+            solver_dispatch(s1,k1,s2,k2,s3,-1, solutions, prec, true);
+        if ( select_solution(s3, sl, false) )
+            return true;
+        TELEMETRY( stats.qll_fallbacks++ );
+    }
+    solutions.clear();
+    solver_dispatch(s1,k1,s2,k2,s3,+1, solutions, prec); // a single k3=+1 call for s3->isPoint()
+    if (!s3->isPoint()) 
+        solver_dispatch(s1,k1,s2,k2,s3,-1, solutions, prec); // for lineSite or ArcSite we try k3=-1 also    
+    return select_solution(s3, sl, warn);
+}
+
+// choose one solution among the candidates in solutions
+// returns false if all candidates are rejected.
+// with warn==true an empty candidate set is counted in the telemetry.
+bool VertexPositioner::select_solution(Site* s3, Solution& sl, bool warn) {
+    // a k3=-1 solution inside an arc can not be further than r from the arc
+    if ( s3->isArc() )
+        solutions.erase( std::remove_if(solutions.begin(),solutions.end(), arc_radius_filter(s3->r()) ), solutions.end() );
+    
+    if ( solutions.size() == 1 && (t_min<=solutions[0].t) && (t_max>=solutions[0].t) && (s3->in_region( solutions[0].p)) ) {
+        sl = solutions[0];
+        return true;
+    }
+    
+    // choose only in_region() solutions
+    solutions.erase( std::remove_if(solutions.begin(),solutions.end(), in_region_filter(s3) ), solutions.end() );
+    
+    // choose only t_min < t < t_max solutions 
+    solutions.erase( std::remove_if(solutions.begin(),solutions.end(), t_filter(t_min,t_max) ), solutions.end() );
+    
+    if ( solutions.size() == 1) {
+        sl = solutions[0];
+        return true;
+    } else if (solutions.size()>1) {
+        // two or more points remain so we must further filter here!
+        // filter further using edge_error
+        double min_error=100;
+        Solution min_solution(Point(0,0),0,0);
+        //std::cout << " edge_error filter: \n";
+        BOOST_FOREACH(Solution s, solutions) {
+            double err = g[edge].error(s);
+            //std::cout << s.p << " k3=" << s.k3 << " t=" <<  s.t << " err=" << err << "\n";
+            if ( err < min_error) {
+                min_solution = s;
+                min_error = err;
+            }
+        }
+        if (min_error >= 1e-6) {
+            /*
+            std::cout << "WARNING: EDGE ERROR TOO LARGE\n";
+            std::cout << " s1 = " << s1->str2() << " k1= " << k1 << "\n";
+            std::cout << " s2 = " << s2->str2() << " k2= " << k2 << "\n";
+            std::cout << " s3 = " << s3->str2() << "\n";
+            std::cout << " sln=" << min_solution.p << " err=" << min_error << "\n";
+            std::cout << " edge: " << g[ g.source(edge) ].position << " - " << g[ g.target(edge) ].position;
+            std::cout << " edge-point(t="<<min_solution.t << ")= " << g[edge].point(min_solution.t) << "\n";
+            */
+            //assert(0);
+        }
+        //assert( min_error < 1e-6 );
+        sl = min_solution;
+        return true;
+    } 
+    TELEMETRY( if (warn) stats.empty_solutions++ );
+    return false;
+}
+
+// the solver for the (s1,s2,s3) site-kind triple
+SolverType VertexPositioner::solver_type(Site* s1, Site* s2, Site* s3) {
     if ( g[edge].type == SEPARATOR )
-        return sep_solver->solve(s1,k1,s2,k2,s3,k3,solns); // we have previously set s1(line) s2(point)
-    else if ( s1->isLine() && s2->isLine() && s3->isLine() ) 
-        return lll_solver->solve( s1,k1,s2,k2,s3,k3, solns ); // all lines.
-    else if ( s1->isPoint() && s2->isPoint() && s3->isPoint() )
-        return ppp_solver->solve( s1,s2,s3, solns ); // all points, no need to specify k1,k2,k3, they are all +1
-    else
-        return qll_solver->solve( s1,k1,s2,k2,s3,k3, solns ); // general case solver
- 
+        return SEP_SOLVER;
+    // the set of site-kinds, as bits
+    unsigned int kinds = (1u << s1->kind()) | (1u << s2->kind()) | (1u << s3->kind());
+    switch (kinds) {
+    case (1u << SITE_LINE):
+        return LLL_SOLVER; // all lines
+    case (1u << SITE_POINT):
+        return PPP_SOLVER; // all points
+    default:
+        return QLL_SOLVER; // general case
+    }
 }
 
-bool VertexPositioner::solution_on_edge(Solution& s) {
+// a single switch on the solver type and precision. 
+// the solvers are called directly, without virtual calls.
+int VertexPositioner::solver_dispatch(Site* s1, double k1, Site* s2, double k2, Site* s3, double k3, std::vector<Solution>& solns, SolverPrecision prec, bool best_only) {
+    SolverType type = solver_type(s1,s2,s3);
+    TELEMETRY( stats.calls[type][ (type==SEP_SOLVER) ? PRECISION_DOUBLE : prec ]++ );
+    if ( type == SEP_SOLVER )
+        return solvers->sep.solve(s1,k1,s2,k2,s3,k3,solns); // we have previously set s1(line) s2(point)
+    switch (prec) {
+    case PRECISION_DOUBLE:
+        return dispatch( solvers->d, type, best_only, s1,k1,s2,k2,s3,k3, solns);
+    case PRECISION_DD:
+        return dispatch( solvers->dd, type, best_only, s1,k1,s2,k2,s3,k3, solns);
+    default:
+        return dispatch( solvers->qd, type, best_only, s1,k1,s2,k2,s3,k3, solns);
+    }
+}
+
+bool VertexPositioner::solution_on_edge(const Solution& s) {
     double err = g[edge].error(s);
     double limit = 9E-4;
     if ( err>=limit ) {
@@ -272,7 +453,7 @@ double VertexPositioner::edge_error(HEEdge e, Solution& s) {
 }*/
 
 // new vertices should lie within the far_radius
-bool VertexPositioner::check_far_circle(Solution& s) {
+bool VertexPositioner::check_far_circle(const Solution& s) {
     if (!(s.p.norm() < 18*1)) {
         std::cout << "WARNING check_far_circle() new vertex outside far_radius! \n";
         std::cout << s.p << " norm=" << s.p.norm() << " far_radius=" << 1 << "\n"; 
@@ -295,9 +476,7 @@ bool VertexPositioner::check_dist(HEEdge e, const Solution& sl, Site* s3) {
     double d2 = (sl.p - s2->apex_point(sl.p) ).norm();  
     double d3 = (sl.p - s3->apex_point(sl.p) ).norm(); 
     
-    double maxd = std::max( std::max( fabs(sl.t-d1),fabs(sl.t-d2)) , fabs(sl.t-d3));
-    errstat.push_back(maxd);
-        
+
     if ( !equal(d1,d2) || !equal(d1,d3) || !equal(d2,d3) ||
          !equal(sl.t,d1) || !equal(sl.t,d2) || !equal(sl.t,d3) ) {
         std::cout << "WARNING check_dist() ! \n";
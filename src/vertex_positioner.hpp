@@ -25,10 +25,11 @@
 #include "graph.hpp"
 #include "vertex.hpp"
 #include "solvers/solution.hpp"
+#include "telemetry.hpp"
 
 namespace ovd {
 
-class Solver;
+struct SolverSet;
 
 // predicate for filtering solutions based on t-value being in [tmin,tmax] range
 struct t_filter {
@@ -57,7 +58,32 @@ private:
     Site* site_;
 };
 
+// predicate for rejecting solutions at a negative distance from the circle of an arc,
+// i.e. k3=-1 solutions with t larger than the radius
+struct arc_radius_filter {
+    arc_radius_filter(double r): r_(r) {}
+    bool operator()(Solution s) { 
+        return (r_ + s.k3*s.t) < -1e-9; // the center of the arc, at t=r, is allowed
+    }
+private:
+    double r_;
+};
+
+/// the number-type used by a solver.
+/// PRECISION_DOUBLE: double, PRECISION_DD: double-double (dd_real), PRECISION_QD: quad-double (qd_real)
+enum SolverPrecision {PRECISION_DOUBLE, PRECISION_DD, PRECISION_QD};
+/// the solvers to which VertexPositioner dispatches, see solver_dispatch()
+enum SolverType {PPP_SOLVER, LLL_SOLVER, QLL_SOLVER, SEP_SOLVER};
+
 /// Calculates the (x,y) position of vertices in a voronoi diagram
+///
+/// By default all vertices are positioned with the qd_real solvers.
+/// With set_adaptive_precision(true) the double solver is tried first, then dd_real,
+/// and a solution is accepted only if its dist_error() is below a tolerance.
+/// The qd_real solver is used only when the cheaper solvers fail this test.
+///
+/// Solver calls, errors, and failures are recorded in a Telemetry, see get_telemetry().
+/// Compile with OVD_NO_TELEMETRY to remove the recording.
 class VertexPositioner {
 public:
     VertexPositioner(HEGraph& gi);
@@ -66,32 +92,83 @@ public:
     /// The new vertex is equidistant to the two sites that defined the edge
     /// and to the new site. 
     Solution position( HEEdge e, Site* s);
+    /// position new vertices on all the given edges, in order. 
+    /// The same as calling position(e,s) for each edge, but with adaptive precision 
+    /// the point-point-point cases are first solved together with ppp_batch().
+    void position(const EdgeVector& edges, Site* s, std::vector<Solution>& slns);
 
-    std::vector<double> get_stat() {return errstat;}
+    /// the dist_error() of the worst positioned vertices, see Telemetry::worst()
+    std::vector<double> get_stat() const;
+    /// numerical health of the positioned vertices
+    const Telemetry& get_telemetry() const { return stats; }
+    /// set all telemetry to zero
+    void reset_telemetry() { stats.reset(); }
     double dist_error(HEEdge e, const Solution& sl, Site* s3);
+    /// try double and dd_real solvers before qd_real.
+    /// ppp_batch() computes double solutions, so position(edges,s,slns) uses it only when this is on.
+    void set_adaptive_precision(bool on) { adaptive = on; }
+    /// true if adaptive precision is on
+    bool get_adaptive_precision() const { return adaptive; }
+    /// the size of the diagram. the adaptive precision tolerance is relative to this,
+    /// so that the same solutions are accepted when the input is scaled.
+    void set_far_radius(double far) { adaptive_tolerance = 1e-12*far; }
+    /// number of vertices positioned by the given solver at the given precision
+    int num_solved(SolverType t, SolverPrecision p) const { return stats.solved[t][p]; }
+    /// number of times the given solver at the given precision failed
+    /// the dist_error() test, so that a higher precision was tried
+    int num_escalations(SolverType t, SolverPrecision p) const { return stats.escalations[t][p]; }
+    /// solve only the best-conditioned elimination in QLLSolver, and
+    /// fall back to all three only when it gives no admissible solution
+    void set_qll_best_only(bool on) { qll_best = on; }
+    /// true if set_qll_best_only() is on
+    bool get_qll_best_only() const { return qll_best; }
+    /// number of times the best-conditioned QLL elimination gave no admissible solution
+    int num_qll_fallbacks() const { return stats.qll_fallbacks; }
 private:
+    void set_edge(HEEdge e);
+    Solution checked(const Solution& sl, Site* s3);
+    void record(const Solution& sl, Site* s3, double err);
     Solution position(Site* s1, double k1, Site* s2, double k2, Site* s3);
+    bool solve(Site* s1, double k1, Site* s2, double k2, Site* s3, 
+               SolverPrecision prec, Solution& sl, bool warn);
+    bool select_solution(Site* s3, Solution& sl, bool warn);
+    SolverType solver_type(Site* s1, Site* s2, Site* s3);
     int solver_dispatch(Site* s1, double k1, 
                Site* s2, double k2, 
-               Site* s3, double k3, std::vector<Solution>& slns ); 
+               Site* s3, double k3, std::vector<Solution>& slns,
+               SolverPrecision prec = PRECISION_QD, bool best_only = false ); 
 
 // geometry-checks
-    bool solution_on_edge(Solution& s);
-    bool check_far_circle(Solution& s);
+    bool solution_on_edge(const Solution& s);
+    bool check_far_circle(const Solution& s);
     bool check_dist(HEEdge e, const Solution& s, Site* s3);
     bool equal(double d1, double d2);
     
-// solvers, to which we dispatch, depending on the input sites
-    Solver* ppp_solver;
-    Solver* lll_solver;
-    Solver* qll_solver;
-    Solver* sep_solver;
+// solvers, to which we dispatch, depending on the input sites.
+// a set of solvers for each SolverPrecision, see vertex_positioner.cpp
+    SolverSet* solvers;
 // DATA
     HEGraph& g; // reference to the VD graph.
     double t_min;
     double t_max;
     HEEdge edge;
-    std::vector<double> errstat;
+    /// candidate solutions from the solvers. re-used for each call to position()
+    std::vector<Solution> solutions;
+    /// adaptive precision on/off
+    bool adaptive;
+    /// with adaptive precision, solutions with a dist_error() larger than this are rejected.
+    /// set by set_far_radius()
+    double adaptive_tolerance;
+    /// telemetry, see get_telemetry()
+    Telemetry stats;
+    /// edges[m] of position(edges,s,slns) is batch_slot[m] in the ppp_batch() arrays, or -1
+    std::vector<int> batch_slot;
+    /// ppp_batch() input and output
+    std::vector<double> batch_ax, batch_ay, batch_bx, batch_by, batch_ux, batch_uy;
+    /// the corners pi and pk of each triangle in ppp_batch()
+    std::vector<Point> batch_pi, batch_pk;
+    /// QLLSolver mode, see set_qll_best_only()
+    bool qll_best;
 };
 
 }
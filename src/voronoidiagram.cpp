@@ -18,6 +18,8 @@
 */
 
 #include <cassert>
+#include <algorithm>
+#include <fstream>
 
 #include <boost/foreach.hpp>
 #include <boost/math/tools/roots.hpp> // for toms748
@@ -29,19 +31,45 @@
 #include "facegrid.hpp"
 #include "checker.hpp"
 #include "common/numeric.hpp" // for diangle
+#include "common/spatial_sort.hpp" // for brio_order
+#include "diagram_file.hpp"
 
 namespace ovd {
 
 VoronoiDiagram::VoronoiDiagram(double far, unsigned int n_bins) {
-    fgrid = new FaceGrid(far, n_bins); // helper-class for nearest-neighbor search 
+    fgrid = 0;
+    if (n_bins > 0)
+        fgrid = new FaceGrid(far, n_bins); // helper-class for nearest-neighbor search 
     vd_checker = new VoronoiDiagramChecker( g ); // helper-class that checks topology/geometry
     vpos = new VertexPositioner( g ); // helper-class that positions vertices
     far_radius=far;
+    vpos->set_far_radius(far);
+    next_vertex_index=0;
     initialize();
     num_psites=3;
     num_lsites=0;
-    reset_vertex_count();
+    num_asites=0;
+    last_face=0;
+    epoch=0;
+    face_mark_epoch=0;
     debug = false;
+#ifdef NDEBUG
+    validation = VALIDATE_NONE;
+#else
+    validation = VALIDATE_FULL;
+#endif
+    validation_failures = 0;
+    // pre-size the per-insertion scratch space
+    v0.reserve(64);
+    modified_vertices.reserve(128);
+    incident_faces.reserve(64);
+    vertexQueue.reserve(64);
+    in_out_edges.reserve(64);
+    new_solutions.reserve(64);
+    start_verts.reserve(16);
+    split_edges.reserve(16);
+    adjacent_faces.reserve(4);
+    modified_faces.reserve(64);
 }
 
 VoronoiDiagram::~VoronoiDiagram() { 
@@ -50,6 +78,12 @@ VoronoiDiagram::~VoronoiDiagram() {
     delete vpos;
 }
 
+// add a vertex to the graph, and give it the next vertex index of this diagram
+HEVertex VoronoiDiagram::add_vertex(VoronoiVertex v) {
+    v.index = next_vertex_index++;
+    return g.add_vertex(v);
+}
+
 // add one vertex at origo and three vertices at 'infinity' and their associated edges
 void VoronoiDiagram::initialize() {
     using namespace boost::assign;
@@ -63,19 +97,19 @@ void VoronoiDiagram::initialize() {
     Point vd2 = Point( +3.0*sqrt(3.0)*far_radius*far_multiplier/2.0, +3.0*far_radius*far_multiplier/2.0);
     Point vd3 = Point( -3.0*sqrt(3.0)*far_radius*far_multiplier/2.0, +3.0*far_radius*far_multiplier/2.0);
     // add init vertices
-    HEVertex v00 = g.add_vertex( VoronoiVertex( Point(0,0), UNDECIDED, NORMAL, gen1 ) );
-    HEVertex v01 = g.add_vertex( VoronoiVertex( vd1, OUT, OUTER, gen3) );
-    HEVertex v02 = g.add_vertex( VoronoiVertex( vd2, OUT, OUTER, gen1) );
-    HEVertex v03 = g.add_vertex( VoronoiVertex( vd3, OUT, OUTER, gen2) );
+    HEVertex v00 = add_vertex( VoronoiVertex( Point(0,0), UNDECIDED, NORMAL, gen1 ) );
+    HEVertex v01 = add_vertex( VoronoiVertex( vd1, OUT, OUTER, gen3) );
+    HEVertex v02 = add_vertex( VoronoiVertex( vd2, OUT, OUTER, gen1) );
+    HEVertex v03 = add_vertex( VoronoiVertex( vd3, OUT, OUTER, gen2) );
     // add initial sites to graph (if vertex_descriptors not held, why do we do this??)
-    g.add_vertex( VoronoiVertex( gen1 , OUT, POINTSITE) );
-    g.add_vertex( VoronoiVertex( gen2 , OUT, POINTSITE) );
-    g.add_vertex( VoronoiVertex( gen3 , OUT, POINTSITE) );
+    add_vertex( VoronoiVertex( gen1 , OUT, POINTSITE) );
+    add_vertex( VoronoiVertex( gen2 , OUT, POINTSITE) );
+    add_vertex( VoronoiVertex( gen3 , OUT, POINTSITE) );
 
     // apex-points on the three edges: 
-    HEVertex a1 = g.add_vertex( VoronoiVertex( 0.5*(gen2+gen3), UNDECIDED, APEX, gen2 ) );
-    HEVertex a2 = g.add_vertex( VoronoiVertex( 0.5*(gen1+gen3), UNDECIDED, APEX, gen3 ) );
-    HEVertex a3 = g.add_vertex( VoronoiVertex( 0.5*(gen1+gen2), UNDECIDED, APEX, gen1 ) );
+    HEVertex a1 = add_vertex( VoronoiVertex( 0.5*(gen2+gen3), UNDECIDED, APEX, gen2 ) );
+    HEVertex a2 = add_vertex( VoronoiVertex( 0.5*(gen1+gen3), UNDECIDED, APEX, gen3 ) );
+    HEVertex a3 = add_vertex( VoronoiVertex( 0.5*(gen1+gen2), UNDECIDED, APEX, gen1 ) );
 
     // add face 1: v0-v1-v2 which encloses gen3
     HEEdge e1_1 =  g.add_edge( v00 , a1 );    
@@ -86,7 +120,7 @@ void VoronoiDiagram::initialize() {
     HEFace f1   =  g.add_face(); 
     g[f1].site  = new PointSite(gen3,f1);
     g[f1].status = NONINCIDENT;
-    fgrid->add_face( g[f1] ); // for grid search
+    if (fgrid) fgrid->add_face( g[f1] ); // for grid search
     g.set_next_cycle( list_of(e1_1)(e1_2)(e2)(e3_1)(e3_2) , f1 ,1);
 
     // add face 2: v0-v02-v03 which encloses gen1
@@ -98,7 +132,7 @@ void VoronoiDiagram::initialize() {
     HEFace f2   =  g.add_face();
     g[f2].site  = new PointSite(gen1,f2);
     g[f2].status = NONINCIDENT;    
-    fgrid->add_face( g[f2] );
+    if (fgrid) fgrid->add_face( g[f2] );
     g.set_next_cycle( list_of(e4_1)(e4_2)(e5)(e6_1)(e6_2) , f2 ,1);
 
     // add face 3: v0-v3-v1 which encloses gen2
@@ -110,7 +144,7 @@ void VoronoiDiagram::initialize() {
     HEFace f3   =  g.add_face();
     g[f3].site  = new PointSite(gen2,f3); // this constructor needs f3...
     g[f3].status = NONINCIDENT;    
-    fgrid->add_face( g[f3] );
+    if (fgrid) fgrid->add_face( g[f3] );
     g.set_next_cycle( list_of(e7_1)(e7_2)(e8)(e9_1)(e9_2) , f3 , 1);    
 
     // set type. (note that edge-params x[8] and y[8] are not set!
@@ -119,16 +153,16 @@ void VoronoiDiagram::initialize() {
     g[e2].type = OUTEDGE; 
     g[e3_1].type = LINE; g[e3_1].set_parameters(g[f2].site, g[f1].site, true);
     g[e3_2].type = LINE; g[e3_2].set_parameters(g[f2].site, g[f1].site, false);
-    g[e4_1].type = LINE; g[e4_1].set_parameters(g[f2].site, g[f1].site, false);
-    g[e4_2].type = LINE; g[e4_2].set_parameters(g[f2].site, g[f1].site, true);
+    g[e4_1].type = LINE; g[e4_1].share_parameters( g[e3_2] );
+    g[e4_2].type = LINE; g[e4_2].share_parameters( g[e3_1] );
     g[e5].type = OUTEDGE;
     g[e6_1].type = LINE; g[e6_1].set_parameters(g[f2].site, g[f3].site, false);
     g[e6_2].type = LINE; g[e6_2].set_parameters(g[f2].site, g[f3].site, true);
-    g[e7_1].type = LINE; g[e7_1].set_parameters(g[f2].site, g[f3].site, true);
-    g[e7_2].type = LINE; g[e7_2].set_parameters(g[f2].site, g[f3].site, false);
+    g[e7_1].type = LINE; g[e7_1].share_parameters( g[e6_2] );
+    g[e7_2].type = LINE; g[e7_2].share_parameters( g[e6_1] );
     g[e8].type = OUTEDGE;
-    g[e9_1].type = LINE; g[e9_1].set_parameters(g[f1].site, g[f3].site, true);
-    g[e9_2].type = LINE; g[e9_2].set_parameters(g[f1].site, g[f3].site, false);
+    g[e9_1].type = LINE; g[e9_1].share_parameters( g[e1_2] ); // twins share their parameters
+    g[e9_2].type = LINE; g[e9_2].share_parameters( g[e1_1] );
     
     // twin edges
     g.twin_edges(e1_1,e9_2);
@@ -158,41 +192,106 @@ void VoronoiDiagram::initialize() {
 /// returns an integer handle to the inserted point. use this integer when inserting lines/arcs
 int VoronoiDiagram::insert_point_site(const Point& p, int step) {
     num_psites++;
+    epoch++;
+    prof.begin(SITE_POINT);
     int current_step=1;
     assert( p.norm() < far_radius );     // only add vertices within the far_radius circle
     
-    HEVertex new_vert = g.add_vertex( VoronoiVertex(p,OUT,POINTSITE) );
+    HEVertex new_vert = add_vertex( VoronoiVertex(p,OUT,POINTSITE) );
     Site* new_site =  new PointSite(p);
     vertex_map.insert( std::pair<int,HEVertex>(g[new_vert].index,new_vert) ); // so that we can find the descriptor later based on its index
 
-    HEVertex v_seed = find_seed_vertex( fgrid->grid_find_closest_face( p ), new_site);
+    HEVertex v_seed = find_seed_vertex( find_closest_face( p ), new_site);
     mark_vertex( v_seed, new_site );
+    prof.lap(PHASE_SEED);
 if (step==current_step) return -1; current_step++;
     augment_vertex_set( new_site ); // grow the tree to maximum size
+    prof.lap(PHASE_AUGMENT);
 if (step==current_step) return -1; current_step++;
     add_vertices( new_site );  // insert new vertices on IN-OUT edges
+    prof.lap(PHASE_ADD_VERTICES);
+    prof.sizes( v0.size(), incident_faces.size(), in_out_edges.size() );
 if (step==current_step) return -1; current_step++;
     HEFace newface = add_face( new_site );
     g[new_vert].face = newface;
+    last_face = newface;
     BOOST_FOREACH( HEFace f, incident_faces ) { // add NEW-NEW edges on all INCIDENT faces
         add_edges(newface, f);
     }
+    prof.lap(PHASE_ADD_EDGES);
 if (step==current_step) return -1; current_step++;
     repair_face( newface  );
+    prof.lap(PHASE_REPAIR);
     if (debug) { std::cout << " new face: "; g.print_face( newface ); }
     remove_vertex_set(); // remove all IN vertices and adjacent edges
+    prof.lap(PHASE_REMOVE);
 if (step==current_step) return -1; current_step++;
+    modified_faces = incident_faces;
+    modified_faces.push_back( newface );
     reset_status(); // reset all vertices to UNDECIDED
-    assert( vd_checker->face_ok( newface ) );
-    assert( vd_checker->is_valid() );
+    reclaim_edge_indices();
+    prof.lap(PHASE_RESET);
+    validate( "insert_point_site", modified_faces );
+    prof.lap(PHASE_VALIDATE);
+    prof.end();
     return g[new_vert].index;
 }
 
+/// insert many point sites into the diagram
+/// the points are inserted in a biased randomized insertion order (BRIO) along a Hilbert curve,
+/// so that consecutive insertions touch nearby parts of the diagram.
+/// returns the integer handles of the inserted points, in the same order as the input.
+/// points that are not inside the far-radius circle are skipped, and get the handle -1.
+std::vector<int> VoronoiDiagram::insert_point_sites(const std::vector<Point>& points) {
+    std::vector<int> handles( points.size(), -1 );
+    // brio_order() needs finite coordinates, so the points outside are removed first
+    std::vector<Point> inside;
+    std::vector<unsigned int> inside_index;
+    inside.reserve( points.size() );
+    inside_index.reserve( points.size() );
+    for (unsigned int m=0; m<points.size(); ++m) {
+        if ( points[m].norm() < far_radius ) { // false also for NaN coordinates
+            inside.push_back( points[m] );
+            inside_index.push_back( m );
+        }
+    }
+    std::vector<unsigned int> order = brio_order(inside);
+    BOOST_FOREACH( unsigned int m, order ) {
+        handles[ inside_index[m] ] = insert_point_site( inside[m] );
+    }
+    return handles;
+}
+
+/// insert many line-segment sites into the diagram, in the given order.
+/// each segment is a pair of handles returned from insert_point_site() or insert_point_sites().
+/// returns an InsertStatus for each segment. Segments with an unknown handle, and segments
+/// that are already in the diagram (in either direction), are skipped.
+std::vector<int> VoronoiDiagram::insert_line_sites(const std::vector< std::pair<int,int> >& segments) {
+    std::vector<int> status( segments.size(), INSERT_OK );
+    for (unsigned int m=0; m<segments.size(); ++m) {
+        int idx1 = segments[m].first;
+        int idx2 = segments[m].second;
+        if ( idx1 == idx2 || vertex_map.find(idx1) == vertex_map.end() || vertex_map.find(idx2) == vertex_map.end() ) {
+            status[m] = INSERT_BAD_HANDLE;
+            continue;
+        }
+        HEVertex start=HEVertex(), end=HEVertex();
+        boost::tie(start,end) = find_endpoints(idx1,idx2);
+        if ( has_line_site(start,end) ) {
+            status[m] = INSERT_DUPLICATE;
+            continue;
+        }
+        insert_line_site(idx1, idx2);
+    }
+    return status;
+}
+
 /// insert a line-segment site into the diagram
 /// idx1 and idx2 should be int-handles returned from insert_point_site()
 bool VoronoiDiagram::insert_line_site(int idx1, int idx2, int step) {
     num_lsites++;
-    int current_step=1;
+    epoch++;
+    prof.begin(SITE_LINE);
     // find the vertices corresponding to idx1 and idx2
     HEVertex start=HEVertex(), end=HEVertex();
     boost::tie(start,end) = find_endpoints(idx1,idx2);
@@ -203,15 +302,49 @@ bool VoronoiDiagram::insert_line_site(int idx1, int idx2, int step) {
     // then we know which site/face is the k==+1 and which is k==-1
     Point src_se = g[start].position;
     Point trg_se = g[end  ].position;
-    Point left = 0.5*(src_se+trg_se) + (trg_se-src_se).xy_perp(); // this is used below and in find_null_face()
+    Point left = 0.5*(src_se+trg_se) + (trg_se-src_se).xy_perp();
     bool linesite_k_sign = left.is_right(src_se,trg_se); 
 
+    return insert_segment_site(start, end, trg_se-src_se, src_se-trg_se, linesite_k_sign, SITE_LINE, Point(0,0), false, step);
+}
+
+/// insert an arc site into the diagram
+/// idx1 and idx2 should be int-handles returned from insert_point_site().
+/// the arc runs from idx1 to idx2 around center, clockwise if cw is true.
+/// the end-points must be at the same distance from the center, and the 
+/// arc must span less than a half-circle.
+bool VoronoiDiagram::insert_arc_site(int idx1, int idx2, const Point& center, bool cw, int step) {
+    num_asites++;
+    epoch++;
+    prof.begin(SITE_ARC);
+    HEVertex start=HEVertex(), end=HEVertex();
+    boost::tie(start,end) = find_endpoints(idx1,idx2);
+    if (debug) std::cout << "insert_arc_site( " << g[start].index << " - " << g[end].index << " cw=" << cw << " )\n";
+    if (cw) // from here on the arc runs counter-clockwise from start to end
+        std::swap(start,end);
+    Point s = g[start].position - center;
+    Point e = g[end].position - center;
+    assert( fabs( s.norm() - e.norm() ) < 1e-9*std::max( 1.0, s.norm() ) ); // end-points on the same circle
+    assert( s.cross(e) > 0 ); // less than a half-circle
+    
+    // the tangents at the end-points, pointing into the arc.
+    // the k==+1 face is outside the circle, i.e. to the right of the ccw tangent,
+    // just like the k==+1 face of a line-site is to the right of src->trg
+    return insert_segment_site(start, end, s.xy_perp(), e.xy_perp()*(-1), false, SITE_ARC, center, cw, step);
+}
+
+// insert a line-site or an arc-site between the point-sites start and end.
+// start_dir and end_dir are the directions from the end-points into the site, and
+// k3_sign is true if the k==+1 face is to the left of start_dir.
+// center and cw are used only for arc-sites.
+bool VoronoiDiagram::insert_segment_site(HEVertex start, HEVertex end, Point start_dir, Point end_dir, 
+                                         bool k3_sign, SiteKind kind, const Point& center, bool cw, int step) {
+    int current_step=1;
     g[start].status=OUT;
     g[end].status=OUT;   
     g[start].zero_dist();
     g[end].zero_dist();
 
-    Point start_dir = (g[end].position - g[start].position)*(-1);
     HEVertex seg_start, seg_end; // new segment end-point vertices
     HEFace start_null_face, end_null_face; // either existing or new null-faces at endpoints
     
@@ -224,8 +357,8 @@ bool VoronoiDiagram::insert_line_site(int idx1, int idx2, int step) {
     HEFace   end_to_null = g.HFace();
     
     // returns new seg_start/end vertices, new or existing null-faces, and separator endpoints (if separators should be added)
-    boost::tie(seg_start, start_null_face, pos_sep_start, neg_sep_start, start_to_null) = find_null_face(start, end  , left);
-    boost::tie(seg_end  , end_null_face  , pos_sep_end  , neg_sep_end, end_to_null  ) = find_null_face(end  , start, left);
+    boost::tie(seg_start, start_null_face, pos_sep_start, neg_sep_start, start_to_null) = find_null_face(start, start_dir, k3_sign);
+    boost::tie(seg_end  , end_null_face  , pos_sep_end  , neg_sep_end, end_to_null  ) = find_null_face(end  , end_dir, !k3_sign);
         
     if (debug) {
         std::cout << " start null face : "; g.print_face(start_null_face);
@@ -242,14 +375,18 @@ bool VoronoiDiagram::insert_line_site(int idx1, int idx2, int step) {
         
     // create positive and negative Site and edge
     HEFace pos_face, neg_face;   
-    boost::tie(pos_face,neg_face) = add_linesite_edges(seg_start,seg_end,linesite_k_sign); 
+    if (kind == SITE_ARC)
+        boost::tie(pos_face,neg_face) = add_arcsite_edges(seg_start,seg_end,center,cw); 
+    else
+        boost::tie(pos_face,neg_face) = add_linesite_edges(seg_start,seg_end,k3_sign); 
 
-    if (debug) std::cout << " created pos/neg LineSite pos_face=" << pos_face << " neg_face=" << neg_face<< "\n";
+    if (debug) std::cout << " created pos/neg Site pos_face=" << pos_face << " neg_face=" << neg_face<< "\n";
 
     // the start_face/end_face should belong to the point-site at start/end
     // this is the face where possible separators are inserted later.
     HEFace start_face = find_pointsite_face(start_null_edge); // should be find_seed_face (?) because in some cases there may not be a point-site face!!
     HEFace end_face = find_pointsite_face(end_null_edge);
+    prof.lap(PHASE_NULL_FACE);
 
 if (step==current_step) return false; current_step++;
     if (debug)
@@ -266,10 +403,12 @@ if (step==current_step) return false; current_step++;
         g[start_to_null].edge = start_null_edge; 
     if (end_to_null!=g.HFace())
         g[end_to_null].edge = end_null_edge; 
+    prof.lap(PHASE_SEED);
 
 if (step==current_step) return false; current_step++;
 
     augment_vertex_set( g[pos_face].site  ); // it should not matter if we use pos_site or neg_site here
+    prof.lap(PHASE_AUGMENT);
     // todo(?) sanity checks:
     // check that end_face is INCIDENT? 
     // check that tree (i.e. v0) includes end_face_seed ?
@@ -281,6 +420,8 @@ if (step==current_step) return false; current_step++;
 if (step==current_step) return false; current_step++;
 
     add_vertices( g[pos_face].site );  // add NEW vertices on all IN-OUT edges.
+    prof.lap(PHASE_ADD_VERTICES);
+    prof.sizes( v0.size(), incident_faces.size(), in_out_edges.size() );
 
 if (step==current_step) return false; current_step++;
     
@@ -313,6 +454,7 @@ if (step==current_step) return false; current_step++;
 
     g[end_face].status = NONINCIDENT;
     assert( vd_checker->face_ok( end_face ) );
+    prof.lap(PHASE_SEPARATORS);
 
     if(debug) std::cout << " all separators  done.\n";
 
@@ -328,10 +470,17 @@ if (step==current_step) return false; current_step++;
             add_edges( pos_face, f, neg_face, std::make_pair(seg_start,seg_end)); // each INCIDENT face is split into two parts: newface and f
         }
     }
+    prof.lap(PHASE_ADD_EDGES);
 
 if (step==current_step) return false; current_step++;
 
     remove_vertex_set();
+    // a split-vertex inserted by augment_vertex_set() may have moved the edge of a nulled face
+    if (start_to_null!=g.HFace())
+        g[start_to_null].edge = start_null_edge; 
+    if (end_to_null!=g.HFace())
+        g[end_to_null].edge = end_null_edge; 
+    prof.lap(PHASE_REMOVE);
 
     if (debug) { std::cout << "will now repair pos/neg faces: " << pos_face << " " << neg_face << "\n"; }
 
@@ -344,6 +493,9 @@ if (step==current_step) return false; current_step++;
                           std::make_pair(start_to_null,end_to_null),
                           std::make_pair(start_null_face,end_null_face) );
     assert( vd_checker->face_ok( neg_face ) );
+    if ( kind == SITE_ARC )
+        remove_center_vertex();
+    prof.lap(PHASE_REPAIR);
 
 if (step==current_step) return false; current_step++;
 
@@ -351,11 +503,15 @@ if (step==current_step) return false; current_step++;
     BOOST_FOREACH(HEFace f, incident_faces) {
         remove_split_vertex(f);
     }
+    prof.lap(PHASE_SPLIT);
+    modified_faces = incident_faces;
     reset_status();
+    reclaim_edge_indices();
+    prof.lap(PHASE_RESET);
     
     if (debug) {
         std::cout << "faces " << start_face << " " << end_face << " " << pos_face << " " << neg_face << " repaired \n";
-        std::cout << "insert_line_site(" << g[start].index << "-"<< g[end].index << ") done.\n";
+        std::cout << "insert_segment_site(" << g[start].index << "-"<< g[end].index << ") done.\n";
         std::cout << " start_face "; g.print_face(start_face);
         std::cout << " start_null_face "; g.print_face(start_null_face);
         std::cout << " end_face "; g.print_face(end_face);
@@ -363,13 +519,15 @@ if (step==current_step) return false; current_step++;
         std::cout << " pos_face "; g.print_face(pos_face);
         std::cout << " neg_face "; g.print_face(neg_face);
     }
-    assert( vd_checker->face_ok( start_face ) );
-    assert( vd_checker->face_ok( start_null_face ) );
-    assert( vd_checker->face_ok( end_face ) );
-    assert( vd_checker->face_ok( end_null_face ) );
-    assert( vd_checker->face_ok( pos_face ) );
-    assert( vd_checker->face_ok( neg_face ) );    
-    assert( vd_checker->is_valid() );
+    modified_faces.push_back( start_face );
+    modified_faces.push_back( start_null_face );
+    modified_faces.push_back( end_face );
+    modified_faces.push_back( end_null_face );
+    modified_faces.push_back( pos_face );
+    modified_faces.push_back( neg_face );
+    validate( (kind == SITE_ARC) ? "insert_arc_site" : "insert_line_site", modified_faces );
+    prof.lap(PHASE_VALIDATE);
+    prof.end();
     return true; 
 }
 
@@ -427,6 +585,49 @@ std::pair<HEFace,HEFace> VoronoiDiagram::add_linesite_edges(HEVertex seg_start,
     return std::make_pair(pos_face,neg_face);
 }
 
+// the arc runs counter-clockwise from seg_start to seg_end.
+// the k==+1 (outside) face is to the left of the seg_end->seg_start edge,
+// and the k==-1 (inside) face is to the left of the seg_start->seg_end edge.
+// cw is the direction in which the arc was inserted, see PolygonInterior
+std::pair<HEFace,HEFace> VoronoiDiagram::add_arcsite_edges(HEVertex seg_start, HEVertex seg_end, const Point& center, bool cw) 
+{
+    ArcSite* pos_site = new ArcSite( g[seg_start].position, g[seg_end].position, center, false, +1);
+    ArcSite* neg_site = new ArcSite( g[seg_start].position, g[seg_end].position, center, false, -1);
+    HEEdge pos_edge, neg_edge;
+    boost::tie(pos_edge, neg_edge) = g.add_twin_edges( seg_end, seg_start );
+    g[pos_edge].inserted_direction = cw;
+    g[neg_edge].inserted_direction = !cw;
+    g[pos_edge].type = ARCSITE;
+    g[neg_edge].type = ARCSITE;
+    g[pos_edge].k = +1;
+    g[neg_edge].k = -1;
+    assert( vd_checker->check_edge(pos_edge) && vd_checker->check_edge(neg_edge) );
+    HEFace pos_face = add_face( pos_site );
+    HEFace neg_face = add_face( neg_site );
+    g[pos_face].edge = pos_edge;
+    g[neg_face].edge = neg_edge;
+    g[pos_edge].face = pos_face;
+    g[neg_edge].face = neg_face;
+    if (debug) std::cout << " pos_face=" << pos_face << " neg_face=" << neg_face << "\n";   
+    return std::make_pair(pos_face,neg_face);
+}
+
+// true if a line-site between the point-sites start and end is in the diagram.
+// the LINESITE edges of a segment run between ENDPOINT vertices on the null-faces of its end-points.
+bool VoronoiDiagram::has_line_site(HEVertex start, HEVertex end) {
+    if ( g[start].null_face == g.HFace() || g[end].null_face == g.HFace() )
+        return false;
+    BOOST_FOREACH( HEVertex v, g.face_vertices( g[start].null_face ) ) {
+        if ( g[v].type != ENDPOINT )
+            continue;
+        BOOST_FOREACH( HEEdge e, g.out_edges(v) ) {
+            if ( g[e].type == LINESITE && g[ g.target(e) ].position == g[end].position )
+                return true;
+        }
+    }
+    return false;
+}
+
 // given indices idx1 and idx2, return the corresponding vertex descriptors
 // the vertex_map is populated in insert_point_site()
 std::pair<HEVertex,HEVertex> VoronoiDiagram::find_endpoints(int idx1, int idx2) {
@@ -475,10 +676,10 @@ std::pair<HEVertex,HEFace> VoronoiDiagram::process_null_edge(Point dir, HEEdge n
             exit(-1); 
         }
         // insert a normal vertex, positioned at mid-alfa between src/trg.
-        HEVertex new_v = g.add_vertex( VoronoiVertex(g[src].position,NEW,NORMAL,g[src].position) );
+        HEVertex new_v = add_vertex( VoronoiVertex(g[src].position,NEW,NORMAL,g[src].position) );
         double mid = numeric::diangle_mid( g[src].alfa, g[trg].alfa  );
         g[new_v].alfa = mid;
-        modified_vertices.insert(new_v);
+        mark_modified(new_v);
         g.add_vertex_in_edge( new_v, next_edge);
         g[new_v].k3=new_k3;
 
@@ -493,7 +694,8 @@ std::pair<HEVertex,HEFace> VoronoiDiagram::process_null_edge(Point dir, HEEdge n
         assert( g[adj].type != ENDPOINT ); 
         
         // FIXME: don't use alfa!
-        if ( neg_sep_alfa == g[adj].alfa && g[adj].type == SEPPOINT ) {
+        // the separators of tangent sites agree only up to rounding, so allow a small tolerance.
+        if ( numeric::diangle_equal( neg_sep_alfa, g[adj].alfa, 1e-12 ) && g[adj].type == SEPPOINT ) {
             if (debug) std::cout << " identical SEPPOINT case!\n";
             // assign face of separator-edge
             // mark separator target NEW
@@ -523,7 +725,7 @@ std::pair<HEVertex,HEFace> VoronoiDiagram::process_null_edge(Point dir, HEEdge n
             HEVertex sep_target = g.target(sep_edge);
             g[sep_target].status = NEW;
             g[sep_target].k3 = new_k3;
-            modified_vertices.insert(sep_target);
+            mark_modified(sep_target);
             
             return std::make_pair( HEVertex(), g[pointsite_edge].face ); // no new separator-point returned
         }
@@ -580,14 +782,14 @@ std::pair<HEVertex,HEFace> VoronoiDiagram::process_null_edge(Point dir, HEEdge n
                 g[adj].status = NEW;
             }
             g[adj].k3 = new_k3;
-            modified_vertices.insert(adj);
+            mark_modified(adj);
             return std::make_pair( sep_point, g.HFace() );
         }
     }
 }
 
 HEVertex VoronoiDiagram::add_separator_point(HEVertex endp, HEEdge edge, Point sep_dir) {
-    HEVertex sep = g.add_vertex( VoronoiVertex(g[endp].position,OUT,SEPPOINT) );
+    HEVertex sep = add_vertex( VoronoiVertex(g[endp].position,OUT,SEPPOINT) );
     g[sep].set_alfa(sep_dir);
     if (debug) {
         std::cout << " adding separator " << g[sep].index << " in null edge "; 
@@ -598,19 +800,20 @@ HEVertex VoronoiDiagram::add_separator_point(HEVertex endp, HEEdge edge, Point s
 }
 
 // either find an existing null-face, or create a new one.
+// dir is the direction from start into the new site, i.e. the segment direction, 
+// or the tangent of an arc. the separators are perpendicular to dir.
+// k3_sign is true if the k==+1 face of the new site is to the left of dir.
 //
 // return segment-endpoint and separator-points,
 boost::tuple<HEVertex,HEFace,HEVertex,HEVertex,HEFace>
-VoronoiDiagram::find_null_face(HEVertex start, HEVertex other, Point left) {
+VoronoiDiagram::find_null_face(HEVertex start, Point dir, bool k3_sign) {
     HEVertex seg_start = HEVertex(); // new end-point vertices
     HEFace start_null_face; // either existing or new null-faces at endpoints
     HEVertex pos_sep_start = HEVertex(); // optional separator endpoints at start
     HEVertex neg_sep_start = HEVertex();
     HEFace face_to_null = g.HFace();
     
-    Point dir = g[other].position - g[start].position;
     double alfa = numeric::diangle( dir.x, dir.y );
-    bool k3_sign = left.is_right( g[start].position , g[other].position); // this is used below and in find_null_face()
         
     if (g[start].null_face != g.HFace() ) {
         // there is an existing null face
@@ -618,7 +821,7 @@ VoronoiDiagram::find_null_face(HEVertex start, HEVertex other, Point left) {
         start_null_face = g[start].null_face;
         
         // create segment endpoint
-        seg_start = g.add_vertex( VoronoiVertex(g[start].position,OUT,ENDPOINT) );
+        seg_start = add_vertex( VoronoiVertex(g[start].position,OUT,ENDPOINT) );
         g[seg_start].zero_dist();
         // find the edge on the null-face where we insert seg_start
         HEEdge current = g[start_null_face].edge;
@@ -659,12 +862,12 @@ VoronoiDiagram::find_null_face(HEVertex start, HEVertex other, Point left) {
         //
         start_null_face = g.add_face(); //  this face to the left of start->end edge    
         if (debug) std::cout << " find_null_face() endp= " << g[start].index <<  " creating new null_face " << start_null_face << "\n";
-        seg_start = g.add_vertex( VoronoiVertex(g[start].position,OUT,ENDPOINT) );
+        seg_start = add_vertex( VoronoiVertex(g[start].position,OUT,ENDPOINT) );
         g[seg_start].zero_dist();
         g[seg_start].set_alfa(dir);
         g[seg_start].k3=0;
-        pos_sep_start = g.add_vertex( VoronoiVertex(g[start].position,OUT,SEPPOINT) );
-        neg_sep_start = g.add_vertex( VoronoiVertex(g[start].position,OUT,SEPPOINT) );
+        pos_sep_start = add_vertex( VoronoiVertex(g[start].position,OUT,SEPPOINT) );
+        neg_sep_start = add_vertex( VoronoiVertex(g[start].position,OUT,SEPPOINT) );
         
         g[pos_sep_start].zero_dist();
         g[neg_sep_start].zero_dist();
@@ -824,7 +1027,8 @@ void VoronoiDiagram::add_separator(HEFace f, HEFace null_face,
         g.set_next(e2,v_next);
     }
     g[e2   ].set_sep_parameters( g[sep_endp].position, g[v_target].position );
-    g[e2_tw].set_sep_parameters( g[sep_endp].position, g[v_target].position );
+    g[e2_tw].type = SEPARATOR;
+    g[e2_tw].share_parameters( g[e2] );
         
     if (debug) {
         std::cout << "added separator: ";
@@ -834,6 +1038,128 @@ void VoronoiDiagram::add_separator(HEFace f, HEFace null_face,
     assert( vd_checker->check_edge(e2_tw) );
 }
 
+/// return the face whose point-site is closest to p.
+///
+/// when only point-sites are present we jump-and-walk: start from the face of the
+/// previous insertion (or a face from the grid-bucket of p, if that is closer) and 
+/// walk greedily across edges to neighbor faces whose site is closer to p.
+/// For point-sites the dual of the diagram is the delaunay triangulation, and a
+/// greedy walk on it always ends at the nearest neighbor.
+/// With line-sites present the point-site faces are no longer connected, so
+/// we fall back to the grid-search, or to locate_point_face() when there is no grid.
+HEFace VoronoiDiagram::find_closest_face(const Point& p) {
+    if (num_lsites > 0 || num_asites > 0) {
+        if (fgrid)
+            return fgrid->grid_find_closest_face( p );
+        return locate_point_face( p );
+    }
+    HEFace start = last_face;
+    HEFace bucket_face;
+    if ( fgrid && fgrid->find_bucket_face(p, bucket_face) ) {
+        if ( (g[bucket_face].site->position() - p).norm_sq() < (g[start].site->position() - p).norm_sq() )
+            start = bucket_face;
+    }
+    return walk_to_closest_face(start, p);
+}
+
+/// the face of the point-site closest to p, in a diagram with line- or arc-sites.
+/// First we walk greedily, over faces of all kinds of sites, to the face whose site is closest to p.
+/// Then the faces around it are searched, as long as their site is no further from p than
+/// the closest point-site found so far. The segment from p to the closest point-site only
+/// crosses such faces, so the search finds it, and it visits only the faces near p.
+HEFace VoronoiDiagram::locate_point_face(const Point& p) {
+    // walk
+    HEFace f = last_face;
+    double dist = site_distance(f, p);
+    for (bool moved = true; moved; ) {
+        moved = false;
+        HEEdge start = g[f].edge;
+        HEEdge current = start;
+        do {
+            HEEdge twin = g[current].twin;
+            if ( twin != HEEdge() && g[ g[twin].face ].site ) { // null-faces have no site
+                double d = site_distance( g[twin].face, p );
+                if ( d < dist ) {
+                    dist = d;
+                    f = g[twin].face;
+                    moved = true;
+                    break;
+                }
+            }
+            current = g[current].next;
+            prof.walk();
+        } while ( current != start );
+    }
+    // search
+    HEFace closest = last_face;
+    double closest_dist = site_distance(last_face, p);
+    if ( face_mark.size() < g.num_faces() )
+        face_mark.resize( g.num_faces(), 0 );
+    face_mark_epoch++;
+    located_faces.clear();
+    located_faces.push_back(f);
+    face_mark[f] = face_mark_epoch;
+    for (unsigned int n=0; n<located_faces.size(); n++) {
+        HEFace current_face = located_faces[n];
+        Site* s = g[current_face].site;
+        if ( s && s->isPoint() && site_distance(current_face, p) < closest_dist ) {
+            closest_dist = site_distance(current_face, p);
+            closest = current_face;
+        }
+        HEEdge start = g[current_face].edge;
+        HEEdge current = start;
+        do {
+            HEEdge twin = g[current].twin;
+            if ( twin != HEEdge() ) {
+                HEFace neighbor = g[twin].face;
+                if ( face_mark[neighbor] != face_mark_epoch ) {
+                    face_mark[neighbor] = face_mark_epoch;
+                    if ( !g[neighbor].site || site_distance(neighbor, p) <= closest_dist ) // null-faces are passed through
+                        located_faces.push_back(neighbor);
+                }
+            }
+            current = g[current].next;
+            prof.walk();
+        } while ( current != start );
+    }
+    return closest;
+}
+
+/// the distance from p to the site of face f
+double VoronoiDiagram::site_distance(HEFace f, const Point& p) {
+    return ( g[f].site->apex_point(p) - p ).norm();
+}
+
+/// starting at face f, walk to neighboring point-site faces that are closer to p
+/// until no neighbor is closer.
+HEFace VoronoiDiagram::walk_to_closest_face(HEFace f, const Point& p) {
+    double dist = (g[f].site->position() - p).norm_sq();
+    for (;;) {
+        HEFace closer = f;
+        HEEdge start = g[f].edge;
+        HEEdge current = start;
+        do {
+            HEEdge twin = g[current].twin;
+            if ( twin != HEEdge() ) { // the outermost edges have no twin
+                HEFace neighbor = g[twin].face;
+                Site* s = g[neighbor].site;
+                if ( s && s->isPoint() ) {
+                    double d = (s->position() - p).norm_sq();
+                    if ( d < dist ) {
+                        dist = d;
+                        closer = neighbor;
+                    }
+                }
+            }
+            current = g[current].next;
+            prof.walk();
+        } while ( current != start );
+        if ( closer == f )
+            return f;
+        f = closer;
+    }
+}
+
 /// find amount of clearance-disk violation on all vertices of face f 
 /// return vertex with the largest violation
 HEVertex VoronoiDiagram::find_seed_vertex(HEFace f, Site* site)  {
@@ -854,6 +1180,7 @@ HEVertex VoronoiDiagram::find_seed_vertex(HEFace f, Site* site)  {
             }
         }
         current = g[current].next;
+        prof.walk();
     } while(current!=start);  
     assert( minPred < 0 );
     return minimalVertex;
@@ -868,12 +1195,14 @@ HEVertex VoronoiDiagram::find_seed_vertex(HEFace f, Site* site)  {
 //  we process UNDECIDED vertices adjacent to known IN-vertices in a "weighted breadth-first-search" manner
 //  where vertices with a large fabs(detH) are processed first, since we assume the in-circle predicate
 //  to be more reliable the larger fabs(in_circle()) is.
+//  vertices where the sign of in_circle() is certain are processed in plain breadth-first order,
+//  only the vertices with in_circle() close to zero go through the priority-queue. see VertexQueue
 void VoronoiDiagram::augment_vertex_set(  Site* site ) {
     while( !vertexQueue.empty() ) {
         HEVertex v = HEVertex();
         double h(0);
         boost::tie( v, h ) = vertexQueue.top();
-        assert( g.g[v].status == UNDECIDED );
+        assert( g[v].status == UNDECIDED );
         vertexQueue.pop(); 
         if ( h < 0.0 ) { // try to mark IN if h<0 and passes (C4) and (C5) tests and in_region(). otherwise mark OUT
             if ( predicate_c4(v) || !predicate_c5(v) || !site->in_region(g[v].position) ) {
@@ -892,7 +1221,7 @@ void VoronoiDiagram::augment_vertex_set(  Site* site ) {
             g[v].status = OUT; // detH was positive (or zero), so mark OUT
             if (debug) std::cout << g[v].index << " marked OUT (in_circle) ( " << h << " )\n";
         }
-        modified_vertices.insert( v );
+        mark_modified( v );
     }
     
     assert( vertexQueue.empty() );
@@ -906,7 +1235,7 @@ void VoronoiDiagram::augment_vertex_set(  Site* site ) {
 void VoronoiDiagram::mark_vertex(HEVertex& v,  Site* site) {
     g[v].status = IN;
     v0.push_back( v );
-    modified_vertices.insert(v);
+    mark_modified(v);
     
     if (site->isPoint())
         mark_adjacent_faces_p(v,site);
@@ -918,7 +1247,8 @@ void VoronoiDiagram::mark_vertex(HEVertex& v,  Site* site) {
         HEVertex w = g.target( e );
         if ( (g[w].status == UNDECIDED) && (!g[w].in_queue) ) {
                 // when pushing onto queue we also evaluate in_circle predicate so that we process vertices in the correct order
-                vertexQueue.push( VertexDetPair(w , g[w].in_circle(site->apex_point(g[w].position)) ) ); 
+                predicates::PredicateResult h = g[w].in_circle_test( site->apex_point(g[w].position) );
+                vertexQueue.push( VertexDetPair(w , h.value ), h.certain() ); 
                 g[w].in_queue=true;
                 if (debug) std::cout << "  " << g[w].index << " queued \n";
         }
@@ -942,20 +1272,26 @@ void VoronoiDiagram::mark_adjacent_faces_p( HEVertex v, Site* site) {
 
 // call this when inserting line-sites
 // since we call add_split_vertex we can't use iterators, because they get invalidated
-// so use the slower adjacent_faces() instead.
+// so we first copy the (sorted, unique) adjacent faces into a scratch vector.
 void VoronoiDiagram::mark_adjacent_faces( HEVertex v, Site* site) {
     assert( g[v].status == IN );
-    FaceVector new_adjacent_faces = g.adjacent_faces( v );
+    adjacent_faces.clear();
+    BOOST_FOREACH(HEEdge e, g.out_edge_itr( v )) {
+        HEFace adj_face = g[e].face;
+        if ( std::find( adjacent_faces.begin(), adjacent_faces.end(), adj_face ) == adjacent_faces.end() )
+            adjacent_faces.push_back( adj_face );
+    }
+    std::sort( adjacent_faces.begin(), adjacent_faces.end() );
     
     assert(
-        (g[v].type == APEX && new_adjacent_faces.size()==2 ) ||
-        (g[v].type == SPLIT && new_adjacent_faces.size()==2 ) ||
-        new_adjacent_faces.size()==3
+        (g[v].type == APEX && adjacent_faces.size()==2 ) ||
+        (g[v].type == SPLIT && adjacent_faces.size()==2 ) ||
+        adjacent_faces.size()==3
     );
 
-    BOOST_FOREACH( HEFace adj_face, new_adjacent_faces ) {
+    BOOST_FOREACH( HEFace adj_face, adjacent_faces ) {
         if ( g[adj_face].status != INCIDENT ) {
-            if ( site->isLine() )
+            if ( !site->isPoint() )
                 add_split_vertex(adj_face, site);
 
             g[adj_face].status = INCIDENT;
@@ -968,9 +1304,9 @@ void VoronoiDiagram::mark_adjacent_faces( HEVertex v, Site* site) {
 // walk around the face f
 // return edges whose endpoints are on separate sides of pt1-pt2 line
 // FIXME/todo ?not all edges found like this *need* SPLIT vertices? (but it does not hurt to insert SPLIT-vertices in this case)
-EdgeVector VoronoiDiagram::find_split_edges(HEFace f, Point pt1, Point pt2) {
+void VoronoiDiagram::find_split_edges(HEFace f, Point pt1, Point pt2, EdgeVector& out) {
     assert( vd_checker->face_ok(f) );
-    EdgeVector out;
+    out.clear();
     HEEdge current_edge = g[f].edge;
     HEEdge start_edge = current_edge;
     //int count=0;                             
@@ -996,7 +1332,6 @@ EdgeVector VoronoiDiagram::find_split_edges(HEFace f, Point pt1, Point pt2) {
             std::cout << "  "; g.print_edge(e);
         }
     }
-    return out;
 }
 
 // add one or many split-vertices to the edges of the give face
@@ -1011,24 +1346,28 @@ void VoronoiDiagram::add_split_vertex(HEFace f, Site* s) {
     Site* fs = g[f].site;
     
     // don't search for split-vertex on the start or end face
-    if (fs->isPoint() && s->isLine()) {
+    if (fs->isPoint()) {
         if ( fs->position() == s->start() || fs->position() == s->end() ) // FIXME: don't compare Points, instead compare vertex-index!
             return;
     }
         
-    if ( fs->isPoint() && s->isLine() && s->in_region( fs->position() ) ) {
+    if ( fs->isPoint() && s->in_region( fs->position() ) ) {
         // 1) find the correct edge
+        // the split-line goes through the point-site, perpendicular to a line-site,
+        // or through the center of an arc-site
         Point pt1 = fs->position();
-        Point pt2 = pt1-Point( s->a(), s->b() ); 
+        Point pt2 = s->isLine() ? pt1-Point( s->a(), s->b() ) : Point( s->x(), s->y() ); 
+        if ( pt1 == pt2 )
+            return; // a point-site at the center of an arc
         
         assert( (pt1-pt2).norm() > 0 ); 
         
-        EdgeVector split_edges = find_split_edges(f, pt1, pt2);
+        find_split_edges(f, pt1, pt2, split_edges);
         // the sought edge should have src on one side of pt1-pt2
         // and trg on the other side of pt1-pt2
         
         BOOST_FOREACH(HEEdge split_edge, split_edges) {
-            if ( (g[split_edge].type == SEPARATOR) || (g[split_edge].type == LINESITE) )
+            if ( (g[split_edge].type == SEPARATOR) || (g[split_edge].type == LINESITE) || (g[split_edge].type == ARCSITE) )
                 return; // don't place split points on linesites or separators(?)
 
             // find a point = src + u*(trg-src)
@@ -1070,7 +1409,7 @@ void VoronoiDiagram::add_split_vertex(HEFace f, Site* s) {
             split_pt_pos = sl.p;
         #endif
         
-            HEVertex v = g.add_vertex( VoronoiVertex(split_pt_pos, UNDECIDED, SPLIT, fs->position() ) );
+            HEVertex v = add_vertex( VoronoiVertex(split_pt_pos, UNDECIDED, SPLIT, fs->position() ) );
             
         #ifndef TOMS748
             delete vs;
@@ -1093,13 +1432,16 @@ void VoronoiDiagram::add_split_vertex(HEFace f, Site* s) {
 // find a SPLIT vertex on the Face f
 // return true, and set v, if found.
 bool VoronoiDiagram::find_split_vertex(HEFace f, HEVertex& v)  {
-    VertexVector verts = g.face_vertices(f);
-    BOOST_FOREACH(HEVertex q, verts) {
+    HEEdge current = g[f].edge;
+    HEEdge start = current;
+    do {
+        HEVertex q = g.target(current);
         if (g[q].type == SPLIT) {
             v = q;
             return true;
         }
-    }
+        current = g[current].next;
+    } while(current!=start);
     return false;
 }
 
@@ -1117,8 +1459,12 @@ void VoronoiDiagram::remove_split_vertex(HEFace f) {
         assert(g[v].type == SPLIT); 
         if (debug) std::cout << " removing split-vertex " << g[v].index << "\n";
         
+        if ( g[v].epoch == epoch ) { // remove v from modified_vertices
+            VertexVector::iterator it = std::find( modified_vertices.begin(), modified_vertices.end(), v );
+            *it = modified_vertices.back();
+            modified_vertices.pop_back();
+        }
         g.remove_deg2_vertex( v );
-        modified_vertices.erase(v);
         
         assert( vd_checker->face_ok( f ) );
     }
@@ -1126,17 +1472,52 @@ void VoronoiDiagram::remove_split_vertex(HEFace f) {
     assert( vd_checker->face_ok( f ) );
 }
 
+// when an arc joins tangent line-sites at both ends, the separators of the line-sites
+// meet at the center of the arc. The point-site faces between the separators are removed,
+// and one of the separator-targets at the center is left with only two edges.
+// replace the separator and the (zero-length) edge after it with one separator-edge.
+void VoronoiDiagram::remove_center_vertex() {
+    VertexVector center;
+    BOOST_FOREACH( HEVertex v, modified_vertices ) {
+        if ( g[v].type == NORMAL && g.degree(v) == 4 ) // two out-edges and their twins
+            center.push_back(v);
+    }
+    BOOST_FOREACH( HEVertex v, center ) {
+        HEEdge sep = HEEdge();
+        BOOST_FOREACH( HEEdge e, g.out_edge_itr(v) ) {
+            if ( g[e].type == SEPARATOR )
+                sep = e;
+        }
+        if ( sep == HEEdge() )
+            continue;
+        if (debug) std::cout << " removing center-vertex " << g[v].index << "\n";
+        HEVertex sep_src = g.target(sep);
+        EdgeProps sep_props = g[ g[sep].twin ]; // the separator, pointing to v
+        VertexVector::iterator it = std::find( modified_vertices.begin(), modified_vertices.end(), v );
+        *it = modified_vertices.back();
+        modified_vertices.pop_back();
+        g.remove_deg2_vertex( v );
+        // remove_deg2_vertex() copies the other edge into the half-edge that leaves sep_src
+        BOOST_FOREACH( HEEdge e, g.out_edge_itr(sep_src) ) {
+            if ( g[e].face == sep_props.face )
+                g[e] = sep_props;
+        }
+    }
+}
+
 // generate new voronoi-vertices on all IN-OUT edges 
 // Note: used only by insert_point_site() !!
 void VoronoiDiagram::add_vertices( Site* new_site ) {
     if (debug) std::cout << "add_vertices(): \n";
     assert( !v0.empty() );
-    EdgeVector q_edges = find_in_out_edges();       // new vertices generated on these IN-OUT edges
+    find_in_out_edges(in_out_edges);       // new vertices generated on these IN-OUT edges
+    EdgeVector& q_edges = in_out_edges;
+    vpos->position( q_edges, new_site, new_solutions ); // vertex_positioner.cpp
     for( unsigned int m=0; m<q_edges.size(); ++m )  {   
 
-        Solution sl = vpos->position( q_edges[m], new_site ); // vertex_positioner.cpp
+        const Solution& sl = new_solutions[m];
 
-        if ( vpos->dist_error( q_edges[m], sl, new_site) > 1e-9 ) {
+        if ( debug && vpos->dist_error( q_edges[m], sl, new_site) > 1e-9 ) { // counted as large_errors in the Telemetry
             HEVertex src = g.source(q_edges[m]);
             HEVertex trg = g.target(q_edges[m]);
             std::cout << "ERROR while positioning new vertex  on edge\n";
@@ -1146,8 +1527,8 @@ void VoronoiDiagram::add_vertices( Site* new_site ) {
             
             std::cout <<  "     derr =" << vpos->dist_error( q_edges[m], sl, new_site) << "\n";
         }
-        HEVertex q = g.add_vertex( VoronoiVertex( sl.p, NEW, NORMAL, new_site->apex_point( sl.p ), sl.k3 ) );
-        modified_vertices.insert(q);
+        HEVertex q = add_vertex( VoronoiVertex( sl.p, NEW, NORMAL, new_site->apex_point( sl.p ), sl.k3 ) );
+        mark_modified(q);
         g.add_vertex_in_edge( q, q_edges[m] );
         if (debug) {
             HEVertex src = g.source(q_edges[m]);
@@ -1165,7 +1546,7 @@ HEFace VoronoiDiagram::add_face(Site* s) {
     g[newface].site = s;
     s->face = newface;
     g[newface].status = NONINCIDENT;
-    if (s->isPoint() )
+    if ( s->isPoint() && fgrid )
         fgrid->add_face( g[newface] ); 
     
     return newface;
@@ -1185,11 +1566,11 @@ void VoronoiDiagram::add_edges(HEFace newface, HEFace f, HEFace newface2, std::p
     assert( new_count > 0 );
     assert( (new_count % 2) == 0 );
     int new_pairs = new_count / 2; // we add one NEW-NEW edge for each pair found
-    VertexVector startverts; // this holds ed.v1 vertices for edges already added
+    start_verts.clear(); // this holds ed.v1 vertices for edges already added
     for (int m=0;m<new_pairs;m++) {
-        EdgeData ed = find_edge_data(f, startverts, segment);
+        EdgeData ed = find_edge_data(f, start_verts, segment);
         add_edge( ed, newface, newface2);
-        startverts.push_back( ed.v1 );
+        start_verts.push_back( ed.v1 );
     }
     if (debug) std::cout << " all edges on f=" << f << " added.\n";
 }
@@ -1270,6 +1651,21 @@ void VoronoiDiagram::add_edge(EdgeData ed, HEFace newface, HEFace newface2) {
                 assert( !g[new_target].position.is_right( new_site->start(), new_site->end() ) );
         }
 
+    } else if ( (new_site->isArc() && f_site->isLine()) || (new_site->isLine() && f_site->isArc()) ) { // LA, AL
+        // the apex is on the line through the arc-center, perpendicular to the line-site.
+        // set_la_parameters() uses the same direction.
+        Site* arc = new_site->isArc() ? new_site : f_site;
+        Site* line = new_site->isLine() ? new_site : f_site;
+        Point pt1( arc->x(), arc->y() );
+        Point pt2 = pt1 + Point( line->a(), line->b() );
+        src_sign = g[new_source].position.is_right( pt1, pt2 );
+        trg_sign = g[new_target].position.is_right( pt1, pt2 );
+    } else if ( (new_site->isArc() || f_site->isArc()) && !new_site->isLine() && !f_site->isLine() ) { // PA, AP, AA
+        // the apex is on the line through the two centers, see set_aa_parameters()
+        Point pt1( f_site->x(), f_site->y() );
+        Point pt2( new_site->x(), new_site->y() );
+        src_sign = g[new_source].position.is_right( pt1, pt2 );
+        trg_sign = g[new_target].position.is_right( pt1, pt2 );
     } else { // unhandled case!
         std::cout << " add_edge() WARNING: no code to deremine src_sign and trg_sign!\n";
         assert(0);
@@ -1292,7 +1688,8 @@ void VoronoiDiagram::add_edge(EdgeData ed, HEFace newface, HEFace newface2) {
         g[twin_previous].next = e_twin;
         g[e_twin].next = twin_next;
         g[e_twin].k = g[new_source].k3; 
-        g[e_twin].set_parameters( new_site, f_site, src_sign );
+        g[e_twin].type = g[e_new].type;
+        g[e_twin].share_parameters( g[e_new] ); // same curve as set_parameters( new_site, f_site, src_sign )
         g[e_twin].face = new_face; 
         g[new_face].edge = e_twin;
 
@@ -1312,7 +1709,7 @@ void VoronoiDiagram::add_edge(EdgeData ed, HEFace newface, HEFace newface2) {
         //   twn_nxt <- NEW <- e1_tw -- APEX <-e2_tw-- NEW <- twn_prv    
         //                       new1/new2         new1/new2
         //   
-        HEVertex apex = g.add_vertex( VoronoiVertex(Point(0,0), NEW,APEX) );
+        HEVertex apex = add_vertex( VoronoiVertex(Point(0,0), NEW,APEX) );
         HEEdge e1, e1_tw;
         HEEdge e2, e2_tw;
         boost::tie(e1, e1_tw) = g.add_twin_edges( new_source, apex );
@@ -1325,16 +1722,18 @@ void VoronoiDiagram::add_edge(EdgeData ed, HEFace newface, HEFace newface2) {
         assert( g[new_next].k == g[new_previous].k );
 
         // new_previous -> e1 -> e2 -> new_next
-        g.set_next_chain( boost::assign::list_of(new_previous)(e1)(e2)(new_next), f, g[new_next].k );
+        g.set_next_chain( new_previous, e1, e2, new_next, f, g[new_next].k );
         
     // twin edges
-        g[e1_tw].set_parameters(new_site, f_site, src_sign);
-        g[e2_tw].set_parameters(new_site, f_site, trg_sign);
+        g[e1_tw].type = g[e1].type;
+        g[e2_tw].type = g[e2].type;
+        g[e1_tw].share_parameters( g[e1] );
+        g[e2_tw].share_parameters( g[e2] );
 
         assert( g[twin_previous].k == g[twin_next].k );  
         assert( g[twin_previous].face == g[twin_next].face );        
         // twin_prev -> e2_tw -> e1_tw -> twin_next   on new_face 
-        g.set_next_chain( boost::assign::list_of(twin_previous)(e2_tw)(e1_tw)(twin_next) );
+        g.set_next_chain( twin_previous, e2_tw, e1_tw, twin_next );
         //, new_face,  g[new_source].k3  );
                 
         g[e1_tw].k = g[new_source].k3;
@@ -1350,7 +1749,7 @@ void VoronoiDiagram::add_edge(EdgeData ed, HEFace newface, HEFace newface2) {
         double min_t = g[e1].minimum_t(f_site,new_site);
         g[apex].position = g[e1].point(min_t);
         g[apex].init_dist(f_site->apex_point(g[apex].position));
-        modified_vertices.insert( apex );
+        mark_modified( apex );
     }
 }
 
@@ -1427,7 +1826,7 @@ boost::tuple<HEEdge,HEVertex,HEEdge,bool> VoronoiDiagram::find_separator_target(
 // segment contains ENDPOINT vertices, when we are inserting a line-segment
 // (these vertices are needed to ensure finding correct points around sites/null-edges)
 //
-EdgeData VoronoiDiagram::find_edge_data(HEFace f, VertexVector startverts, std::pair<HEVertex,HEVertex> segment)  {
+EdgeData VoronoiDiagram::find_edge_data(HEFace f, const VertexVector& startverts, std::pair<HEVertex,HEVertex> segment)  {
     EdgeData ed;
     ed.f = f;
     if (debug) {
@@ -1469,6 +1868,7 @@ EdgeData VoronoiDiagram::find_edge_data(HEFace f, VertexVector startverts, std::
             }
         }
         current_edge = g[current_edge].next;   
+        prof.walk();
         //count++;
         //assert(count<10000); // some reasonable max number of edges in face, to avoid infinite loop
     } while (current_edge!=start_edge && !found);
@@ -1501,6 +1901,7 @@ EdgeData VoronoiDiagram::find_edge_data(HEFace f, VertexVector startverts, std::
             }
         }
         current_edge = g[current_edge].next;   
+        prof.walk();
         //count++;
         //assert(count<10000); // some reasonable max number of edges in face, to avoid infinite loop
     } while (current_edge!=start_edge && !found);
@@ -1602,16 +2003,32 @@ void VoronoiDiagram::repair_face( HEFace f, std::pair<HEVertex,HEVertex> segment
         //if (count>30)
         //    exit(-1);
         current_edge = g[current_edge].next; // jump to the next edge
+        prof.walk();
     } while (current_edge != start_edge);
     
 }
 
 // remove the IN vertices stored in v0 (and associated IN-NEW edges)
 void VoronoiDiagram::remove_vertex_set() {
+    // all IN vertices are in v0, and they are all about to be deleted. drop them from modified_vertices.
+    unsigned int n_kept = 0;
+    for (unsigned int m=0; m<modified_vertices.size(); ++m) {
+        if ( g[ modified_vertices[m] ].status != IN )
+            modified_vertices[n_kept++] = modified_vertices[m];
+    }
+    modified_vertices.resize(n_kept);
     BOOST_FOREACH( HEVertex& v, v0 ) {      // it should now be safe to delete all IN vertices
         assert( g[v].status == IN );
         g.delete_vertex(v); // this also removes edges connecting to v
-        modified_vertices.erase(v);
+    }
+}
+
+// add v to modified_vertices, unless it is already there.
+// reset_status() resets all modified vertices after an insertion.
+void VoronoiDiagram::mark_modified(HEVertex v) {
+    if ( g[v].epoch != epoch ) {
+        g[v].epoch = epoch;
+        modified_vertices.push_back(v);
     }
 }
     
@@ -1630,11 +2047,21 @@ void VoronoiDiagram::reset_status() {
     v0.clear();
 }
 
+// an insertion removes edges and adds new ones with new indices, so edge_index_bound() grows
+// faster than num_edges(). when more than half of the indices are unused they are compacted.
+// the pass over all edges is paid for by the num_edges() edges added since the last compaction,
+// so the amortized cost is O(1) per added edge, and per-edge arrays such as FilterView stay
+// smaller than twice the number of edges.
+void VoronoiDiagram::reclaim_edge_indices() {
+    if ( g.edge_index_bound() > 2*g.num_edges() )
+        g.compact_edge_indices();
+}
+
 // given the set v0 of "IN" vertices, find and return the adjacent IN-OUT edges 
 // later NEW-vertices are inserted into each of the found IN-OUT edges
-EdgeVector VoronoiDiagram::find_in_out_edges() { 
+void VoronoiDiagram::find_in_out_edges(EdgeVector& output) { 
     assert( !v0.empty() );
-    EdgeVector output; // new vertices generated on these edges
+    output.clear(); // new vertices generated on these edges
     BOOST_FOREACH( HEVertex& v, v0 ) {                                   
         assert( g[v].status == IN ); // all verts in v0 are IN
         BOOST_FOREACH(HEEdge e, g.out_edge_itr(v)){
@@ -1642,8 +2069,9 @@ EdgeVector VoronoiDiagram::find_in_out_edges() {
                 output.push_back(e); // this is an IN-OUT edge
         }
     }
-    assert( !output.empty() );
-    return output;
+    // a segment that joins two collinear or tangent segments at both ends 
+    // has no IN-OUT edges. the NEW separator-targets are then the only NEW vertices.
+    assert( !output.empty() || num_lsites+num_asites > 1 );
 }
 
 // number of IN vertices adjacent to given vertex v
@@ -1665,18 +2093,13 @@ bool VoronoiDiagram::predicate_c4(HEVertex v) {
 // predicate C5 i.e. "connectedness"  from Sugihara&Iri 1992 "one million" paper
 bool VoronoiDiagram::predicate_c5(HEVertex v) {
     if (g[v].type == APEX || g[v].type == SPLIT ) { return true; } // ?
-    FaceVector adjacent_incident_faces;
-
-    BOOST_FOREACH(HEEdge e, g.out_edge_itr(v)){
-        HEFace f = g[e].face;
-        if ( g[f].status == INCIDENT )
-            adjacent_incident_faces.push_back( f );
-    }
-
-    assert( !adjacent_incident_faces.empty() );
-    
+    int num_incident = 0;
     bool all_found = true;
-    BOOST_FOREACH( HEFace f, adjacent_incident_faces ) { // check each adjacent face f for an IN-vertex
+    BOOST_FOREACH(HEEdge e, g.out_edge_itr(v)){ // check each adjacent incident face f for an IN-vertex
+        HEFace f = g[e].face;
+        if ( g[f].status != INCIDENT )
+            continue;
+        num_incident++;
         bool face_ok=false;
         HEEdge current = g[f].edge;
         HEEdge start = current;
@@ -1692,6 +2115,7 @@ bool VoronoiDiagram::predicate_c5(HEVertex v) {
         if (!face_ok)
             all_found=false;
     }
+    assert( num_incident > 0 );
     return all_found; // if this returns false, we mark a vertex OUT, on topology grounds.
 }
 
@@ -1722,6 +2146,26 @@ int VoronoiDiagram::num_new_vertices(HEFace f) {
     return count;
 }
 
+// check the diagram after inserting a site, according to the validation level.
+// faces are the faces modified by the insertion, used with VALIDATE_INCIDENT.
+// a failure is counted and recorded in validation_error(), and (in debug builds) stops at the assert.
+bool VoronoiDiagram::validate(const char* operation, const FaceVector& faces) {
+    bool ok = true;
+    if (validation == VALIDATE_INCIDENT)
+        ok = vd_checker->faces_ok( faces );
+    else if (validation == VALIDATE_FULL)
+        ok = vd_checker->is_valid();
+    if (!ok) {
+        validation_failures++;
+        std::ostringstream o;
+        o << operation << "(): diagram not valid, with " << num_point_sites() << " point-sites and " << num_line_sites() << " line-sites";
+        validation_message = o.str();
+        if (debug) std::cout << " VoronoiDiagram::validate() ERROR " << validation_message << "\n";
+    }
+    assert( ok );
+    return ok;
+}
+
 bool VoronoiDiagram::check() {
     if( vd_checker->is_valid() ) {
         if (debug) std::cout << "diagram check OK.\n";
@@ -1732,6 +2176,208 @@ bool VoronoiDiagram::check() {
     }
 }
 
+/// write the diagram to a binary file, see diagram_file.hpp.
+/// returns false if the file could not be written.
+bool VoronoiDiagram::save(const std::string& filename) {
+    DiagramFileWriter w;
+    w.header.far_radius = far_radius;
+    w.header.n_bins = fgrid ? fgrid->num_bins() : 0;
+    w.header.next_vertex_index = next_vertex_index;
+    w.header.edge_index_bound = g.edge_index_bound();
+    w.header.num_psites = num_psites;
+    w.header.num_lsites = num_lsites;
+    w.header.num_asites = num_asites;
+    w.header.last_face = last_face;
+    w.header.epoch = epoch;
+
+    // vertices and edges are written in iteration order, so that a loaded
+    // diagram iterates over them, and continues insertion, in the same order.
+    VertexVector vertices = g.vertices();
+    std::vector<unsigned int> vertex_row( next_vertex_index, 0 );
+    w.vertices.reserve( vertices.size() );
+    for (unsigned int n=0; n<vertices.size(); ++n) {
+        const VoronoiVertex& v = g[ vertices[n] ];
+        vertex_row[ v.index ] = n;
+        FileVertex fv;
+        fv.position = v.position;
+        fv.r = v.dist();
+        fv.k3 = v.k3;
+        fv.alfa = v.alfa;
+        fv.index = v.index;
+        fv.face = v.face;
+        fv.null_face = v.null_face;
+        fv.type = v.type;
+        fv.status = v.status;
+        w.vertices.push_back(fv);
+    }
+    EdgeVector edges = g.edges();
+    std::vector<int> edge_row( g.edge_index_bound(), -1 );
+    for (unsigned int n=0; n<edges.size(); ++n)
+        edge_row[ g[ edges[n] ].index ] = n;
+    w.edges.reserve( edges.size() );
+    w.parameters.reserve( edges.size()/2 + 1 );
+    BOOST_FOREACH( HEEdge e, edges ) {
+        const EdgeProps& ep = g[e];
+        FileEdge fe;
+        fe.source = vertex_row[ g[ g.source(e) ].index ];
+        fe.target = vertex_row[ g[ g.target(e) ].index ];
+        fe.next = edge_row[ g[ ep.next ].index ];
+        fe.twin = ( ep.twin != HEEdge() ) ? edge_row[ g[ep.twin].index ] : -1;
+        fe.face = ep.face;
+        fe.null_face = ep.null_face;
+        fe.index = ep.index;
+        fe.parameters = -1;
+        if ( ep.params ) { // twins share their parameters
+            if ( fe.twin >= 0 && fe.twin < (int)w.edges.size() && g[ep.twin].params == ep.params ) {
+                fe.parameters = w.edges[fe.twin].parameters;
+            } else {
+                fe.parameters = w.parameters.size();
+                w.parameters.push_back( *ep.params );
+            }
+        }
+        fe.k = ep.k;
+        fe.type = ep.type;
+        fe.flags = ( ep.has_null_face ? EDGE_HAS_NULL_FACE : 0 ) | ( ep.parameters().sign ? EDGE_SIGN : 0 )
+                 | ( ep.valid ? EDGE_VALID : 0 ) | ( ep.inserted_direction ? EDGE_INSERTED_DIRECTION : 0 );
+        w.edges.push_back(fe);
+    }
+    w.faces.reserve( g.num_faces() );
+    for (HEFace f=0; f<g.num_faces(); ++f) {
+        FileFace ff;
+        ff.edge = ( g[f].edge != HEEdge() ) ? edge_row[ g[ g[f].edge ].index ] : -1;
+        ff.status = ( g[f].status == INCIDENT ) ? INCIDENT : NONINCIDENT; // null-faces have no status
+        ff.site_kind = FACE_NO_SITE;
+        ff.cw = false;
+        ff.site_face = 0;
+        ff.k = 0;
+        Site* s = g[f].site;
+        if (s) {
+            ff.site_kind = s->kind();
+            ff.site_face = s->face;
+            if ( s->isPoint() ) {
+                ff.start = s->position();
+            } else {
+                ff.k = s->k();
+                ff.start = s->start();
+                ff.end = s->end();
+                if ( s->isArc() ) {
+                    ff.center = static_cast<ArcSite*>(s)->center();
+                    ff.cw = static_cast<ArcSite*>(s)->cw();
+                }
+            }
+        }
+        w.faces.push_back(ff);
+    }
+    for (std::map<int,HEVertex>::iterator it=vertex_map.begin(); it!=vertex_map.end(); ++it) {
+        FileHandle fh;
+        fh.handle = it->first;
+        fh.vertex = vertex_row[ g[it->second].index ];
+        w.handles.push_back(fh);
+    }
+
+    std::ofstream out( filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !out || !w.write(out) ) {
+        std::cout << " VoronoiDiagram::save() ERROR cannot write " << filename << "\n";
+        return false;
+    }
+    return true;
+}
+
+/// replace this diagram with a diagram from a file written by save().
+/// the far-radius and the number of grid-bins are those of the saved diagram.
+/// returns false, and leaves the diagram unchanged, if the file cannot be read.
+bool VoronoiDiagram::load(const std::string& filename) {
+    std::ifstream in( filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate );
+    std::vector<char> bytes( in ? (std::size_t)in.tellg() : 0 );
+    if ( !bytes.empty() ) {
+        in.seekg(0);
+        in.read( &bytes[0], bytes.size() );
+    }
+    DiagramFileView file;
+    if ( !in || bytes.empty() || !file.open( &bytes[0], bytes.size() ) || !file.check_references() ) {
+        std::cout << " VoronoiDiagram::load() ERROR cannot read " << filename << " " << file.error() << "\n";
+        return false;
+    }
+    DiagramFileHeader h = file.header();
+    g.clear();
+    vertex_map.clear();
+    incident_faces.clear();
+    modified_vertices.clear();
+    v0.clear();
+    delete fgrid;
+    fgrid = 0;
+    if ( h.n_bins > 0 )
+        fgrid = new FaceGrid( h.far_radius, h.n_bins );
+    far_radius = h.far_radius;
+    vpos->set_far_radius( far_radius );
+    next_vertex_index = h.next_vertex_index;
+    num_psites = h.num_psites;
+    num_lsites = h.num_lsites;
+    num_asites = h.num_asites;
+    last_face = h.last_face;
+    epoch = h.epoch;
+
+    VertexVector vertices( file.num_vertices() );
+    for (unsigned int n=0; n<file.num_vertices(); ++n) {
+        FileVertex fv = file.vertex(n);
+        VoronoiVertex v( fv.position, (VoronoiVertexStatus)fv.status, (VoronoiVertexType)fv.type );
+        v.index = fv.index;
+        v.set_dist( fv.r );
+        v.k3 = fv.k3;
+        v.alfa = fv.alfa;
+        v.face = fv.face;
+        v.null_face = fv.null_face;
+        v.epoch = 0;
+        vertices[n] = g.add_vertex(v);
+    }
+    std::vector< boost::intrusive_ptr<EdgeParameters> > parameters( file.num_parameters() );
+    for (unsigned int n=0; n<file.num_parameters(); ++n)
+        parameters[n] = new EdgeParameters( file.parameters(n) );
+    EdgeVector edges( file.num_edges() );
+    for (unsigned int n=0; n<file.num_edges(); ++n) {
+        FileEdge fe = file.edge(n);
+        edges[n] = g.add_edge( vertices[fe.source], vertices[fe.target] );
+        EdgeProps& ep = g[ edges[n] ];
+        ep.index = fe.index;
+        ep.face = fe.face;
+        ep.null_face = fe.null_face;
+        ep.k = fe.k;
+        ep.type = (VoronoiEdgeType)fe.type;
+        ep.has_null_face = fe.flags & EDGE_HAS_NULL_FACE;
+        ep.valid = fe.flags & EDGE_VALID;
+        ep.inserted_direction = fe.flags & EDGE_INSERTED_DIRECTION;
+        if ( fe.parameters >= 0 ) {
+            ep.params = parameters[fe.parameters];
+            ep.params->sign = fe.flags & EDGE_SIGN; // the sign belongs to the shared parameters
+        }
+    }
+    for (unsigned int n=0; n<file.num_edges(); ++n) {
+        FileEdge fe = file.edge(n);
+        g[ edges[n] ].next = edges[fe.next];
+        g[ edges[n] ].twin = ( fe.twin >= 0 ) ? edges[fe.twin] : HEEdge();
+    }
+    g.set_edge_index_bound( h.edge_index_bound );
+    for (unsigned int n=0; n<file.num_faces(); ++n) {
+        FileFace ff = file.face(n);
+        HEFace f = g.add_face();
+        g[f].edge = ( ff.edge >= 0 ) ? edges[ff.edge] : HEEdge();
+        g[f].status = (VoronoiFaceStatus)ff.status;
+        if ( ff.site_kind == SITE_POINT )
+            g[f].site = new PointSite( ff.start, ff.site_face );
+        else if ( ff.site_kind == SITE_LINE )
+            g[f].site = new LineSite( ff.start, ff.end, ff.k, ff.site_face );
+        else if ( ff.site_kind == SITE_ARC )
+            g[f].site = new ArcSite( ff.start, ff.end, ff.center, ff.cw, ff.k, ff.site_face );
+        if ( fgrid && g[f].site && g[f].site->isPoint() )
+            fgrid->add_face( g[f] );
+    }
+    for (unsigned int n=0; n<file.num_handles(); ++n) {
+        FileHandle fh = file.handle(n);
+        vertex_map.insert( std::make_pair( fh.handle, vertices[fh.vertex] ) );
+    }
+    return true;
+}
+
 std::string VoronoiDiagram::print() const {
     std::ostringstream o;
     o << "VoronoiDiagram \n";
@@ -26,6 +26,7 @@
 #include "common/point.hpp"
 #include "graph.hpp"
 #include "vertex_positioner.hpp"
+#include "profiler.hpp"
 
 namespace ovd
 {
@@ -34,7 +35,7 @@ class VoronoiDiagramChecker;
 class FaceGrid;
 
 // in augment_vertex_set() we grow the delete-tree by processing vertices
-// one-by-one from a priority_queue. This is the priority_queue sort predicate.
+// one-by-one from a VertexQueue. This is the priority_queue sort predicate.
 // We handle vertices with a large fabs( in_circle() ) first, since we 
 // believe their predicate to be more reliable.
 typedef std::pair<HEVertex, double> VertexDetPair;
@@ -45,9 +46,69 @@ public:
   }
 };
 
-// vertices for processing held in this queue
-// sorted by decreasing fabs() of in_circle-predicate, so that the vertices whose IN/OUT status we are 'most certain' about are processed first
-typedef std::priority_queue< VertexDetPair , std::vector<VertexDetPair>, abs_comparison > VertexQueue;
+/// priority_queue sorted by decreasing fabs() of in_circle-predicate
+class VertexHeap : public std::priority_queue< VertexDetPair , std::vector<VertexDetPair>, abs_comparison > {
+public:
+    /// reserve space in the underlying container, so that push() does not allocate
+    void reserve(std::size_t n) { c.reserve(n); }
+};
+
+/// vertices for processing held in this queue.
+/// vertices whose in_circle-predicate sign is certain (see predicates::PredicateResult::certain())
+/// are processed first, in breadth-first (FIFO) order. 
+/// The remaining vertices, with an in_circle value close to zero, are kept in a heap 
+/// sorted by decreasing fabs() of the in_circle-predicate, so that the vertices 
+/// whose IN/OUT status we are 'most certain' about are processed first
+class VertexQueue {
+public:
+    VertexQueue() : head(0) {}
+    /// add a vertex
+    void push(const VertexDetPair& p, bool certain) {
+        if (certain)
+            fifo.push_back(p);
+        else
+            heap.push(p);
+    }
+    /// the next vertex to process
+    const VertexDetPair& top() const {
+        if ( head < fifo.size() )
+            return fifo[head];
+        return heap.top();
+    }
+    /// remove the next vertex
+    void pop() {
+        if ( head < fifo.size() ) {
+            if ( ++head == fifo.size() ) {
+                fifo.clear(); // keeps capacity
+                head = 0;
+            }
+        } else {
+            heap.pop();
+        }
+    }
+    bool empty() const { return fifo.empty() && heap.empty(); }
+    /// reserve space, so that push() does not allocate
+    void reserve(std::size_t n) { fifo.reserve(n); heap.reserve(n); }
+private:
+    /// certain vertices, fifo[head] is the next one
+    std::vector<VertexDetPair> fifo;
+    std::size_t head;
+    /// uncertain vertices
+    VertexHeap heap;
+};
+
+/// how much of the diagram is checked after each inserted site.
+/// VALIDATE_NONE: no checks
+/// VALIDATE_INCIDENT: check only the faces that the new site modified, and the degree of their vertices
+/// VALIDATE_FULL: check the whole diagram, this makes insertion O(n^2)
+enum ValidationLevel {VALIDATE_NONE, VALIDATE_INCIDENT, VALIDATE_FULL};
+
+/// the result for one segment of insert_line_sites().
+/// INSERT_OK: the segment was inserted
+/// INSERT_BAD_HANDLE: an end-point is not the handle of a point-site, or both end-points are the same.
+///                    the segment was skipped.
+/// INSERT_DUPLICATE: a line-site between the same end-points is already in the diagram. the segment was skipped.
+enum InsertStatus {INSERT_OK, INSERT_BAD_HANDLE, INSERT_DUPLICATE};
 
 // this struct used in add_edge() for storing information related to
 // the new edge.
@@ -74,41 +135,100 @@ class VoronoiDiagram {
         /// ctor
         /// create diagram with given far-radius and number of bins
         /// \param far radius of circle centered at (0,0) within which all sites must lie
-        /// \param n_bins number of bins used for nearest vd-vertex bucket-search
+        /// \param n_bins number of bins used for nearest vd-vertex bucket-search.
+        ///        with n_bins=0 no grid is built, and new sites are located only by walking the diagram.
         VoronoiDiagram(double far, unsigned int n_bins);
         /// dtor
         virtual ~VoronoiDiagram();
 
         int insert_point_site(const Point& p, int step=0);
+        std::vector<int> insert_point_sites(const std::vector<Point>& points);
 
         bool insert_line_site(int idx1, int idx2, int step=13);
+        std::vector<int> insert_line_sites(const std::vector< std::pair<int,int> >& segments);
+        bool insert_arc_site(int idx1, int idx2, const Point& center, bool cw, int step=13);
         /// return the far radius
         double get_far_radius() const {return far_radius;}
         /// return number of point sites in diagram
         int num_point_sites() const {return num_psites-3;} // the three initial vertices don't count
         /// return number of line-segments sites in diagram
         int num_line_sites() const {return num_lsites;}
+        /// return number of arc sites in diagram
+        int num_arc_sites() const {return num_asites;}
         /// return number of voronoi-vertices
         int num_vertices() const { return g.num_vertices()-num_point_sites(); }
         int num_faces() const { return g.num_faces(); }
         int num_split_vertices();
         /// string repr
         std::string print() const;
-        static void reset_vertex_count() { VoronoiVertex::reset_count(); }
+        /// does nothing. vertex indices are numbered per diagram, starting from zero.
+        /// (kept for compatibility, this used to reset a global vertex count)
+        static void reset_vertex_count() {}
         void debug_on() {debug=true;}
         bool check();
+        /// set the validation level, see ValidationLevel.
+        /// the default is VALIDATE_FULL in debug builds and VALIDATE_NONE in release builds (with NDEBUG).
+        void set_validation(ValidationLevel level) { validation = level; }
+        /// return the validation level
+        ValidationLevel get_validation() const { return validation; }
+        /// the number of inserted sites that failed validation
+        int num_validation_failures() const { return validation_failures; }
+        /// description of the most recent validation failure, or an empty string
+        std::string validation_error() const { return validation_message; }
+        /// position vertices with double or dd_real solvers when these are accurate enough,
+        /// and with qd_real solvers otherwise. off by default. see VertexPositioner
+        /// the point-point-point vertices of a point-site are then computed together, with ppp_batch().
+        /// with adaptive precision off all vertices are positioned in qd_real, and ppp_batch() is not used.
+        void set_adaptive_precision(bool on) { vpos->set_adaptive_precision(on); }
+        /// true if adaptive precision is on
+        bool get_adaptive_precision() const { return vpos->get_adaptive_precision(); }
+        /// number of vertices positioned by solver t at precision p
+        int num_solved(SolverType t, SolverPrecision p) const { return vpos->num_solved(t,p); }
+        /// number of times solver t at precision p was not accurate enough
+        int num_escalations(SolverType t, SolverPrecision p) const { return vpos->num_escalations(t,p); }
+        /// QLLSolver solves only its best-conditioned elimination, and all three
+        /// only when this gives no admissible solution. off by default. see VertexPositioner
+        void set_qll_best_only(bool on) { vpos->set_qll_best_only(on); }
+        /// true if set_qll_best_only() is on
+        bool get_qll_best_only() const { return vpos->get_qll_best_only(); }
+        /// number of times the best-conditioned elimination of QLLSolver was not enough
+        int num_qll_fallbacks() const { return vpos->num_qll_fallbacks(); }
+        /// numeric health of the vertex positioning. see Telemetry
+        const Telemetry& get_telemetry() const { return vpos->get_telemetry(); }
+        /// clear the Telemetry
+        void reset_telemetry() { vpos->reset_telemetry(); }
+        /// time each phase of every site insertion. off by default. see Profiler
+        void set_profiling(bool on) { prof.set_enabled(on); }
+        /// true if insertions are profiled
+        bool get_profiling() const { return prof.get_enabled(); }
+        /// with profiling on, also keep the profile of every insertion
+        void set_profile_trace(bool on) { prof.set_trace(on); }
+        /// the insertion Profiler
+        const Profiler& get_profiler() const { return prof; }
+        /// clear the insertion profiles
+        void reset_profiler() { prof.reset(); }
+        bool save(const std::string& filename);
+        bool load(const std::string& filename);
         HEGraph& get_graph_reference() {return g;}
         void filter_reset() {g.filter_reset();}
     protected:
         /// initialize the diagram with three generators
         void initialize();
+        bool insert_segment_site(HEVertex start, HEVertex end, Point start_dir, Point end_dir, 
+                                 bool k3_sign, SiteKind kind, const Point& center, bool cw, int step);
+        HEVertex   add_vertex(VoronoiVertex v);
+        HEFace     find_closest_face(const Point& p);
+        HEFace     walk_to_closest_face(HEFace f, const Point& p);
+        HEFace     locate_point_face(const Point& p);
+        double     site_distance(HEFace f, const Point& p);
         HEVertex   find_seed_vertex(HEFace f, Site* site);
-        EdgeVector find_in_out_edges(); 
-        EdgeData   find_edge_data(HEFace f, VertexVector startverts, std::pair<HEVertex,HEVertex> segment);
-        EdgeVector find_split_edges(HEFace f, Point pt1, Point pt2);
+        void       find_in_out_edges(EdgeVector& out); 
+        EdgeData   find_edge_data(HEFace f, const VertexVector& startverts, std::pair<HEVertex,HEVertex> segment);
+        void       find_split_edges(HEFace f, Point pt1, Point pt2, EdgeVector& out);
         bool find_split_vertex(HEFace f, HEVertex& v);
         HEFace find_pointsite_face(HEEdge start_edge);
         std::pair<HEVertex,HEVertex> find_endpoints(int idx1, int idx2);
+        bool has_line_site(HEVertex start, HEVertex end);
         
         void augment_vertex_set( Site* site);        
         bool predicate_c4(HEVertex v);
@@ -116,6 +236,7 @@ class VoronoiDiagram {
         void mark_adjacent_faces(HEVertex v, Site* site);
         void mark_adjacent_faces_p( HEVertex v, Site* site);
         void mark_vertex(HEVertex& v,  Site* site); 
+        void mark_modified(HEVertex v);
         void   add_vertices( Site* site );
         HEFace add_face(Site* site);
         
@@ -126,9 +247,10 @@ class VoronoiDiagram {
         void   add_separator(HEFace f, HEFace nf, boost::tuple<HEEdge, HEVertex, HEEdge,bool> target, HEVertex endp, Site* s1, Site* s2);
         void   add_split_vertex(HEFace f, Site* s);
         std::pair<HEFace,HEFace> add_linesite_edges(HEVertex seg_start, HEVertex seg_end, bool linesite_k_sign);
+        std::pair<HEFace,HEFace> add_arcsite_edges(HEVertex seg_start, HEVertex seg_end, const Point& center, bool cw);
         
         boost::tuple<HEVertex,HEFace,HEVertex,HEVertex,HEFace>
-            find_null_face(HEVertex start, HEVertex other, Point l);
+            find_null_face(HEVertex start, Point dir, bool k3_sign);
         boost::tuple<HEEdge,HEVertex,HEEdge,bool> find_separator_target(HEFace f, HEVertex endp);
 
         std::pair<HEVertex,HEFace> process_null_edge(Point dir, HEEdge next_edge , bool k3, bool next_prev);
@@ -140,12 +262,15 @@ class VoronoiDiagram {
                                      std::pair<HEFace,HEFace> null_faces );
         void remove_vertex_set();
         void remove_split_vertex(HEFace f);
+        void remove_center_vertex();
         void reset_status();
+        void reclaim_edge_indices();
+        bool validate(const char* operation, const FaceVector& faces);
         int num_new_vertices(HEFace f);
     // HELPER-CLASSES
         /// sanity-checks on the diagram are done by this helper class
         VoronoiDiagramChecker* vd_checker;
-        /// a grid-search algorithm which allows fast nearest-neighbor search
+        /// a grid-search algorithm which allows fast nearest-neighbor search (optional, may be null)
         FaceGrid* fgrid;
         /// an algorithm for positioning vertices
         VertexPositioner* vpos;
@@ -154,20 +279,56 @@ class VoronoiDiagram {
         HEGraph g;
         /// the voronoi diagram is constructed for sites within a circle with radius far_radius
         double far_radius;
+        /// index for the next vertex added with add_vertex()
+        int next_vertex_index;
         /// the number of point sites
         int num_psites;
         /// the number of line-segment sites
         int num_lsites;
+        /// the number of arc sites
+        int num_asites;
+        /// face of the most recently inserted point-site. find_closest_face() starts walking from here.
+        HEFace last_face;
         /// temporary variable for incident faces, will be reset to NONINCIDENT after a site has been inserted
         FaceVector incident_faces;
         /// temporary variable for in-vertices, out-vertices that need to be reset
-        /// after a site has been inserted
-        std::set<HEVertex> modified_vertices;
+        /// after a site has been inserted. see mark_modified()
+        VertexVector modified_vertices;
+        /// incremented for each inserted site. used to mark vertices in modified_vertices
+        unsigned int epoch;
         /// IN-vertices, i.e. to-be-deleted
         VertexVector v0;
         /// queue of vertices to be processed
         VertexQueue vertexQueue; 
+        /// per-phase timing of insertions
+        Profiler prof;
+    // SCRATCH
+        // these are cleared and re-used for each insertion, so that
+        // inserting a site does not allocate memory once they have grown to size.
+        /// IN-OUT edges, where add_vertices() inserts NEW vertices
+        EdgeVector in_out_edges;
+        /// positions of the NEW vertices on in_out_edges
+        std::vector<Solution> new_solutions;
+        /// NEW vertices that add_edges() has already used
+        VertexVector start_verts;
+        /// edges of a face that need SPLIT vertices
+        EdgeVector split_edges;
+        /// faces adjacent to a vertex, in mark_adjacent_faces()
+        FaceVector adjacent_faces;
+        /// faces modified by the current insertion, checked by validate()
+        FaceVector modified_faces;
+        /// faces searched by locate_point_face()
+        FaceVector located_faces;
+        /// face_mark[f]==face_mark_epoch if locate_point_face() has visited f
+        std::vector<unsigned int> face_mark;
+        unsigned int face_mark_epoch;
         std::map<int,HEVertex> vertex_map;
+        /// validation level. see validate()
+        ValidationLevel validation;
+        /// number of failed validations
+        int validation_failures;
+        /// message from the latest failed validation
+        std::string validation_message;
         bool debug;
 private:
         VoronoiDiagram(); // don't use.